@@ -0,0 +1,96 @@
+#include "Benchmarks.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+  struct Result {
+    std::string group;
+    std::string name;
+    std::vector<std::pair<std::string, double>> metrics;
+  };
+  
+  std::string& currentGroup() {
+    static std::string group;
+    return group;
+  }
+  
+  std::vector<Result>& results() {
+    static std::vector<Result> results;
+    return results;
+  }
+  
+  void writeString(std::FILE* file, const std::string& text) {
+    std::fputc('"', file);
+    for (char character : text) {
+      if (character == '"' || character == '\\') {
+        std::fputc('\\', file);
+        std::fputc(character, file);
+      } else if (static_cast<unsigned char>(character) < 0x20) {
+        std::fprintf(file, "\\u%04x", static_cast<unsigned char>(character));
+      } else {
+        std::fputc(character, file);
+      }
+    }
+    
+    std::fputc('"', file);
+  }
+}
+
+namespace quip {
+  void beginGroup(const std::string& group, const char* description) {
+    currentGroup() = group;
+    std::printf("%s:\n", description);
+  }
+  
+  void recordResult(const std::string& name, std::initializer_list<BenchmarkMetric> metrics) {
+    Result result { currentGroup(), name, {} };
+    for (const BenchmarkMetric& metric : metrics) {
+      result.metrics.emplace_back(metric.name, metric.value);
+    }
+    
+    results().push_back(std::move(result));
+  }
+  
+  void report(const std::string& corpus, const char* operation, double microseconds, const char* unit) {
+    std::printf("%12s %-20s %12.2f us per %s\n", corpus.c_str(), operation, microseconds, unit);
+    recordResult(corpus + " " + operation, { { "microseconds", microseconds } });
+  }
+  
+  bool writeResults(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+      return false;
+    }
+    
+    std::fprintf(file, "{\n  \"version\": 1,\n  \"results\": [");
+    for (std::size_t index = 0; index < results().size(); ++index) {
+      const Result& result = results()[index];
+      std::fprintf(file, "%s\n    { \"group\": ", index > 0 ? "," : "");
+      writeString(file, result.group);
+      std::fprintf(file, ", \"name\": ");
+      writeString(file, result.name);
+      std::fprintf(file, ", \"metrics\": {");
+      for (std::size_t metric = 0; metric < result.metrics.size(); ++metric) {
+        std::fprintf(file, "%s ", metric > 0 ? "," : "");
+        writeString(file, result.metrics[metric].first);
+        
+        // JSON has no representation for infinities or NaN.
+        double value = result.metrics[metric].second;
+        if (std::isfinite(value)) {
+          std::fprintf(file, ": %.6g", value);
+        } else {
+          std::fprintf(file, ": null");
+        }
+      }
+      
+      std::fprintf(file, " } }");
+    }
+    
+    std::fprintf(file, "\n  ]\n}\n");
+    return std::fclose(file) == 0;
+  }
+}
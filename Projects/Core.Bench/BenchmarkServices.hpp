@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Location.hpp"
+#include "PopupService.hpp"
+#include "StatusService.hpp"
+
+#include <string>
+
+namespace quip {
+  // A popup service that creates no popups.
+  struct NullPopupService : PopupService {
+    void tick(double elapsedSeconds) override {
+    }
+
+    PopupHandle createPopupAtLocation(const Location& location, const std::string& text) override {
+      return 0;
+    }
+
+    void destroyPopup(PopupHandle popup) override {
+    }
+  };
+
+  // A status service that ignores status updates.
+  struct NullStatusService : StatusService {
+    void setStatus(const std::string& text) override {
+    }
+
+    void setFileType(const std::string& fileType) override {
+    }
+
+    void setLineCount(const std::size_t count) override {
+    }
+  };
+}
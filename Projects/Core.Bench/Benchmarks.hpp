@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Corpus.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+namespace quip {
+  struct ScriptHost;
+
+  struct BenchmarkMetric {
+    const char* name;
+    double value;
+  };
+
+  // Start a group of related benchmarks, printing its description. Results recorded afterwards
+  // belong to the group.
+  void beginGroup(const std::string& group, const char* description);
+
+  // Record a named result in the current group for the machine-readable report.
+  void recordResult(const std::string& name, std::initializer_list<BenchmarkMetric> metrics);
+
+  // Write every recorded result to the specified path as JSON.
+  bool writeResults(const std::string& path);
+
+  // Time the specified number of repetitions of an operation, which is passed the repetition index,
+  // in microseconds per repetition.
+  template<typename OperationType>
+  double measure(std::size_t repetitions, OperationType operation) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+      operation(repetition);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / repetitions;
+  }
+
+  // Print and record the time taken per unit (such as a row or an edit) by an operation on a
+  // corpus.
+  void report(const std::string& corpus, const char* operation, double microseconds, const char* unit);
+
+  void benchmarkDocuments(ScriptHost& scriptHost, CorpusKind kind, std::size_t size);
+  void benchmarkFunctions();
+  void benchmarkIndexedSearch(std::size_t size);
+  void benchmarkKeystrokes(ScriptHost& scriptHost, std::size_t cursors);
+  void benchmarkMappings(std::size_t mappings);
+  void benchmarkReplay(ScriptHost& scriptHost);
+  void benchmarkScriptedEdits(ScriptHost& scriptHost, std::size_t rows);
+  void benchmarkScripting(ScriptHost& scriptHost);
+  void benchmarkSelections(ScriptHost& scriptHost, std::size_t count);
+  void benchmarkSignals(std::size_t listeners);
+  void benchmarkStartup();
+}
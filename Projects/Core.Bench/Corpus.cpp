@@ -0,0 +1,211 @@
+#include "Corpus.hpp"
+
+#include <cstdio>
+
+namespace {
+  const char* Words[] = {
+    "value", "count", "index", "buffer", "result", "document", "selection", "render", "update", "cursor",
+    "origin", "extent", "length", "offset", "parse", "token", "handler", "signal", "state", "context"
+  };
+  
+  const char* Types[] = { "int", "float", "std::size_t", "bool", "std::string", "Location" };
+  const char* Levels[] = { "DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR" };
+  
+  // SplitMix64, which is small, fast and fully specified.
+  struct CorpusRandom {
+    std::uint64_t state;
+    
+    std::uint64_t next() {
+      std::uint64_t result = (state += 0x9e3779b97f4a7c15ull);
+      result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9ull;
+      result = (result ^ (result >> 27)) * 0x94d049bb133111ebull;
+      return result ^ (result >> 31);
+    }
+    
+    std::size_t below(std::size_t limit) {
+      return static_cast<std::size_t>(next() % limit);
+    }
+    
+    template<typename ElementType, std::size_t Count>
+    const ElementType& pick(const ElementType (&elements)[Count]) {
+      return elements[below(Count)];
+    }
+  };
+  
+  void appendNumber(std::string& text, std::uint64_t value) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+    text += buffer;
+  }
+  
+  void appendIdentifier(std::string& text, CorpusRandom& random) {
+    text += random.pick(Words);
+    if (random.below(3) == 0) {
+      // Camel case compound identifiers.
+      std::size_t start = text.size();
+      text += random.pick(Words);
+      text[start] = static_cast<char>(text[start] - 'a' + 'A');
+    }
+  }
+  
+  void generateSourceCode(std::string& text, std::size_t size, CorpusRandom& random) {
+    while (text.size() < size) {
+      text += "// Compute the ";
+      text += random.pick(Words);
+      text += " for the ";
+      text += random.pick(Words);
+      text += ".\n";
+      text += random.pick(Types);
+      text += " ";
+      appendIdentifier(text, random);
+      text += "(const std::vector<int>& items) {\n";
+      
+      std::size_t statements = 2 + random.below(8);
+      for (std::size_t statement = 0; statement < statements; ++statement) {
+        if (random.below(4) == 0) {
+          text += "  for (std::size_t index = 0; index < items.size(); ++index) {\n    ";
+          appendIdentifier(text, random);
+          text += " += items[index] * ";
+          appendNumber(text, random.below(100));
+          text += ";\n  }\n";
+        } else {
+          text += "  ";
+          text += random.pick(Types);
+          text += " ";
+          appendIdentifier(text, random);
+          text += " = compute(";
+          appendIdentifier(text, random);
+          text += ", ";
+          appendNumber(text, random.below(1000));
+          text += ");\n";
+        }
+      }
+      
+      text += "  return ";
+      appendIdentifier(text, random);
+      text += ";\n}\n\n";
+    }
+  }
+  
+  void generateLog(std::string& text, std::size_t size, CorpusRandom& random) {
+    std::uint64_t milliseconds = 0;
+    char buffer[64];
+    while (text.size() < size) {
+      milliseconds += random.below(250);
+      std::uint64_t seconds = milliseconds / 1000;
+      std::snprintf(buffer, sizeof(buffer), "2024-03-01T%02llu:%02llu:%02llu.%03lluZ ", static_cast<unsigned long long>(seconds / 3600 % 24), static_cast<unsigned long long>(seconds / 60 % 60), static_cast<unsigned long long>(seconds % 60), static_cast<unsigned long long>(milliseconds % 1000));
+      text += buffer;
+      text += random.pick(Levels);
+      text += " [";
+      text += random.pick(Words);
+      text += "] ";
+      
+      std::size_t words = 3 + random.below(10);
+      for (std::size_t word = 0; word < words; ++word) {
+        text += random.pick(Words);
+        text += word + 1 < words ? " " : "";
+      }
+      
+      text += " id=";
+      appendNumber(text, random.next() % 1000000);
+      text += "\n";
+    }
+  }
+  
+  void generateJsonValue(std::string& text, CorpusRandom& random, std::size_t depth) {
+    std::size_t kind = depth >= 6 ? 2 + random.below(3) : random.below(5);
+    if (kind == 0) {
+      text += "{";
+      std::size_t members = 1 + random.below(6);
+      for (std::size_t member = 0; member < members; ++member) {
+        text += member > 0 ? ",\"" : "\"";
+        text += random.pick(Words);
+        text += "\":";
+        generateJsonValue(text, random, depth + 1);
+      }
+      
+      text += "}";
+    } else if (kind == 1) {
+      text += "[";
+      std::size_t elements = random.below(8);
+      for (std::size_t element = 0; element < elements; ++element) {
+        text += element > 0 ? "," : "";
+        generateJsonValue(text, random, depth + 1);
+      }
+      
+      text += "]";
+    } else if (kind == 2) {
+      appendNumber(text, random.below(100000));
+    } else if (kind == 3) {
+      text += "\"";
+      text += random.pick(Words);
+      text += "\"";
+    } else {
+      text += random.below(2) == 0 ? "true" : "null";
+    }
+  }
+  
+  void generateMinifiedJson(std::string& text, std::size_t size, CorpusRandom& random) {
+    // A single line, like the output of a minifier.
+    text += "[";
+    while (text.size() < size) {
+      text += text.size() > 1 ? "," : "";
+      generateJsonValue(text, random, 0);
+    }
+    
+    text += "]\n";
+  }
+  
+  void generateLongLines(std::string& text, std::size_t size, CorpusRandom& random) {
+    while (text.size() < size) {
+      std::size_t length = 10000 + random.below(90000);
+      std::size_t end = text.size() + length;
+      while (text.size() < end) {
+        text += random.pick(Words);
+        text += random.below(16) == 0 ? "; " : " ";
+      }
+      
+      text += "\n";
+    }
+  }
+}
+
+namespace quip {
+  const char* corpusName(CorpusKind kind) {
+    switch (kind) {
+      case CorpusKind::SourceCode:
+        return "source";
+      case CorpusKind::Log:
+        return "log";
+      case CorpusKind::MinifiedJson:
+        return "json";
+      case CorpusKind::LongLines:
+        return "long-lines";
+    }
+    
+    return "unknown";
+  }
+  
+  std::string generateCorpus(CorpusKind kind, std::size_t size, std::uint64_t seed) {
+    std::string result;
+    result.reserve(size + 128 * 1024);
+    
+    CorpusRandom random { seed };
+    switch (kind) {
+      case CorpusKind::SourceCode:
+        generateSourceCode(result, size, random);
+        break;
+      case CorpusKind::Log:
+        generateLog(result, size, random);
+        break;
+      case CorpusKind::MinifiedJson:
+        generateMinifiedJson(result, size, random);
+        break;
+      case CorpusKind::LongLines:
+        generateLongLines(result, size, random);
+        break;
+    }
+    
+    return result;
+  }
+}
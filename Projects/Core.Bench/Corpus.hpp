@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace quip {
+  enum class CorpusKind {
+    SourceCode,
+    Log,
+    MinifiedJson,
+    LongLines
+  };
+  
+  const char* corpusName(CorpusKind kind);
+  
+  // Generate approximately the specified number of bytes of text of the specified kind. The output
+  // depends only on the arguments (the generator does not use the standard library's random
+  // distributions, whose results vary between implementations), so runs on different machines and
+  // builds operate on identical text.
+  std::string generateCorpus(CorpusKind kind, std::size_t size, std::uint64_t seed = 1);
+}
@@ -0,0 +1,246 @@
+#include "Benchmarks.hpp"
+
+#include "AttributeRange.hpp"
+#include "BenchmarkServices.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "EditMode.hpp"
+#include "IncrementalSearch.hpp"
+#include "InsertTransaction.hpp"
+#include "Key.hpp"
+#include "Location.hpp"
+#include "Modifiers.hpp"
+#include "Script.hpp"
+#include "ScriptHost.hpp"
+#include "SearchExpression.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "Selector.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  // Get the locations of the first character, the middle of the middle row and the newline ending
+  // the last row of a (non-empty) document.
+  std::vector<Location> editLocations(const Document& document) {
+    std::size_t middle = document.rows() / 2;
+    std::size_t last = document.rows() - 1;
+    return {
+      Location(0, 0),
+      Location(document.row(middle).size() / 2, middle),
+      Location(document.row(last).size() - 1, last)
+    };
+  }
+
+  // Get locations spread evenly through the document, one on each of the specified number of rows.
+  std::vector<Location> spreadLocations(const Document& document, std::size_t count) {
+    std::vector<Location> results;
+    std::size_t step = std::max<std::size_t>(document.rows() / count, 1);
+    for (std::size_t row = 0; row < document.rows() && results.size() < count; row += step) {
+      results.emplace_back(document.row(row).size() / 2, row);
+    }
+
+    return results;
+  }
+}
+
+namespace quip {
+  // Measure the common document operations on a generated corpus of the specified kind and
+  // (approximate) size in bytes.
+  void benchmarkDocuments(ScriptHost& scriptHost, CorpusKind kind, std::size_t size) {
+    const std::string text = generateCorpus(kind, size);
+    const std::string corpus = corpusName(kind);
+
+    std::printf("%12s %zu bytes\n", corpus.c_str(), text.size());
+    report(corpus, "open", measure(4, [&](std::size_t) {
+      Document document(text);
+    }), "document");
+
+    std::shared_ptr<Document> document = std::make_shared<Document>(text);
+    const char* edgeNames[] = { "start", "middle", "end" };
+    std::vector<Location> edges = editLocations(*document);
+    for (std::size_t edge = 0; edge < edges.size(); ++edge) {
+      const std::size_t edits = 200;
+
+      Selection at(edges[edge]);
+      double insert = 0.0;
+      double erase = 0.0;
+      for (std::size_t edit = 0; edit < edits; ++edit) {
+        insert += measure(1, [&](std::size_t) {
+          document->insert(at, "x");
+        });
+
+        erase += measure(1, [&](std::size_t) {
+          document->erase(at);
+        });
+      }
+
+      report(corpus, (std::string("insert ") + edgeNames[edge]).c_str(), insert / edits, "edit");
+      report(corpus, (std::string("erase ") + edgeNames[edge]).c_str(), erase / edits, "edit");
+    }
+
+    NullPopupService popupService;
+    NullStatusService statusService;
+    EditContext context(&popupService, &statusService, &scriptHost, document);
+    {
+      const std::size_t keystrokes = 16;
+
+      std::vector<Selection> cursors;
+      for (const Location& location : spreadLocations(*document, 100)) {
+        cursors.emplace_back(location);
+      }
+
+      context.selections().replace(SelectionSet(cursors));
+      context.enterMode("EditMode", EditMode::InsertBehavior);
+      report(corpus, "type 100 cursors", measure(keystrokes, [&](std::size_t) {
+        context.processKeyEvent(Key::A, Modifiers(), "a");
+      }), "keystroke");
+
+      report(corpus, "delete 100 cursors", measure(keystrokes, [&](std::size_t) {
+        context.processKeyEvent(Key::Delete, Modifiers(), "");
+      }), "keystroke");
+
+      context.leaveMode();
+    }
+
+    {
+      SearchExpression literal("compute");
+      SearchExpression pattern("[0-9]+");
+      std::size_t found = 0;
+      report(corpus, "search literal", measure(2, [&](std::size_t) {
+        found += document->matches(literal).count();
+      }), "search");
+
+      report(corpus, "search pattern", measure(2, [&](std::size_t) {
+        found += document->matches(pattern).count();
+      }), "search");
+
+      // Each key after the first refines the previous matches rather than scanning again.
+      report(corpus, "search as you type", measure(2, [&](std::size_t) {
+        IncrementalSearch search;
+        std::string typed;
+        for (char character : std::string("compute")) {
+          typed += character;
+          found += search.matches(*document, SearchExpression(typed)).count();
+        }
+      }), "7 keys");
+
+      // Ten rows at each of 16 places, as when narrowing a search to a few selected functions.
+      std::vector<Selection> blocks;
+      for (const Location& location : spreadLocations(*document, 16)) {
+        std::uint64_t last = std::min<std::uint64_t>(location.row() + 9, document->rows() - 1);
+        blocks.emplace_back(Location(0, location.row()), Location(document->row(last).size() - 1, last));
+      }
+
+      SelectionSet within(blocks);
+      report(corpus, "search in blocks", measure(20, [&](std::size_t) {
+        found += document->matches(pattern, within).count();
+      }), "search");
+    }
+
+    {
+      std::vector<Location> starts = spreadLocations(*document, 1000);
+      report(corpus, "select words", measure(starts.size(), [&](std::size_t index) {
+        Optional<Selection> selection(Selection(starts[index]));
+        for (std::size_t word = 0; word < 16 && selection.has_value(); ++word) {
+          selection = selectThisOrNextWord(*document, *selection);
+        }
+      }), "16 words");
+
+      report(corpus, "select blocks", measure(starts.size(), [&](std::size_t index) {
+        selectBlocks(*document, Selection(starts[index]));
+      }), "selection");
+
+      // Splitting a row changes the row count, which the bracket index must absorb before the next
+      // block selection. Rows are split from the end so the remaining starts stay valid.
+      const std::size_t splits = std::min<std::size_t>(starts.size(), 100);
+      report(corpus, "split and select", measure(splits, [&](std::size_t index) {
+        const Location& start = starts[starts.size() - 1 - index];
+        document->insert(Selection(start), "\n");
+        selectBlocks(*document, Selection(Location(0, start.row() + 1)));
+      }), "edit");
+    }
+
+    {
+      const std::size_t transactions = 200;
+
+      std::vector<Selection> cursors;
+      for (const Location& location : spreadLocations(*document, 10)) {
+        cursors.emplace_back(location);
+      }
+
+      SelectionSet selections(cursors);
+      std::vector<std::string> inserted(selections.count(), "x");
+      for (std::size_t transaction = 0; transaction < transactions; ++transaction) {
+        context.performTransaction(std::make_shared<InsertTransaction>(selections, inserted));
+      }
+
+      report(corpus, "undo", measure(transactions, [&](std::size_t) {
+        context.undo();
+      }), "transaction");
+
+      report(corpus, "redo", measure(transactions, [&](std::size_t) {
+        context.redo();
+      }), "transaction");
+    }
+
+    {
+      // Syntax scripts are run a row at a time, as the view does.
+      const std::size_t rows = std::min<std::size_t>(document->rows(), 2000);
+
+      Script script(scriptHost.scriptRootPath() + "/syntax/cpp.lua");
+      std::size_t ranges = 0;
+      report(corpus, "parse syntax", measure(rows, [&](std::size_t row) {
+        ranges += scriptHost.parseSyntax(script, document->row(row)).size();
+      }), "row");
+    }
+  }
+
+  void benchmarkIndexedSearch(std::size_t size) {
+    const std::string corpus = "indexed-log";
+    Document document(generateCorpus(CorpusKind::Log, size));
+    std::printf("%12s %zu rows\n", corpus.c_str(), document.rows());
+
+    // The selective pattern only matches a line inserted after the index is built, which also
+    // exercises the update of the chunk containing it.
+    SearchExpression selective("quota exceeded for tenant [0-9]+");
+    SearchExpression common("ERROR \\[render\\]");
+    std::size_t found = 0;
+    report(corpus, "scan selective", measure(1, [&](std::size_t) {
+      found += document.matches(selective).count();
+    }), "search");
+
+    report(corpus, "scan common", measure(1, [&](std::size_t) {
+      found += document.matches(common).count();
+    }), "search");
+
+    document.trigrams().setEnabled(true);
+    report(corpus, "build index", measure(1, [&](std::size_t) {
+      document.trigrams().build(document.rows());
+    }), "document");
+
+    std::size_t middle = document.rows() / 2;
+    report(corpus, "insert indexed", measure(1, [&](std::size_t) {
+      document.insert(Selection(Location(0, middle)), "2024-03-01T12:00:00.000Z ERROR [state] quota exceeded for tenant 42\n");
+    }), "edit");
+
+    report(corpus, "search selective", measure(10, [&](std::size_t) {
+      found += document.matches(selective).count();
+    }), "search");
+
+    report(corpus, "search common", measure(1, [&](std::size_t) {
+      found += document.matches(common).count();
+    }), "search");
+
+    std::printf("%12s %-20s %12zu bytes\n", corpus.c_str(), "index memory", document.trigrams().memoryUsage());
+    recordResult(corpus + " index memory", { { "bytes", static_cast<double>(document.trigrams().memoryUsage()) } });
+    std::printf("%12s %-20s %12zu\n", corpus.c_str(), "matches", found);
+  }
+}
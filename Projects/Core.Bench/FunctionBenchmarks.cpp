@@ -0,0 +1,60 @@
+#include "Benchmarks.hpp"
+
+#include "InplaceFunction.hpp"
+#include "MemoryAccounting.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+namespace {
+  struct Target {
+    std::uint64_t total;
+
+    void add(std::uint64_t value) {
+      total += value;
+    }
+  };
+
+  // Copy and then repeatedly call a function wrapping a bound member function, the way key mappings
+  // are dispatched, reporting the time per call and the allocations per copy.
+  template<typename FunctionType>
+  void benchmarkFunction(const char* name, const FunctionType& function, Target& target) {
+    const std::size_t copies = 100000;
+    const std::size_t calls = 20000000;
+
+    quip::AllocationCounter counter;
+    for (std::size_t index = 0; index < copies; ++index) {
+      FunctionType copy(function);
+      copy(index);
+    }
+
+    std::uint64_t allocations = counter.allocations();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < calls; ++index) {
+      function(index);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf("%16s: %8.2f ns per call %6.1f allocations per copy (checksum %llu)\n", name, nanoseconds / calls, static_cast<double>(allocations) / copies, static_cast<unsigned long long>(target.total));
+    quip::recordResult(name, { { "nanosecondsPerCall", nanoseconds / calls }, { "allocationsPerCopy", static_cast<double>(allocations) / copies } });
+  }
+}
+
+namespace quip {
+  void benchmarkFunctions() {
+    Target target { 0 };
+    void (Target::*callback)(std::uint64_t) = &Target::add;
+
+    std::function<void (std::uint64_t)> standard = std::bind(callback, &target, std::placeholders::_1);
+    benchmarkFunction("std::function", standard, target);
+
+    Target* pointer = &target;
+    InplaceFunction<void (std::uint64_t)> inplace([pointer, callback](std::uint64_t value) { (pointer->*callback)(value); });
+    benchmarkFunction("InplaceFunction", inplace, target);
+  }
+}
@@ -0,0 +1,75 @@
+#include "Benchmarks.hpp"
+
+#include "BenchmarkServices.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "EditMode.hpp"
+#include "Key.hpp"
+#include "Location.hpp"
+#include "MemoryAccounting.hpp"
+#include "Modifiers.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+namespace quip {
+  // Type (and then delete) characters in edit mode with one cursor on each of the first rows of a
+  // document, reporting the allocations and time per keystroke.
+  void benchmarkKeystrokes(ScriptHost& scriptHost, std::size_t cursors) {
+    const std::size_t keystrokes = 32;
+
+    std::ostringstream stream;
+    for (std::size_t row = 0; row < cursors; ++row) {
+      stream << "  int value" << row << " = compute(value, " << row << ");\n";
+    }
+
+    NullPopupService popupService;
+    NullStatusService statusService;
+    std::shared_ptr<Document> document = std::make_shared<Document>(stream.str());
+    EditContext context(&popupService, &statusService, &scriptHost, document);
+
+    std::vector<Selection> selections;
+    for (std::size_t row = 0; row < cursors; ++row) {
+      selections.emplace_back(Location(2, row));
+    }
+
+    context.selections().replace(SelectionSet(selections));
+    context.enterMode("EditMode", EditMode::InsertBehavior);
+
+    AllocationCounter counter;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < keystrokes; ++index) {
+      context.processKeyEvent(Key::A, Modifiers(), "a");
+    }
+
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    std::uint64_t insertions = counter.allocations();
+    counter.reset();
+
+    for (std::size_t index = 0; index < keystrokes; ++index) {
+      context.processKeyEvent(Key::Delete, Modifiers(), "");
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::uint64_t deletions = counter.allocations();
+
+    double insertMicroseconds = std::chrono::duration<double, std::micro>(middle - start).count() / keystrokes;
+    double deleteMicroseconds = std::chrono::duration<double, std::micro>(end - middle).count() / keystrokes;
+    std::printf("%8zu cursors: insert %10.1f allocations %10.1f us | delete %10.1f allocations %10.1f us\n", cursors, static_cast<double>(insertions) / keystrokes, insertMicroseconds, static_cast<double>(deletions) / keystrokes, deleteMicroseconds);
+    recordResult(std::to_string(cursors) + " cursors", {
+      { "insertMicroseconds", insertMicroseconds },
+      { "insertAllocations", static_cast<double>(insertions) / keystrokes },
+      { "deleteMicroseconds", deleteMicroseconds },
+      { "deleteAllocations", static_cast<double>(deletions) / keystrokes }
+    });
+  }
+}
@@ -0,0 +1,61 @@
+#include "Benchmarks.hpp"
+
+#include "KeySequence.hpp"
+#include "MapTrie.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace quip {
+  // Load the specified number of pseudo-random mappings of one to four letters and then dispatch
+  // them key by key, resuming from the previous node, reporting the time per key.
+  void benchmarkMappings(std::size_t mappings) {
+    const std::size_t dispatches = 2000000;
+    const Key letters[] = {
+      Key::A, Key::B, Key::C, Key::D, Key::E, Key::F, Key::G, Key::H, Key::I, Key::J, Key::K, Key::L, Key::M,
+      Key::N, Key::O, Key::P, Key::Q, Key::R, Key::S, Key::T, Key::U, Key::V, Key::W, Key::X, Key::Y, Key::Z
+    };
+
+    std::uint32_t state = 12345;
+    std::vector<KeySequence> sequences;
+    MapTrie trie;
+    std::uint64_t handled = 0;
+    for (std::size_t index = 0; index < mappings; ++index) {
+      KeySequence sequence;
+      state = state * 1664525 + 1013904223;
+      std::size_t length = 1 + (state >> 16) % 4;
+      for (std::size_t key = 0; key < length; ++key) {
+        state = state * 1664525 + 1013904223;
+        sequence.append(letters[(state >> 16) % 26]);
+      }
+
+      std::uint64_t* counter = &handled;
+      trie.insert(sequence, [counter](EditContext&, std::uint32_t) { ++*counter; });
+      sequences.push_back(sequence);
+    }
+
+    std::size_t keys = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < dispatches; ++index) {
+      const KeySequence& sequence = sequences[index % sequences.size()];
+      MapTrie::Node node = trie.root();
+      for (const Key* key = sequence.begin(); key != sequence.end(); ++key) {
+        node = trie.advance(node, *key);
+        ++keys;
+      }
+
+      if (trie.handler(node) != nullptr) {
+        ++handled;
+      }
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf("%8zu mappings: %8.2f ns per key (%llu handled)\n", mappings, nanoseconds / keys, static_cast<unsigned long long>(handled));
+    recordResult(std::to_string(mappings) + " mappings", { { "nanosecondsPerKey", nanoseconds / keys } });
+  }
+}
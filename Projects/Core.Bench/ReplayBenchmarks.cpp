@@ -0,0 +1,75 @@
+#include "Benchmarks.hpp"
+
+#include "BenchmarkServices.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "KeyEvent.hpp"
+#include "Macro.hpp"
+#include "ScriptHost.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  // Record a key stream from characters, repeated the specified number of times. Upper case
+  // letters are typed with shift held, and a tilde stands for the escape key.
+  Macro recordKeys(const char* characters, std::size_t repetitions) {
+    Macro result;
+    for (std::size_t repetition = 0; repetition < repetitions; ++repetition) {
+      for (const char* cursor = characters; *cursor != 0; ++cursor) {
+        KeyEvent event { keyFromCharacter(*cursor), Modifiers(), std::string(1, *cursor) };
+        event.modifiers.shift = std::isupper(*cursor) != 0;
+        if (*cursor == '~') {
+          event.key = Key::Escape;
+        }
+
+        result.append(event);
+      }
+    }
+
+    return result;
+  }
+
+  std::string makeDocument(std::size_t rows) {
+    std::ostringstream stream;
+    for (std::size_t row = 0; row < rows; ++row) {
+      stream << "  int value" << row << " = compute(value, " << row << ");\n";
+    }
+
+    return stream.str();
+  }
+
+  // Replay a recorded key stream through an edit context in normal mode, reporting the number of
+  // key events processed per second.
+  void replayKeys(ScriptHost& scriptHost, const char* name, const Macro& macro, std::size_t rows) {
+    NullPopupService popupService;
+    NullStatusService statusService;
+    EditContext context(&popupService, &statusService, &scriptHost, std::make_shared<Document>(makeDocument(rows)));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    context.replay(macro);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%16s: %10zu events in %8.1f ms, %12.0f events per second\n", name, macro.count(), seconds * 1000.0, macro.count() / seconds);
+    recordResult(name, { { "events", static_cast<double>(macro.count()) }, { "eventsPerSecond", macro.count() / seconds } });
+  }
+}
+
+namespace quip {
+  void benchmarkReplay(ScriptHost& scriptHost) {
+    replayKeys(scriptHost, "navigation", recordKeys("jjjlllwwbbkkkhhh", 12500), 1000);
+    replayKeys(scriptHost, "sequences", recordKeys("rwrfrbplpl", 20000), 1000);
+    replayKeys(scriptHost, "modifiers", recordKeys("JJLLKKHHz", 20000), 1000);
+    replayKeys(scriptHost, "counts", recordKeys("12j12k3l3h", 20000), 1000);
+
+    // Apply a one-line edit to every row of a large document.
+    replayKeys(scriptHost, "edit every row", recordKeys("ix~hj", 50000), 50000);
+  }
+}
@@ -0,0 +1,150 @@
+#include "Benchmarks.hpp"
+
+#include "BenchmarkServices.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "EraseTransaction.hpp"
+#include "InsertTransaction.hpp"
+#include "Location.hpp"
+#include "LuaBinding.hpp"
+#include "MemoryAccounting.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+  struct Target {
+    int total;
+    
+    int value() const {
+      return total;
+    }
+    
+    void setValue(int value) {
+      total = value;
+    }
+    
+    int add(int value) {
+      total += value;
+      return total;
+    }
+    
+    quip::Location advance(const quip::Location& location, int columns) const {
+      return quip::Location(location.column() + columns, location.row());
+    }
+    
+    static quip::LuaBinding binding() {
+      quip::LuaBinding result;
+      result.addProperty("value", &Target::value, &Target::setValue);
+      result.addFunction("add", &Target::add);
+      result.addFunction("advance", &Target::advance);
+      return result;
+    }
+  };
+  
+  // Run a Lua loop making the specified number of calls into the bound target, reporting the call
+  // rate and the allocations per call.
+  void benchmarkCalls(quip::ScriptHost& scriptHost, const char* name, const std::string& body, Target& target) {
+    const std::size_t calls = 2000000;
+    std::string source = "local target = quip.benchmark for index = 1, " + std::to_string(calls) + " do " + body + " end";
+    
+    quip::AllocationCounter counter;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    scriptHost.execute(source);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::uint64_t allocations = counter.allocations();
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%16s: %8.2f million calls per second %6.2f allocations per call (checksum %d)\n", name, calls / seconds / 1000000.0, static_cast<double>(allocations) / calls, target.total);
+    quip::recordResult(name, { { "callsPerSecond", calls / seconds }, { "allocationsPerCall", static_cast<double>(allocations) / calls } });
+  }
+}
+
+namespace quip {
+  void benchmarkScripting(ScriptHost& scriptHost) {
+    Target target { 0 };
+    scriptHost.bind(&target, "benchmark");
+    
+    benchmarkCalls(scriptHost, "property get", "local value = target.value", target);
+    benchmarkCalls(scriptHost, "property set", "target.value = index", target);
+    benchmarkCalls(scriptHost, "method call", "target:add(1)", target);
+    benchmarkCalls(scriptHost, "location call", "local column, row = target:advance(index, 2, 3)", target);
+    scriptHost.unbind("benchmark");
+  }
+  
+  // Scan and then transform one selection on each row of a large document from Lua, comparing
+  // against the same work done natively.
+  void benchmarkScriptedEdits(ScriptHost& scriptHost, std::size_t rows) {
+    std::ostringstream stream;
+    for (std::size_t row = 0; row < rows; ++row) {
+      stream << "  value = compute(value, " << row << "); // update the value\n";
+    }
+    
+    NullPopupService popupService;
+    NullStatusService statusService;
+    std::shared_ptr<Document> document = std::make_shared<Document>(stream.str());
+    EditContext context(&popupService, &statusService, &scriptHost, document);
+    
+    std::vector<Selection> selections;
+    for (std::size_t row = 0; row < rows; ++row) {
+      selections.emplace_back(Location(2, row), Location(6, row));
+    }
+    
+    context.selections().replace(SelectionSet(selections));
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    scriptHost.execute(
+      "local document, count = quip.document, 0 "
+      "for row = 0, document.rows - 1 do "
+      "  local view = document:view(row) "
+      "  local first = view:find('value') "
+      "  while first do count = count + 1 first = view:find('value', first + 1) end "
+      "end "
+      "assert(count == 3 * document.rows)"
+    );
+    
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    scriptHost.execute(
+      "local context, document = quip.context, quip.document "
+      "local selections, text = context.selections, {} "
+      "for index = 1, #selections, 4 do "
+      "  text[#text + 1] = document:text(selections[index], selections[index + 1], selections[index + 2], selections[index + 3]):upper() "
+      "end "
+      "context:erase() "
+      "context:insertEach(text)"
+    );
+    
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    
+    // The native equivalent of the transform, on an identical document.
+    EditContext native(&popupService, &statusService, &scriptHost, std::make_shared<Document>(stream.str()));
+    native.selections().replace(SelectionSet(selections));
+    
+    std::chrono::steady_clock::time_point nativeStart = std::chrono::steady_clock::now();
+    std::vector<std::string> text = native.document().contents(native.selections());
+    for (std::string& item : text) {
+      for (char& character : item) {
+        character = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+      }
+    }
+    
+    native.performTransaction(EraseTransaction::create(native.selections()));
+    native.performTransaction(InsertTransaction::create(native.selections(), text));
+    std::chrono::steady_clock::time_point nativeEnd = std::chrono::steady_clock::now();
+    
+    double scan = std::chrono::duration<double, std::milli>(middle - start).count();
+    double transform = std::chrono::duration<double, std::milli>(end - middle).count();
+    double reference = std::chrono::duration<double, std::milli>(nativeEnd - nativeStart).count();
+    std::printf("%8zu rows: scan %8.1f ms transform %8.1f ms (native %8.1f ms, %s)\n", rows, scan, transform, reference, document->contents() == native.document().contents() ? "matching" : "MISMATCHED");
+    recordResult(std::to_string(rows) + " rows", { { "scanMilliseconds", scan }, { "transformMilliseconds", transform }, { "nativeMilliseconds", reference } });
+  }
+}
@@ -0,0 +1,122 @@
+#include "Benchmarks.hpp"
+
+#include "BenchmarkServices.hpp"
+#include "Color.hpp"
+#include "CursorFlags.hpp"
+#include "CursorStyle.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "InsertTransaction.hpp"
+#include "Location.hpp"
+#include "MemoryAccounting.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionDrawInfo.hpp"
+#include "SelectionSet.hpp"
+#include "SelectionTree.hpp"
+#include "Transaction.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  // Time the specified number of repetitions of an operation, reporting microseconds and
+  // allocations per repetition.
+  template<typename OperationType>
+  void measureSelections(std::size_t selections, const char* operation, std::size_t repetitions, OperationType body) {
+    AllocationCounter counter;
+    double microseconds = measure(repetitions, body);
+    double allocations = static_cast<double>(counter.allocations()) / repetitions;
+    std::printf("%8zu selections %-16s %12.2f us %10.1f allocations\n", selections, operation, microseconds, allocations);
+    recordResult(std::to_string(selections) + " " + operation, { { "microseconds", microseconds }, { "allocations", allocations } });
+  }
+}
+
+namespace quip {
+  void benchmarkSelections(ScriptHost& scriptHost, std::size_t count) {
+    const std::size_t repetitions = 1000;
+
+    std::ostringstream stream;
+    for (std::size_t row = 0; row < count; ++row) {
+      stream << "match " << row << "\n";
+    }
+
+    NullPopupService popupService;
+    NullStatusService statusService;
+    std::shared_ptr<Document> document = std::make_shared<Document>(stream.str());
+    EditContext context(&popupService, &statusService, &scriptHost, document);
+
+    std::vector<Selection> matches;
+    for (std::size_t row = 0; row < count; ++row) {
+      matches.emplace_back(Location(0, row), Location(4, row));
+    }
+
+    SelectionSet selections(matches);
+    std::printf("%8zu selections %-16s %12zu bytes\n", count, "storage", selections.memoryUsage());
+    recordResult(std::to_string(count) + " storage", { { "bytes", static_cast<double>(selections.memoryUsage()) } });
+
+    // Constructing a set sorts and collapses its selections, as search does with its matches.
+    std::vector<Selection> reversed(matches.rbegin(), matches.rend());
+    measureSelections(count, "construct", 10, [&](std::size_t repetition) {
+      SelectionSet set(reversed);
+    });
+
+    // Building a tree from a set, as a snapshot of the selections for the tree's queries would.
+    measureSelections(count, "build tree", 10, [&](std::size_t repetition) {
+      SelectionTree tree(selections);
+    });
+
+    // What the view does every frame for the context's selections.
+    measureSelections(count, "draw info", repetitions, [&](std::size_t repetition) {
+      SelectionDrawInfo drawInfo { Color::white(), Color::white(), CursorStyle::VerticalBlock, CursorFlags::None, selections };
+      (void)drawInfo;
+    });
+
+    // What search mode does for its highlights on every refinement.
+    measureSelections(count, "set overlay", repetitions, [&](std::size_t repetition) {
+      SelectionDrawInfo overlay { Color::white(), Color::white(), CursorStyle::VerticalBlock, CursorFlags::None, selections };
+      context.setOverlay("Search", overlay);
+    });
+
+    measureSelections(count, "transaction", repetitions, [&](std::size_t repetition) {
+      std::shared_ptr<Transaction> transaction = InsertTransaction::create(selections, "x");
+      (void)transaction;
+    });
+
+    measureSelections(count, "replace", repetitions, [&](std::size_t repetition) {
+      context.selections().replace(selections);
+    });
+
+    // Set algebra against blocks covering every other ten rows, as when restricting search matches
+    // to the current selections.
+    std::vector<Selection> blockSelections;
+    for (std::size_t row = 0; row + 10 <= count; row += 20) {
+      blockSelections.emplace_back(Location(0, row), Location(2, row + 9));
+    }
+
+    SelectionSet blocks(blockSelections);
+    measureSelections(count, "union", 10, [&](std::size_t repetition) {
+      SelectionSet result = selections.unionWith(blocks);
+    });
+
+    measureSelections(count, "intersection", 10, [&](std::size_t repetition) {
+      SelectionSet result = selections.intersectionWith(blocks);
+    });
+
+    measureSelections(count, "difference", 10, [&](std::size_t repetition) {
+      SelectionSet result = selections.difference(blocks, *document);
+    });
+
+        // Mutating a copy clones its storage.
+    measureSelections(count, "mutate copy", repetitions / 10, [&](std::size_t repetition) {
+      SelectionSet copy(selections);
+      copy[0] = Selection(Location(1, 0));
+    });
+  }
+}
@@ -0,0 +1,41 @@
+#include "Benchmarks.hpp"
+
+#include "MemoryAccounting.hpp"
+#include "Signal.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace quip {
+  // Transmit a signal with the specified number of connected listeners, reporting the time per
+  // transmission and per listener called, and the allocations per transmission.
+  void benchmarkSignals(std::size_t listeners) {
+    const std::size_t calls = 4000000;
+    const std::size_t transmissions = calls / listeners;
+
+    Signal<void (std::uint64_t)> signal;
+    std::uint64_t total = 0;
+    for (std::size_t index = 0; index < listeners; ++index) {
+      signal.connect([&total](std::uint64_t value) { total += value; });
+    }
+
+    AllocationCounter counter;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < transmissions; ++index) {
+      signal.transmit(index);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::uint64_t allocations = counter.allocations();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf("%8zu listeners: %10.1f ns per transmit %8.2f ns per listener %6.1f allocations (checksum %llu)\n", listeners, nanoseconds / transmissions, nanoseconds / (transmissions * listeners), static_cast<double>(allocations) / transmissions, static_cast<unsigned long long>(total));
+    recordResult(std::to_string(listeners) + " listeners", {
+      { "nanosecondsPerTransmit", nanoseconds / transmissions },
+      { "nanosecondsPerListener", nanoseconds / (transmissions * listeners) },
+      { "allocationsPerTransmit", static_cast<double>(allocations) / transmissions }
+    });
+  }
+}
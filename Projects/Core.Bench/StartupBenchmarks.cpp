@@ -0,0 +1,77 @@
+#include "Benchmarks.hpp"
+
+#include "BenchmarkServices.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "ScriptHost.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+  const char* RuntimeScripts[] = {
+    "/boot.lua",
+    "/syntax.lua",
+    "/syntax/cpp.lua",
+    "/syntax/glsl.lua",
+    "/syntax/markdown.lua",
+    "/syntax/text.lua"
+  };
+
+  // Create script hosts and load every runtime script, reporting the time per launch.
+  void benchmarkLaunch(const char* name, const std::string& cachePath) {
+    const std::size_t launches = 200;
+
+    std::size_t hits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t launch = 0; launch < launches; ++launch) {
+      quip::ScriptHost scriptHost(QUIP_RUNTIME_PATH, cachePath);
+      for (const char* script : RuntimeScripts) {
+        scriptHost.getScript(scriptHost.scriptRootPath() + script);
+      }
+
+      hits += scriptHost.bytecodeCache().hits();
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double microseconds = std::chrono::duration<double, std::micro>(end - start).count();
+    std::printf("%16s: %8.1f us per launch %6.1f cache hits per launch\n", name, microseconds / launches, static_cast<double>(hits) / launches);
+    quip::recordResult(name, { { "microsecondsPerLaunch", microseconds / launches }, { "cacheHitsPerLaunch", static_cast<double>(hits) / launches } });
+  }
+}
+
+namespace quip {
+  void benchmarkStartup() {
+    char pattern[] = "/tmp/QuipBench.XXXXXX";
+    std::string cachePath = mkdtemp(pattern);
+
+    benchmarkLaunch("uncached", "");
+    benchmarkLaunch("bytecode cache", cachePath);
+    std::system(("rm -rf '" + cachePath + "'").c_str());
+
+    // Edit contexts are created for every document that is opened.
+    const std::size_t contexts = 2000;
+
+    ScriptHost scriptHost(QUIP_RUNTIME_PATH);
+    NullPopupService popupService;
+    NullStatusService statusService;
+    std::shared_ptr<Document> document = std::make_shared<Document>("text\n");
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < contexts; ++index) {
+      EditContext context(&popupService, &statusService, &scriptHost, document);
+    }
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double microseconds = std::chrono::duration<double, std::micro>(end - start).count();
+    std::printf("%16s: %8.1f us per context\n", "edit context", microseconds / contexts);
+    recordResult("edit context", { { "microsecondsPerContext", microseconds / contexts } });
+  }
+}
@@ -0,0 +1,76 @@
+#include "Benchmarks.hpp"
+
+#include "ScriptHost.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace quip;
+
+int main(int argc, char** argv) {
+  // Optionally write the results as JSON (for comparison between runs) as well as printing them.
+  std::string jsonPath;
+  for (int index = 1; index < argc; ++index) {
+    if (std::strcmp(argv[index], "--json") == 0 && index + 1 < argc) {
+      jsonPath = argv[++index];
+    } else {
+      std::fprintf(stderr, "usage: %s [--json <path>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  ScriptHost scriptHost(QUIP_RUNTIME_PATH);
+  scriptHost.addNativePackagePath(QUIP_NATIVE_PATH);
+
+  beginGroup("startup", "Startup cost");
+  benchmarkStartup();
+
+  beginGroup("keystrokes", "Per-keystroke cost in edit mode");
+  benchmarkKeystrokes(scriptHost, 1);
+  benchmarkKeystrokes(scriptHost, 10000);
+
+  beginGroup("signals", "Signal transmission cost");
+  benchmarkSignals(1);
+  benchmarkSignals(10);
+  benchmarkSignals(100);
+  benchmarkSignals(1000);
+
+  beginGroup("functions", "Function dispatch cost");
+  benchmarkFunctions();
+
+  beginGroup("mappings", "Key mapping dispatch cost");
+  benchmarkMappings(10);
+  benchmarkMappings(1000);
+  benchmarkMappings(10000);
+
+  beginGroup("replay", "Recorded key stream replay rate");
+  benchmarkReplay(scriptHost);
+
+  beginGroup("scripting", "Lua to native call rate");
+  benchmarkScripting(scriptHost);
+
+  beginGroup("scripted-edits", "Scripted bulk edits");
+  benchmarkScriptedEdits(scriptHost, 1000);
+  benchmarkScriptedEdits(scriptHost, 20000);
+
+  beginGroup("documents", "Document operations on generated text");
+  benchmarkDocuments(scriptHost, CorpusKind::SourceCode, 4 * 1024 * 1024);
+  benchmarkDocuments(scriptHost, CorpusKind::Log, 4 * 1024 * 1024);
+  benchmarkDocuments(scriptHost, CorpusKind::MinifiedJson, 1024 * 1024);
+  benchmarkDocuments(scriptHost, CorpusKind::LongLines, 4 * 1024 * 1024);
+
+  beginGroup("indexed-search", "Repeated searches of a large log with a trigram index");
+  benchmarkIndexedSearch(64 * 1024 * 1024);
+
+  beginGroup("selections", "Selection set copies, sorting and algebra");
+  benchmarkSelections(scriptHost, 1000);
+  benchmarkSelections(scriptHost, 50000);
+
+  if (!jsonPath.empty() && !writeResults(jsonPath)) {
+    std::fprintf(stderr, "Failed to write results to %s.\n", jsonPath.c_str());
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "catch.hpp"
+
+#include "BracketIndex.hpp"
+#include "Document.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+
+using namespace quip;
+
+TEST_CASE("Bracket indices find nothing in an empty document.", "[BracketIndexTests]") {
+  Document document;
+
+  REQUIRE_FALSE(document.brackets().matchingBracket(Location(0, 0)).has_value());
+  REQUIRE_FALSE(document.brackets().enclosingPair(Location(0, 0)).has_value());
+}
+
+TEST_CASE("Bracket indices match brackets on the same row.", "[BracketIndexTests]") {
+  Document document("a { b [ c ] d }");
+
+  REQUIRE(*document.brackets().matchingBracket(Location(2, 0)) == Location(14, 0));
+  REQUIRE(*document.brackets().matchingBracket(Location(14, 0)) == Location(2, 0));
+  REQUIRE(*document.brackets().matchingBracket(Location(6, 0)) == Location(10, 0));
+  REQUIRE_FALSE(document.brackets().matchingBracket(Location(0, 0)).has_value());
+}
+
+TEST_CASE("Bracket indices match brackets across rows.", "[BracketIndexTests]") {
+  Document document("int main() {\n  if (x) {\n    y();\n  }\n}\n");
+
+  REQUIRE(*document.brackets().matchingBracket(Location(11, 0)) == Location(0, 4));
+  REQUIRE(*document.brackets().matchingBracket(Location(2, 3)) == Location(9, 1));
+}
+
+TEST_CASE("Bracket indices find the innermost enclosing pair.", "[BracketIndexTests]") {
+  Document document("{\n  [\n    x\n  ]\n}\n");
+  Optional<Selection> pair = document.brackets().enclosingPair(Location(4, 2));
+
+  REQUIRE(pair.has_value());
+  REQUIRE(*pair == Selection(Location(2, 1), Location(2, 3)));
+}
+
+TEST_CASE("Bracket indices find the pair enclosing a pair.", "[BracketIndexTests]") {
+  Document document("{\n  [\n    x\n  ]\n}\n");
+  Optional<Selection> pair = document.brackets().enclosingPair(Selection(Location(2, 1), Location(2, 3)));
+
+  REQUIRE(pair.has_value());
+  REQUIRE(*pair == Selection(Location(0, 0), Location(0, 4)));
+}
+
+TEST_CASE("Bracket indices nest each kind of bracket independently.", "[BracketIndexTests]") {
+  Document document("{ a < b }");
+  Optional<Selection> pair = document.brackets().enclosingPair(Location(6, 0));
+
+  REQUIRE(pair.has_value());
+  REQUIRE(*pair == Selection(Location(0, 0), Location(8, 0)));
+}
+
+TEST_CASE("Bracket indices are updated when text is inserted.", "[BracketIndexTests]") {
+  Document document("{\n  x\n}\n");
+  document.insert(Selection(Location(2, 1)), "[\n]");
+
+  REQUIRE(*document.brackets().matchingBracket(Location(2, 1)) == Location(0, 2));
+  REQUIRE(*document.brackets().matchingBracket(Location(0, 0)) == Location(0, 3));
+}
+
+TEST_CASE("Bracket indices are updated when text is erased.", "[BracketIndexTests]") {
+  Document document("{\n  {\n  }\n}\n");
+  document.erase(Selection(Location(0, 1), Location(3, 2)));
+
+  REQUIRE(document.contents() == "{\n}\n");
+  REQUIRE(*document.brackets().matchingBracket(Location(0, 0)) == Location(0, 1));
+}
+
+TEST_CASE("Bracket indices are updated when rows are rewritten between queries.", "[BracketIndexTests]") {
+  std::string text = "{\n";
+  for (std::size_t row = 1; row < 200; ++row) {
+    text += "  x\n";
+  }
+
+  Document document(text);
+  REQUIRE_FALSE(document.brackets().matchingBracket(Location(0, 0)).has_value());
+
+  document.insert(Selection(Location(0, 150)), "}");
+  REQUIRE(*document.brackets().matchingBracket(Location(0, 0)) == Location(0, 150));
+
+  document.insert(Selection(Location(0, 50)), "}");
+  REQUIRE(*document.brackets().matchingBracket(Location(0, 0)) == Location(0, 50));
+  REQUIRE_FALSE(document.brackets().matchingBracket(Location(0, 150)).has_value());
+}
+
+TEST_CASE("Bracket indices match a fresh index after many edits, whether or not they change the row count.", "[BracketIndexTests]") {
+  std::string text;
+  for (std::size_t row = 0; row < 200; ++row) {
+    text += row % 7 == 0 ? "{\n" : row % 7 == 6 ? "}\n" : row % 3 == 0 ? "  [x] <y\n" : "  z\n";
+  }
+
+  Document document(text);
+  const char* insertions[] = { "\n", "{\n", "}\n\n", "[\n]", "a<\nb>", "{", "] >" };
+  std::uint64_t seed = 12345;
+  for (std::size_t edit = 0; edit < 200; ++edit) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::size_t row = static_cast<std::size_t>(seed >> 33) % document.rows();
+    if (edit % 3 == 2 && row + 2 < document.rows()) {
+      document.erase(Selection(Location(0, row), Location(0, row + 2)));
+    } else {
+      document.insert(Selection(Location(0, row)), insertions[edit % 7]);
+    }
+  }
+
+  Document fresh(document.contents());
+  std::size_t matches = 0;
+  std::size_t mismatches = 0;
+  for (std::size_t row = 0; row < document.rows(); ++row) {
+    for (std::size_t column = 0; column < document.row(row).size(); ++column) {
+      Location location(column, row);
+      Optional<Location> edited = document.brackets().matchingBracket(location);
+      Optional<Location> built = fresh.brackets().matchingBracket(location);
+      Optional<Selection> editedPair = document.brackets().enclosingPair(location);
+      Optional<Selection> builtPair = fresh.brackets().enclosingPair(location);
+      if (edited.has_value() != built.has_value() || (edited.has_value() && *edited != *built)) {
+        ++mismatches;
+      } else if (edited.has_value()) {
+        ++matches;
+      }
+
+      if (editedPair.has_value() != builtPair.has_value() || (editedPair.has_value() && *editedPair != *builtPair)) {
+        ++mismatches;
+      }
+    }
+  }
+
+  REQUIRE(matches > 100);
+  REQUIRE(mismatches == 0);
+}
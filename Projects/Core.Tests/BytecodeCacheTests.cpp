@@ -0,0 +1,138 @@
+#include "catch.hpp"
+
+#include "BytecodeCache.hpp"
+#include "Lua.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace quip;
+
+namespace {
+  struct BytecodeCacheFixture {
+    BytecodeCacheFixture()
+    : state(luaL_newstate()) {
+      luaL_openlibs(state);
+      char pattern[] = "/tmp/QuipBytecodeCacheTests.XXXXXX";
+      directory = mkdtemp(pattern);
+      source = directory + "/script.lua";
+    }
+    
+    ~BytecodeCacheFixture() {
+      lua_close(state);
+      std::system(("rm -rf '" + directory + "'").c_str());
+    }
+    
+    void write(const std::string& text) {
+      std::ofstream stream(source, std::ios::binary | std::ios::trunc);
+      stream << text;
+    }
+    
+    lua_Integer run(BytecodeCache& cache) {
+      REQUIRE(cache.load(state, source) == LUA_OK);
+      REQUIRE(lua_pcall(state, 0, 1, 0) == LUA_OK);
+      
+      lua_Integer result = lua_tointeger(state, -1);
+      lua_pop(state, 1);
+      return result;
+    }
+    
+    std::vector<std::string> files() const {
+      std::vector<std::string> results;
+      DIR* handle = opendir(directory.c_str());
+      while (dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+          results.push_back(name);
+        }
+      }
+      
+      closedir(handle);
+      return results;
+    }
+    
+    lua_State* state;
+    std::string directory;
+    std::string source;
+  };
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches reuse compiled chunks.", "[BytecodeCacheTests]") {
+  write("return 6 * 7");
+  
+  BytecodeCache first(directory);
+  REQUIRE(run(first) == 42);
+  REQUIRE(first.misses() == 1);
+  REQUIRE(first.hits() == 0);
+  
+  BytecodeCache second(directory);
+  REQUIRE(run(second) == 42);
+  REQUIRE(second.misses() == 0);
+  REQUIRE(second.hits() == 1);
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches leave no temporary files behind.", "[BytecodeCacheTests]") {
+  write("return 1");
+  
+  BytecodeCache first(directory);
+  REQUIRE(run(first) == 1);
+  
+  write("return 2");
+  BytecodeCache second(directory);
+  REQUIRE(run(second) == 2);
+  
+  // The source and its single (rewritten) entry.
+  REQUIRE(files().size() == 2);
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches recompile changed sources.", "[BytecodeCacheTests]") {
+  write("return 1");
+  BytecodeCache cache(directory);
+  REQUIRE(run(cache) == 1);
+  
+  // The same size and (probably) the same modification time; only the hash differs.
+  write("return 2");
+  REQUIRE(run(cache) == 2);
+  REQUIRE(cache.misses() == 2);
+  REQUIRE(run(cache) == 2);
+  REQUIRE(cache.hits() == 1);
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches keep debug information.", "[BytecodeCacheTests]") {
+  write("\nerror('failed')");
+  BytecodeCache first(directory);
+  REQUIRE(first.load(state, source) == LUA_OK);
+  lua_pop(state, 1);
+  
+  BytecodeCache second(directory);
+  REQUIRE(second.load(state, source) == LUA_OK);
+  REQUIRE(second.hits() == 1);
+  REQUIRE(lua_pcall(state, 0, 0, 0) != LUA_OK);
+  REQUIRE(std::string(lua_tostring(state, -1)) == source + ":2: failed");
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches report missing and invalid sources.", "[BytecodeCacheTests]") {
+  BytecodeCache cache(directory);
+  REQUIRE(cache.load(state, source) == LUA_ERRFILE);
+  lua_pop(state, 1);
+  
+  write("return (");
+  REQUIRE(cache.load(state, source) == LUA_ERRSYNTAX);
+  lua_pop(state, 1);
+  
+  REQUIRE(lua_gettop(state) == 0);
+}
+
+TEST_CASE_METHOD(BytecodeCacheFixture, "Bytecode caches without a directory load sources directly.", "[BytecodeCacheTests]") {
+  write("return 5");
+  BytecodeCache cache;
+  REQUIRE(run(cache) == 5);
+  REQUIRE(run(cache) == 5);
+  REQUIRE(cache.hits() == 0);
+}
@@ -2,6 +2,7 @@
 
 #include "Document.hpp"
 #include "DocumentIterator.hpp"
+#include "SearchExpression.hpp"
 #include "Selection.hpp"
 #include "SelectionSet.hpp"
 
@@ -250,6 +251,17 @@ TEST_CASE("Insert text with internal newlines via a single selection.", "Documen
   REQUIRE(result.primary().origin() == Location(2, 2));
 }
 
+TEST_CASE("Append no text via multiple selections.", "Document") {
+  Document document("AB\nCD\n");
+  std::vector<Selection> selections { Selection(Location(0, 0)), Selection(Location(0, 1)) };
+  SelectionSet result = document.append(SelectionSet(selections), std::vector<std::string>());
+  
+  REQUIRE(document.contents() == "AB\nCD\n");
+  REQUIRE(result.count() == 2);
+  REQUIRE(result[0].origin() == Location(0, 0));
+  REQUIRE(result[1].origin() == Location(0, 1));
+}
+
 TEST_CASE("Erase text when empty.", "Document") {
   Document document;
   Selection selection(Location(0, 0));
@@ -409,3 +421,33 @@ TEST_CASE("Erase the last character of the document.", "Document") {
   REQUIRE(document.rows() == 0);
   REQUIRE(result.primary().origin() == Location(0, 0));
 }
+
+TEST_CASE("Search only the text within selections.", "Document") {
+  Document document("one two one\ntwo one two\none\n");
+  SelectionSet within(std::vector<Selection> { Selection(Location(4, 0), Location(2, 1)), Selection(Location(0, 2), Location(3, 2)) });
+  SelectionSet matches = document.matches(SearchExpression("one|two"), within);
+  
+  REQUIRE(matches.count() == 4);
+  REQUIRE(matches[0] == Selection(Location(4, 0), Location(6, 0)));
+  REQUIRE(matches[1] == Selection(Location(8, 0), Location(10, 0)));
+  REQUIRE(matches[2] == Selection(Location(0, 1), Location(2, 1)));
+  REQUIRE(matches[3] == Selection(Location(0, 2), Location(2, 2)));
+}
+
+TEST_CASE("Search within selections does not match across their bounds.", "Document") {
+  Document document("abcdef\n");
+  SelectionSet within(std::vector<Selection> { Selection(Location(0, 0), Location(2, 0)), Selection(Location(3, 0), Location(5, 0)) });
+  
+  REQUIRE(document.matches(SearchExpression("cd"), within).count() == 0);
+  REQUIRE(document.matches(SearchExpression("^d"), within).count() == 0);
+  REQUIRE(document.matches(SearchExpression("^a"), within).count() == 1);
+}
+
+TEST_CASE("Search within selections matches across rows.", "Document") {
+  Document document("ab\ncd\nef\n");
+  SelectionSet within(Selection(Location(1, 0), Location(1, 2)));
+  SelectionSet matches = document.matches(SearchExpression("d\ne"), within);
+  
+  REQUIRE(matches.count() == 1);
+  REQUIRE(matches[0] == Selection(Location(1, 1), Location(0, 2)));
+}
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "FileTypeDatabase.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace quip;
+
+TEST_CASE("File type databases look up types by extension.", "[FileTypeDatabaseTests]") {
+  FileTypeDatabase database("/runtime", { { "Text", "text", { "txt", "text" } }, { "C++ Source", "cpp", { "cpp", "cxx" } } });
+  
+  REQUIRE(database.lookupByExtension("txt")->name == "Text");
+  REQUIRE(database.lookupByExtension("text")->name == "Text");
+  REQUIRE(database.lookupByExtension("cxx")->name == "C++ Source");
+  REQUIRE(database.lookupByExtension("cxx")->syntax.identifier() == "/runtime/syntax/cpp.lua");
+}
+
+TEST_CASE("File type databases fall back to the unknown type.", "[FileTypeDatabaseTests]") {
+  FileTypeDatabase database("/runtime", { { "Text", "text", { "txt" } } });
+  
+  REQUIRE(database.lookupByExtension("tx")->name == "?");
+  REQUIRE(database.lookupByExtension("")->name == "?");
+  REQUIRE(database.lookupByExtension("txt2")->syntax.identifier() == "/runtime/syntax/text.lua");
+}
+
+TEST_CASE("File type databases keep the first registration of an extension.", "[FileTypeDatabaseTests]") {
+  FileTypeDatabase database("/runtime", { { "C++ Source", "cpp", { "cpp" } }, { "Other", "other", { "cpp", "cc" } } });
+  
+  REQUIRE(database.lookupByExtension("cpp")->name == "C++ Source");
+  REQUIRE(database.lookupByExtension("cc")->name == "Other");
+}
+
+TEST_CASE("File type databases look up types by path.", "[FileTypeDatabaseTests]") {
+  FileTypeDatabase database("/runtime", { { "Markdown", "markdown", { "md" } } });
+  
+  REQUIRE(database.lookupByPath("/notes/readme.md")->name == "Markdown");
+  REQUIRE(database.lookupByPath("/notes.md/readme")->name == "?");
+  REQUIRE(database.lookupByPath("readme")->name == "?");
+  REQUIRE(database.lookupByPath("readme.")->name == "?");
+}
+
+TEST_CASE("File type databases handle many extensions.", "[FileTypeDatabaseTests]") {
+  std::vector<FileTypeRegistration> registrations;
+  for (int index = 0; index < 500; ++index) {
+    registrations.push_back({ "Type " + std::to_string(index), "type", { "e" + std::to_string(index), "x" + std::to_string(index) } });
+  }
+  
+  FileTypeDatabase database("/runtime", registrations);
+  for (int index = 0; index < 500; ++index) {
+    REQUIRE(database.lookupByExtension("x" + std::to_string(index))->name == "Type " + std::to_string(index));
+  }
+}
+
+TEST_CASE("Standard file type databases are shared.", "[FileTypeDatabaseTests]") {
+  std::shared_ptr<const FileTypeDatabase> database = FileTypeDatabase::standard("/runtime");
+  
+  REQUIRE(database == FileTypeDatabase::standard("/runtime"));
+  REQUIRE(database != FileTypeDatabase::standard("/other"));
+  REQUIRE(database->lookupByExtension("hpp")->name == "C++ Header");
+  REQUIRE(database->lookupByExtension("vsh")->syntax.identifier() == "/runtime/syntax/glsl.lua");
+}
+
+TEST_CASE("Standard file type databases can be used from many threads.", "[FileTypeDatabaseTests]") {
+  std::atomic<int> failures(0);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 8; ++thread) {
+    threads.emplace_back([&failures]() {
+      for (int index = 0; index < 1000; ++index) {
+        std::shared_ptr<const FileTypeDatabase> database = FileTypeDatabase::standard("/threads");
+        if (database->lookupByPath("main.cpp")->name != "C++ Source" || database->lookupByPath("main.rs")->name != "?") {
+          ++failures;
+        }
+      }
+    });
+  }
+  
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  
+  REQUIRE(failures == 0);
+}
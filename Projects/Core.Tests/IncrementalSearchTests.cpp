@@ -0,0 +1,133 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "IncrementalSearch.hpp"
+#include "Location.hpp"
+#include "SearchExpression.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  bool equal(const SelectionSet& left, const SelectionSet& right) {
+    if (left.count() != right.count()) {
+      return false;
+    }
+
+    for (std::size_t index = 0; index < left.count(); ++index) {
+      if (left[index] != right[index]) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+TEST_CASE("Incremental search refines literal matches.", "[IncrementalSearchTests]") {
+  Document document("int count = counter(country);\ncount += county;\nco\nunt\n");
+  IncrementalSearch search;
+  std::string typed;
+  for (char character : std::string("count")) {
+    typed += character;
+    SelectionSet matches = search.matches(document, SearchExpression(typed));
+    REQUIRE(equal(matches, document.matches(SearchExpression(typed))));
+  }
+
+  REQUIRE(search.scans() == 1);
+  REQUIRE(search.refinements() == 4);
+  REQUIRE(search.matches(document, SearchExpression("count")).count() == 5);
+}
+
+TEST_CASE("Incremental search extends matches across rows.", "[IncrementalSearchTests]") {
+  Document document("ab\ncd\nab\n");
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("b"));
+  SelectionSet matches = search.matches(document, SearchExpression("b\nc"));
+
+  REQUIRE(search.refinements() == 1);
+  REQUIRE(matches.count() == 1);
+  REQUIRE(matches[0] == Selection(Location(1, 0), Location(0, 1)));
+}
+
+TEST_CASE("Incremental search scans again when matches could overlap.", "[IncrementalSearchTests]") {
+  Document document("aaab\n");
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("a"));
+  search.matches(document, SearchExpression("aa"));
+  SelectionSet matches = search.matches(document, SearchExpression("aab"));
+
+  REQUIRE(search.refinements() == 0);
+  REQUIRE(search.scans() == 3);
+  REQUIRE(matches.count() == 1);
+  REQUIRE(matches[0] == Selection(Location(1, 0), Location(3, 0)));
+}
+
+TEST_CASE("Incremental search scans again when the longer literal could overlap.", "[IncrementalSearchTests]") {
+  Document document("ababa\n");
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("a"));
+  search.matches(document, SearchExpression("ab"));
+  SelectionSet matches = search.matches(document, SearchExpression("aba"));
+
+  REQUIRE(search.refinements() == 1);
+  REQUIRE(search.scans() == 2);
+  REQUIRE(equal(matches, document.matches(SearchExpression("aba"))));
+  REQUIRE(matches.count() == 1);
+  REQUIRE(matches[0] == Selection(Location(0, 0), Location(2, 0)));
+}
+
+TEST_CASE("Incremental search scans again for patterns.", "[IncrementalSearchTests]") {
+  Document document("one two three\n");
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("t"));
+  SelectionSet matches = search.matches(document, SearchExpression("t."));
+
+  REQUIRE(search.scans() == 2);
+  REQUIRE(search.refinements() == 0);
+  REQUIRE(matches.count() == 2);
+}
+
+TEST_CASE("Incremental search restores earlier matches when characters are removed.", "[IncrementalSearchTests]") {
+  Document document("one two three two one\n");
+  IncrementalSearch search;
+  SelectionSet first = search.matches(document, SearchExpression("t"));
+  search.matches(document, SearchExpression("tw"));
+  SelectionSet restored = search.matches(document, SearchExpression("t"));
+
+  REQUIRE(search.restorations() == 1);
+  REQUIRE(search.scans() == 1);
+  REQUIRE(equal(restored, first));
+
+  search.matches(document, SearchExpression("th"));
+  REQUIRE(search.refinements() == 2);
+  REQUIRE(search.scans() == 1);
+}
+
+TEST_CASE("Incremental search scans again after the document changes.", "[IncrementalSearchTests]") {
+  Document document("one two\n");
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("o"));
+  document.insert(Selection(Location(0, 0)), "on");
+  SelectionSet matches = search.matches(document, SearchExpression("on"));
+
+  REQUIRE(search.scans() == 2);
+  REQUIRE(matches.count() == 2);
+}
+
+TEST_CASE("Incremental search within selections keeps matches inside them.", "[IncrementalSearchTests]") {
+  Document document("abc abc abc\n");
+  SelectionSet within(std::vector<Selection> { Selection(Location(0, 0), Location(5, 0)), Selection(Location(8, 0), Location(10, 0)) });
+  IncrementalSearch search;
+  search.matches(document, SearchExpression("ab"), within);
+  SelectionSet matches = search.matches(document, SearchExpression("abc"), within);
+
+  REQUIRE(search.refinements() == 1);
+  REQUIRE(equal(matches, document.matches(SearchExpression("abc"), within)));
+  REQUIRE(matches.count() == 2);
+  REQUIRE(matches[1] == Selection(Location(8, 0), Location(10, 0)));
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include "InplaceFunction.hpp"
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+using namespace quip;
+
+namespace {
+  struct Counter {
+    int value;
+
+    void increment(int amount) {
+      value += amount;
+    }
+  };
+}
+
+TEST_CASE("Inplace functions are empty by default.", "[InplaceFunctionTests]") {
+  InplaceFunction<void ()> function;
+  REQUIRE(function == nullptr);
+  REQUIRE_FALSE(function);
+  REQUIRE_THROWS_AS(function(), std::bad_function_call);
+}
+
+TEST_CASE("Inplace functions call their target.", "[InplaceFunctionTests]") {
+  int base = 10;
+  InplaceFunction<int (int)> function([&](int value) { return base + value; });
+  REQUIRE(function != nullptr);
+  REQUIRE(function(5) == 15);
+}
+
+TEST_CASE("Inplace functions can call member functions.", "[InplaceFunctionTests]") {
+  Counter counter { 0 };
+  void (Counter::*callback)(int) = &Counter::increment;
+  Counter* target = &counter;
+  InplaceFunction<void (int)> function([target, callback](int amount) { (target->*callback)(amount); });
+  function(3);
+  function(4);
+  REQUIRE(counter.value == 7);
+}
+
+TEST_CASE("Inplace functions call member pointers.", "[InplaceFunctionTests]") {
+  Counter counter { 0 };
+  InplaceFunction<void (Counter&, int)> increment(&Counter::increment);
+  InplaceFunction<int (const Counter*)> value(&Counter::value);
+  increment(counter, 5);
+  REQUIRE(counter.value == 5);
+  REQUIRE(value(&counter) == 5);
+}
+
+TEST_CASE("Inplace functions are empty when given null pointers.", "[InplaceFunctionTests]") {
+  int (*function)(int) = nullptr;
+  void (Counter::*member)(int) = nullptr;
+  InplaceFunction<int (int)> fromFunction(function);
+  InplaceFunction<void (Counter&, int)> fromMember(member);
+  REQUIRE_FALSE(fromFunction);
+  REQUIRE_FALSE(fromMember);
+  REQUIRE_THROWS_AS(fromFunction(1), std::bad_function_call);
+
+  fromFunction = [](int value) { return value; };
+  REQUIRE(fromFunction);
+  fromFunction = function;
+  REQUIRE(fromFunction == nullptr);
+}
+
+TEST_CASE("Inplace functions can be copied.", "[InplaceFunctionTests]") {
+  std::shared_ptr<int> value = std::make_shared<int>(42);
+  InplaceFunction<int ()> function([value] { return *value; });
+  InplaceFunction<int ()> copy(function);
+  REQUIRE(value.use_count() == 3);
+  REQUIRE(function() == 42);
+  REQUIRE(copy() == 42);
+
+  InplaceFunction<int ()> assigned;
+  assigned = copy;
+  REQUIRE(value.use_count() == 4);
+  REQUIRE(assigned() == 42);
+}
+
+TEST_CASE("Inplace functions can be moved.", "[InplaceFunctionTests]") {
+  std::shared_ptr<int> value = std::make_shared<int>(42);
+  InplaceFunction<int ()> function([value] { return *value; });
+  InplaceFunction<int ()> moved(std::move(function));
+  REQUIRE(moved() == 42);
+
+  InplaceFunction<int ()> assigned;
+  assigned = std::move(moved);
+  REQUIRE(assigned() == 42);
+  REQUIRE(value.use_count() == 2);
+}
+
+TEST_CASE("Inplace functions move without throwing.", "[InplaceFunctionTests]") {
+  REQUIRE(std::is_nothrow_move_constructible<InplaceFunction<int ()>>::value);
+  REQUIRE(std::is_nothrow_move_assignable<InplaceFunction<int ()>>::value);
+}
+
+TEST_CASE("Inplace functions destroy their target.", "[InplaceFunctionTests]") {
+  std::shared_ptr<int> value = std::make_shared<int>(42);
+  {
+    InplaceFunction<int ()> function([value] { return *value; });
+    REQUIRE(value.use_count() == 2);
+
+    function = nullptr;
+    REQUIRE(value.use_count() == 1);
+    REQUIRE(function == nullptr);
+
+    function = [value] { return *value + 1; };
+    REQUIRE(function() == 43);
+    REQUIRE(value.use_count() == 2);
+  }
+
+  REQUIRE(value.use_count() == 1);
+}
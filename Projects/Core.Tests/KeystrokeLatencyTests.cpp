@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Key.hpp"
+#include "KeystrokeLatency.hpp"
+#include "Modifiers.hpp"
+#include "ScriptHost.hpp"
+#include "TestServices.hpp"
+
+#include <memory>
+#include <string>
+
+using namespace quip;
+
+TEST_CASE("Keystroke latency is recorded for every key event.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::W, Modifiers(), "w");
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  fixture.context.processKeyEvent(Key::Escape, Modifiers(), "");
+
+  const KeystrokeLatency& latency = KeystrokeLatency::shared();
+  REQUIRE(latency.all().count() == 4);
+  REQUIRE(latency.all().maximum() > 0);
+}
+
+TEST_CASE("Keystroke latency is attributed to the mode that received the key.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  fixture.context.processKeyEvent(Key::Y, Modifiers(), "y");
+
+  const KeystrokeLatency& latency = KeystrokeLatency::shared();
+  REQUIRE(latency.mode("NormalMode") != nullptr);
+  REQUIRE(latency.mode("NormalMode")->count() == 1);
+  REQUIRE(latency.mode("EditMode") != nullptr);
+  REQUIRE(latency.mode("EditMode")->count() == 2);
+  REQUIRE(latency.mode("JumpMode") == nullptr);
+}
+
+TEST_CASE("Keystroke latency is attributed to commands by key sequence.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  fixture.context.processKeyEvent(Key::Escape, Modifiers(), "");
+
+  const KeystrokeLatency& latency = KeystrokeLatency::shared();
+  REQUIRE(latency.command("I") != nullptr);
+  REQUIRE(latency.command("I")->count() == 1);
+  REQUIRE(latency.command("(unmapped)") != nullptr);
+  REQUIRE(latency.command("<Esc>") != nullptr);
+}
+
+TEST_CASE("Keystroke latency is not attributed to commands for counts.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::Key2, Modifiers(), "2");
+  fixture.context.processKeyEvent(Key::W, Modifiers(), "w");
+
+  const KeystrokeLatency& latency = KeystrokeLatency::shared();
+  REQUIRE(latency.all().count() == 2);
+  REQUIRE(latency.command("W") != nullptr);
+  REQUIRE(latency.command("W")->count() == 1);
+}
+
+TEST_CASE("Keystroke latency reports summaries as JSON.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::W, Modifiers(), "w");
+
+  std::string report = KeystrokeLatency::shared().report();
+  REQUIRE(report.find("\"all\": { \"count\": 1, \"p50\": ") != std::string::npos);
+  REQUIRE(report.find("\"NormalMode\": { \"count\": 1,") != std::string::npos);
+  REQUIRE(report.find("\"W\": { \"count\": 1,") != std::string::npos);
+}
+
+TEST_CASE("Keystroke latency can be queried by scripts.", "[KeystrokeLatencyTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  KeystrokeLatency::shared().clear();
+  fixture.context.processKeyEvent(Key::W, Modifiers(), "w");
+  fixture.context.processKeyEvent(Key::W, Modifiers(), "w");
+
+  REQUIRE(fixture.scriptHost.execute("assert(quip.latency.count == 2)"));
+  REQUIRE(fixture.scriptHost.execute("assert(quip.latency:percentile(99) <= quip.latency.maximum)"));
+  REQUIRE(fixture.scriptHost.execute("assert(quip.latency:commandPercentile('W', 50) > 0)"));
+  REQUIRE(fixture.scriptHost.execute("assert(quip.latency:modePercentile('EditMode', 50) == 0)"));
+  REQUIRE(fixture.scriptHost.execute("assert(quip.latency:report():find('NormalMode'))"));
+  REQUIRE(fixture.scriptHost.execute("quip.latency:clear() assert(quip.latency.count == 0)"));
+}
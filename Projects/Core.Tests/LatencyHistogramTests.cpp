@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include "LatencyHistogram.hpp"
+
+#include <cstdint>
+
+using namespace quip;
+
+TEST_CASE("Latency histograms report zero when empty.", "[LatencyHistogramTests]") {
+  LatencyHistogram histogram;
+
+  REQUIRE(histogram.count() == 0);
+  REQUIRE(histogram.maximum() == 0);
+  REQUIRE(histogram.percentile(50.0) == 0);
+}
+
+TEST_CASE("Latency histograms count small values exactly.", "[LatencyHistogramTests]") {
+  LatencyHistogram histogram;
+  for (std::uint64_t value = 1; value <= 10; ++value) {
+    histogram.record(value);
+  }
+
+  REQUIRE(histogram.count() == 10);
+  REQUIRE(histogram.minimum() == 1);
+  REQUIRE(histogram.maximum() == 10);
+  REQUIRE(histogram.percentile(50.0) == 5);
+  REQUIRE(histogram.percentile(90.0) == 9);
+  REQUIRE(histogram.percentile(100.0) == 10);
+  REQUIRE(histogram.percentile(0.0) == 1);
+}
+
+TEST_CASE("Latency histograms bound the relative error of large values.", "[LatencyHistogramTests]") {
+  for (std::uint64_t value = 1000; value <= 1000000000; value = value * 3 / 2) {
+    LatencyHistogram histogram;
+    histogram.record(value);
+    histogram.record(value + 1);
+
+    std::uint64_t reported = histogram.percentile(50.0);
+    REQUIRE(reported >= value);
+    REQUIRE(reported - value <= value / 32);
+  }
+}
+
+TEST_CASE("Latency histograms find tail percentiles.", "[LatencyHistogramTests]") {
+  LatencyHistogram histogram;
+  for (std::size_t index = 0; index < 990; ++index) {
+    histogram.record(100000);
+  }
+
+  for (std::size_t index = 0; index < 10; ++index) {
+    histogram.record(50000000);
+  }
+
+  REQUIRE(histogram.percentile(50.0) >= 100000);
+  REQUIRE(histogram.percentile(50.0) < 104000);
+  REQUIRE(histogram.percentile(99.0) < 104000);
+  REQUIRE(histogram.percentile(99.9) == 50000000);
+  REQUIRE(histogram.maximum() == 50000000);
+}
+
+TEST_CASE("Latency histograms clamp huge values.", "[LatencyHistogramTests]") {
+  LatencyHistogram histogram;
+  histogram.record(~std::uint64_t(0));
+
+  REQUIRE(histogram.count() == 1);
+  REQUIRE(histogram.maximum() == (std::uint64_t(1) << 48) - 1);
+  REQUIRE(histogram.percentile(50.0) == histogram.maximum());
+}
+
+TEST_CASE("Latency histograms can be cleared.", "[LatencyHistogramTests]") {
+  LatencyHistogram histogram;
+  histogram.record(42);
+  histogram.clear();
+
+  REQUIRE(histogram.count() == 0);
+  REQUIRE(histogram.percentile(99.0) == 0);
+}
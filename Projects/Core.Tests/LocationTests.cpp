@@ -2,6 +2,8 @@
 
 #include "Location.hpp"
 
+#include <cstdint>
+
 using namespace quip;
 
 TEST_CASE("Locations can be default-constructed.", "Location") {
@@ -70,3 +72,24 @@ TEST_CASE("Locations can be swapped.", "Location") {
   REQUIRE(a.row() == 4);
   REQUIRE(b.row() == 2);
 }
+
+TEST_CASE("Locations are packed into ordered keys.", "Location") {
+  Location a(100, 1);
+  Location b(0, 2);
+  
+  REQUIRE(sizeof(Location) == sizeof(std::uint64_t));
+  REQUIRE(a.key() < b.key());
+  REQUIRE(Location::fromKey(a.key()) == a);
+  REQUIRE(Location::fromKey(b.key()).column() == 0);
+  REQUIRE(Location::fromKey(b.key()).row() == 2);
+}
+
+TEST_CASE("Locations clamp coordinates beyond 32 bits to the invalid coordinate.", "Location") {
+  Location location(std::uint64_t(1) << 40, 3);
+  
+  REQUIRE(!location.isValid());
+  REQUIRE(location.row() == 3);
+  REQUIRE(Location(Location::invalid().column(), Location::invalid().row()) == Location::invalid());
+  REQUIRE(Location(0xFFFFFFFE, 0xFFFFFFFE).isValid());
+  REQUIRE(Location(0xFFFFFFFE, 0xFFFFFFFE) < Location::invalid());
+}
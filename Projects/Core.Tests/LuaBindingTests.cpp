@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "LuaBinding.hpp"
+#include "Location.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "ScriptHost.hpp"
+
+#include <string>
+
+using namespace quip;
+
+namespace {
+  struct Probe {
+    Probe()
+    : count(0)
+    , isEnabled(false)
+    , location(0, 0) {
+    }
+    
+    int count;
+    bool isEnabled;
+    std::string name;
+    Location location;
+    SelectionSet selections;
+    
+    int getCount() const { return count; }
+    void setCount(int value) { count = value; }
+    
+    bool getEnabled() const { return isEnabled; }
+    void setEnabled(bool value) { isEnabled = value; }
+    
+    const std::string& getName() const { return name; }
+    void setName(const std::string& value) { name = value; }
+    
+    int add(int left, int right) { return left + right; }
+    void increment() { ++count; }
+    
+    void moveTo(const Location& value) { location = value; }
+    Location nextColumn(const Location& value, int step) const { return Location(value.column() + step, value.row()); }
+    
+    void select(const SelectionSet& value) { selections = value; }
+    SelectionSet selection() const { return selections; }
+    
+    static LuaBinding binding() {
+      LuaBinding result;
+      result.addProperty("count", &Probe::getCount, &Probe::setCount);
+      result.addProperty("enabled", &Probe::getEnabled, &Probe::setEnabled);
+      result.addProperty("name", &Probe::getName, &Probe::setName);
+      result.addProperty("column", &Probe::getCount);
+      result.addFunction("add", &Probe::add);
+      result.addFunction("increment", &Probe::increment);
+      result.addFunction("moveTo", &Probe::moveTo);
+      result.addFunction("nextColumn", &Probe::nextColumn);
+      result.addFunction("select", &Probe::select);
+      result.addFunction("selection", &Probe::selection);
+      return result;
+    }
+  };
+  
+  struct LuaBindingFixture {
+    LuaBindingFixture()
+    : scriptHost(QUIP_RUNTIME_PATH) {
+      scriptHost.bind(&probe, "probe");
+      scriptHost.bind(&result, "result");
+    }
+    
+    ScriptHost scriptHost;
+    Probe probe;
+    Probe result;
+  };
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Bound properties can be read and written from Lua.", "[LuaBindingTests]") {
+  probe.count = 7;
+  probe.name = "quip";
+  
+  REQUIRE(scriptHost.execute("quip.result.count = quip.probe.count * 2"));
+  REQUIRE(scriptHost.execute("quip.result.name = quip.probe.name .. '!'"));
+  REQUIRE(scriptHost.execute("quip.probe.enabled = true"));
+  
+  REQUIRE(result.count == 14);
+  REQUIRE(result.name == "quip!");
+  REQUIRE(probe.isEnabled);
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Bound functions can be called with method or field syntax.", "[LuaBindingTests]") {
+  REQUIRE(scriptHost.execute("quip.result.count = quip.probe:add(2, 3) + quip.probe.add(10, 20)"));
+  REQUIRE(scriptHost.execute("for i = 1, 5 do quip.probe:increment() end"));
+  
+  REQUIRE(result.count == 35);
+  REQUIRE(probe.count == 5);
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Bound functions are cached per member.", "[LuaBindingTests]") {
+  REQUIRE(scriptHost.execute("quip.result.enabled = rawequal(quip.probe.add, quip.probe.add)"));
+  REQUIRE(result.isEnabled);
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Bound locations occupy two Lua values.", "[LuaBindingTests]") {
+  REQUIRE(scriptHost.execute("quip.probe:moveTo(quip.probe:nextColumn(3, 4, 2))"));
+  REQUIRE(probe.location == Location(5, 4));
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Bound selection sets round-trip through Lua.", "[LuaBindingTests]") {
+  SelectionSet selections(std::vector<Selection>({ Selection(0, 0, 3, 0), Selection(1, 2, 4, 2), Selection(0, 5) }));
+  selections.rotateForward();
+  probe.selections = selections;
+  
+  REQUIRE(scriptHost.execute("local s = quip.probe:selection() quip.result.count = #s * 10 + s.primary quip.result:select(s)"));
+  
+  REQUIRE(result.count == 122);
+  REQUIRE(result.selections.count() == 3);
+  REQUIRE(result.selections[1] == Selection(1, 2, 4, 2));
+  REQUIRE(result.selections.primary() == Selection(1, 2, 4, 2));
+}
+
+TEST_CASE_METHOD(LuaBindingFixture, "Read-only and unknown members raise Lua errors.", "[LuaBindingTests]") {
+  probe.count = 3;
+  
+  REQUIRE(scriptHost.execute("quip.result.count = quip.probe.column"));
+  REQUIRE_FALSE(scriptHost.execute("quip.probe.column = 4"));
+  REQUIRE_FALSE(scriptHost.execute("return quip.probe.missing"));
+  
+  REQUIRE(result.count == 3);
+  REQUIRE(probe.count == 3);
+}
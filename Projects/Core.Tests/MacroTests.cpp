@@ -0,0 +1,160 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "KeyEvent.hpp"
+#include "Macro.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "TestServices.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  KeyEvent makeEvent(Key key, const std::string& text, bool shift = false) {
+    KeyEvent result { key, Modifiers(), text };
+    result.modifiers.shift = shift;
+    return result;
+  }
+
+  // Insert an "x" at the start of the current row, then move down a row.
+  Macro makeEditMacro() {
+    Macro result;
+    result.append(makeEvent(Key::I, "i"));
+    result.append(makeEvent(Key::X, "x"));
+    result.append(makeEvent(Key::Escape, "\x1b"));
+    result.append(makeEvent(Key::H, "h"));
+    result.append(makeEvent(Key::J, "j"));
+    return result;
+  }
+}
+
+TEST_CASE("Macros are empty by default.", "[MacroTests]") {
+  Macro macro;
+  KeyEvent event;
+  std::size_t offset = 0;
+
+  REQUIRE(macro.isEmpty());
+  REQUIRE(macro.count() == 0);
+  REQUIRE_FALSE(macro.read(offset, event));
+}
+
+TEST_CASE("Macros read back the events appended to them.", "[MacroTests]") {
+  Macro macro;
+  macro.append(makeEvent(Key::J, "j"));
+  macro.append(makeEvent(modifierDown(Key::ShiftMask), "", true));
+  macro.append(makeEvent(Key::Return, "\n  indented"));
+  REQUIRE(macro.count() == 3);
+
+  KeyEvent event;
+  std::size_t offset = 0;
+  REQUIRE(macro.read(offset, event));
+  REQUIRE(event.key == Key::J);
+  REQUIRE(event.text == "j");
+  REQUIRE_FALSE(event.modifiers.shift);
+
+  REQUIRE(macro.read(offset, event));
+  REQUIRE(event.key == modifierDown(Key::ShiftMask));
+  REQUIRE(event.text == "");
+  REQUIRE(event.modifiers.shift);
+  REQUIRE_FALSE(event.modifiers.control);
+
+  REQUIRE(macro.read(offset, event));
+  REQUIRE(event.key == Key::Return);
+  REQUIRE(event.text == "\n  indented");
+
+  REQUIRE_FALSE(macro.read(offset, event));
+}
+
+TEST_CASE("Macros can be restored from their bytes.", "[MacroTests]") {
+  Macro macro = makeEditMacro();
+  Optional<Macro> restored = Macro::fromBytes(macro.bytes());
+
+  REQUIRE(restored.has_value());
+  REQUIRE(restored->count() == macro.count());
+  REQUIRE(restored->bytes() == macro.bytes());
+}
+
+TEST_CASE("Macros can't be restored from malformed bytes.", "[MacroTests]") {
+  std::vector<std::uint8_t> bytes = makeEditMacro().bytes();
+
+  REQUIRE_FALSE(Macro::fromBytes(std::vector<std::uint8_t>()).has_value());
+  REQUIRE_FALSE(Macro::fromBytes(std::vector<std::uint8_t>(bytes.begin() + 1, bytes.end())).has_value());
+  REQUIRE_FALSE(Macro::fromBytes(std::vector<std::uint8_t>(bytes.begin(), bytes.end() - 1)).has_value());
+}
+
+TEST_CASE("Edit contexts record and replay macros.", "[MacroTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\n");
+
+  fixture.context.startRecording();
+  REQUIRE(fixture.context.isRecording());
+
+  Macro edit = makeEditMacro();
+  KeyEvent event;
+  std::size_t offset = 0;
+  while (edit.read(offset, event)) {
+    fixture.context.processKeyEvent(event.key, event.modifiers, event.text);
+  }
+
+  Macro recorded = fixture.context.stopRecording();
+  REQUIRE_FALSE(fixture.context.isRecording());
+  REQUIRE(recorded.bytes() == edit.bytes());
+  REQUIRE(fixture.document->contents() == "xzero\none\ntwo\nthree\n");
+
+  fixture.context.replay(recorded);
+  fixture.context.replay(recorded);
+  REQUIRE(fixture.document->contents() == "xzero\nxone\nxtwo\nthree\n");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 3)));
+}
+
+TEST_CASE("Edit contexts coalesce view signals while replaying macros.", "[MacroTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\n");
+
+  int modifications = 0;
+  std::vector<ChangeType> transactions;
+  int reveals = 0;
+  fixture.document->onDocumentModified().connect([&] { ++modifications; });
+  fixture.context.onTransactionApplied().connect([&](ChangeType type) { transactions.push_back(type); });
+  fixture.context.controller().scrollLocationIntoView.connect([&](Location) { ++reveals; });
+
+  Macro macro = makeEditMacro();
+  macro.append(makeEvent(Key::I, "i"));
+  macro.append(makeEvent(Key::Y, "y"));
+  macro.append(makeEvent(Key::Escape, "\x1b"));
+  fixture.context.replay(macro);
+
+  REQUIRE(fixture.document->contents() == "xzero\nyone\ntwo\nthree\n");
+  REQUIRE(modifications == 1);
+  REQUIRE(transactions.size() == 2);
+  REQUIRE(transactions[0] == ChangeType::Do);
+  REQUIRE(transactions[1] == ChangeType::Do);
+  REQUIRE(reveals == 1);
+}
+
+TEST_CASE("Edit contexts restore their state when a replayed macro throws.", "[MacroTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\n");
+
+  int modifications = 0;
+  int reveals = 0;
+  fixture.document->onDocumentModified().connect([&] { ++modifications; });
+  fixture.context.controller().scrollLocationIntoView.connect([&](Location) { ++reveals; });
+  std::uint32_t token = fixture.context.onTransactionApplied().connect([](ChangeType) {
+    throw std::runtime_error("listener failed");
+  });
+
+  fixture.context.startRecording();
+  REQUIRE_THROWS(fixture.context.replay(makeEditMacro()));
+  REQUIRE(fixture.context.isRecording());
+
+  fixture.context.onTransactionApplied().disconnect(token);
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  REQUIRE(modifications > 0);
+  REQUIRE(reveals > 0);
+}
@@ -0,0 +1,81 @@
+#include "catch.hpp"
+
+#include "KeySequence.hpp"
+#include "MapTrie.hpp"
+
+#include <memory>
+
+using namespace quip;
+
+namespace {
+  MapHandler makeHandler() {
+    return [](EditContext&, std::uint32_t) {};
+  }
+}
+
+TEST_CASE("Map tries find nothing when empty.", "[MapTrieTests]") {
+  MapTrie trie;
+
+  REQUIRE(trie.find("A") == MapTrie::InvalidNode);
+  REQUIRE_FALSE(trie.hasChildren(trie.root()));
+  REQUIRE(trie.handler(trie.root()) == nullptr);
+}
+
+TEST_CASE("Map tries find mapped sequences.", "[MapTrieTests]") {
+  MapTrie trie;
+  trie.insert("W", makeHandler());
+  trie.insert("RW", makeHandler());
+  trie.insert("<S-H>", makeHandler());
+
+  MapTrie::Node node = trie.find("RW");
+  REQUIRE(node != MapTrie::InvalidNode);
+  REQUIRE(trie.handler(node) != nullptr);
+  REQUIRE(trie.find("<S-H>") != MapTrie::InvalidNode);
+  REQUIRE(trie.handler(trie.find("<S-H>")) != nullptr);
+  REQUIRE(trie.find("H") == MapTrie::InvalidNode);
+  REQUIRE(trie.find("RX") == MapTrie::InvalidNode);
+}
+
+TEST_CASE("Map tries represent prefixes without handlers.", "[MapTrieTests]") {
+  MapTrie trie;
+  trie.insert("RW", makeHandler());
+  trie.insert("RF", makeHandler());
+
+  MapTrie::Node node = trie.find("R");
+  REQUIRE(node != MapTrie::InvalidNode);
+  REQUIRE(trie.hasChildren(node));
+  REQUIRE(trie.handler(node) == nullptr);
+}
+
+TEST_CASE("Map tries advance one key at a time.", "[MapTrieTests]") {
+  MapTrie trie;
+  trie.insert("RW", makeHandler());
+  trie.insert("RF", makeHandler());
+  trie.insert("PL", makeHandler());
+
+  MapTrie::Node node = trie.advance(trie.root(), Key::R);
+  REQUIRE(node == trie.find("R"));
+
+  node = trie.advance(node, Key::F);
+  REQUIRE(node == trie.find("RF"));
+  REQUIRE_FALSE(trie.hasChildren(node));
+
+  REQUIRE(trie.advance(node, Key::F) == MapTrie::InvalidNode);
+  REQUIRE(trie.advance(MapTrie::InvalidNode, Key::F) == MapTrie::InvalidNode);
+}
+
+TEST_CASE("Map tries replace the handler of a remapped sequence.", "[MapTrieTests]") {
+  std::shared_ptr<int> first = std::make_shared<int>(1);
+  std::shared_ptr<int> second = std::make_shared<int>(2);
+  MapTrie trie;
+  trie.insert("W", [first](EditContext&, std::uint32_t) {});
+  REQUIRE(trie.handler(trie.find("W")) != nullptr);
+  REQUIRE(first.use_count() == 2);
+
+  trie.insert("W", [second](EditContext&, std::uint32_t) {});
+  trie.insert("B", makeHandler());
+  REQUIRE(first.use_count() == 1);
+  REQUIRE(second.use_count() == 2);
+  REQUIRE(trie.handler(trie.find("W")) != nullptr);
+  REQUIRE(trie.handler(trie.find("B")) != nullptr);
+}
@@ -0,0 +1,137 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "MarkerSet.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+
+#include <random>
+
+using namespace quip;
+
+TEST_CASE("Marker sets can be default-constructed.", "[MarkerSetTests]") {
+  MarkerSet markers;
+
+  REQUIRE(markers.count() == 0);
+  REQUIRE_FALSE(markers.location(1).isValid());
+}
+
+TEST_CASE("Markers report their locations.", "[MarkerSetTests]") {
+  MarkerSet markers;
+  std::uint32_t a = markers.create(Location(5, 1));
+  std::uint32_t b = markers.create(Location(2, 0));
+
+  REQUIRE(markers.count() == 2);
+  REQUIRE(markers.location(a) == Location(5, 1));
+  REQUIRE(markers.location(b) == Location(2, 0));
+}
+
+TEST_CASE("Markers can be removed.", "[MarkerSetTests]") {
+  MarkerSet markers;
+  std::uint32_t a = markers.create(Location(5, 1));
+  std::uint32_t b = markers.create(Location(2, 0));
+  markers.remove(a);
+
+  REQUIRE(markers.count() == 1);
+  REQUIRE_FALSE(markers.location(a).isValid());
+  REQUIRE(markers.location(b) == Location(2, 0));
+}
+
+TEST_CASE("Markers move with insertions.", "[MarkerSetTests]") {
+  MarkerSet markers;
+  std::uint32_t before = markers.create(Location(1, 0));
+  std::uint32_t at = markers.create(Location(3, 0));
+  std::uint32_t after = markers.create(Location(6, 0));
+  std::uint32_t below = markers.create(Location(6, 1));
+
+  // Insert "x\ny" at (3, 0).
+  markers.replace(Location(3, 0), Location(3, 0), Location(1, 1));
+
+  REQUIRE(markers.location(before) == Location(1, 0));
+  REQUIRE(markers.location(at) == Location(1, 1));
+  REQUIRE(markers.location(after) == Location(4, 1));
+  REQUIRE(markers.location(below) == Location(6, 2));
+}
+
+TEST_CASE("Markers move with erasures.", "[MarkerSetTests]") {
+  MarkerSet markers;
+  std::uint32_t before = markers.create(Location(1, 0));
+  std::uint32_t within = markers.create(Location(0, 1));
+  std::uint32_t after = markers.create(Location(6, 2));
+  std::uint32_t below = markers.create(Location(6, 3));
+
+  // Erase from (3, 0) up to (but not including) (4, 2).
+  markers.replace(Location(3, 0), Location(4, 2), Location(3, 0));
+
+  REQUIRE(markers.location(before) == Location(1, 0));
+  REQUIRE(markers.location(within) == Location(3, 0));
+  REQUIRE(markers.location(after) == Location(5, 0));
+  REQUIRE(markers.location(below) == Location(6, 1));
+}
+
+TEST_CASE("Markers agree with individually adjusted locations.", "[MarkerSetTests]") {
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<std::uint64_t> coordinates(0, 12);
+
+  MarkerSet markers;
+  std::vector<std::uint32_t> tokens;
+  std::vector<Location> expected;
+  for (std::size_t index = 0; index < 200; ++index) {
+    Location location(coordinates(generator), coordinates(generator));
+    tokens.emplace_back(markers.create(location));
+    expected.emplace_back(location);
+  }
+
+  for (std::size_t edit = 0; edit < 200; ++edit) {
+    Location start(coordinates(generator), coordinates(generator));
+    Location end(coordinates(generator), coordinates(generator));
+    if (end < start) {
+      std::swap(start, end);
+    }
+
+    // Alternate between erasing and inserting.
+    Location oldEnd = edit % 2 == 0 ? end : start;
+    Location newEnd = edit % 2 == 0 ? start : end;
+    markers.replace(start, oldEnd, newEnd);
+    for (Location& location : expected) {
+      if (location < start) {
+        continue;
+      } else if (location < oldEnd) {
+        location = start;
+      } else if (location.row() == oldEnd.row()) {
+        location = Location(location.column() - oldEnd.column() + newEnd.column(), newEnd.row());
+      } else {
+        location = Location(location.column(), location.row() - oldEnd.row() + newEnd.row());
+      }
+    }
+
+    if (edit % 10 == 0) {
+      markers.remove(tokens[edit]);
+      tokens[edit] = markers.create(expected[edit]);
+    }
+  }
+
+  for (std::size_t index = 0; index < tokens.size(); ++index) {
+    REQUIRE(markers.location(tokens[index]) == expected[index]);
+  }
+}
+
+TEST_CASE("Document markers survive insertions.", "[MarkerSetTests]") {
+  Document document("Hello, world.\nGoodbye.\n");
+  std::uint32_t marker = document.createMarker(Location(0, 1));
+  document.insert(Selection(Location(0, 0)), "One\nTwo\n");
+  document.insert(SelectionSet(std::vector<Selection>({ Selection(Location(0, 3)), Selection(Location(4, 3)) })), "!");
+
+  REQUIRE(document.row(3) == "!Good!bye.\n");
+  REQUIRE(document.markerLocation(marker) == Location(1, 3));
+}
+
+TEST_CASE("Document markers survive erasures.", "[MarkerSetTests]") {
+  Document document("Hello, world.\nGoodbye.\n");
+  std::uint32_t marker = document.createMarker(Location(4, 1));
+  std::uint32_t erased = document.createMarker(Location(2, 0));
+  document.erase(Selection(Location(0, 0), Location(13, 0)));
+
+  REQUIRE(document.markerLocation(marker) == Location(4, 0));
+  REQUIRE(document.markerLocation(erased) == Location(0, 0));
+}
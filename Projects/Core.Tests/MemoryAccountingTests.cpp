@@ -0,0 +1,178 @@
+#include "catch.hpp"
+
+#include "Color.hpp"
+#include "CursorFlags.hpp"
+#include "CursorStyle.hpp"
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Key.hpp"
+#include "Location.hpp"
+#include "MemoryAccounting.hpp"
+#include "Modifiers.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionDrawInfo.hpp"
+#include "SelectionSet.hpp"
+#include "TestServices.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+TEST_CASE("Allocations are accounted to the innermost memory scope.", "[MemoryAccountingTests]") {
+  // Assertions allocate, so the counts are taken before any are made.
+  AllocationCounter document(MemoryCategory::Document);
+  AllocationCounter selections(MemoryCategory::Selections);
+  MemoryCategory outerCategory;
+  MemoryCategory innerCategory;
+  std::unique_ptr<std::vector<int>> outer;
+  std::unique_ptr<std::vector<int>> inner;
+  {
+    MemoryScope documentScope(MemoryCategory::Document);
+    outer.reset(new std::vector<int>(64));
+    {
+      MemoryScope selectionsScope(MemoryCategory::Selections);
+      innerCategory = MemoryAccounting::currentCategory();
+      inner.reset(new std::vector<int>(32));
+    }
+
+    outerCategory = MemoryAccounting::currentCategory();
+  }
+
+  std::uint64_t documentAllocations = document.allocations();
+  std::uint64_t documentBytes = document.bytes();
+  std::uint64_t selectionsAllocations = selections.allocations();
+  std::uint64_t selectionsBytes = selections.bytes();
+
+  REQUIRE(outerCategory == MemoryCategory::Document);
+  REQUIRE(innerCategory == MemoryCategory::Selections);
+  REQUIRE(MemoryAccounting::currentCategory() == MemoryCategory::Other);
+  REQUIRE(documentAllocations == 2);
+  REQUIRE(documentBytes == sizeof(std::vector<int>) + 64 * sizeof(int));
+  REQUIRE(selectionsAllocations == 2);
+  REQUIRE(selectionsBytes == sizeof(std::vector<int>) + 32 * sizeof(int));
+}
+
+TEST_CASE("Allocation counters can be reset.", "[MemoryAccountingTests]") {
+  AllocationCounter counter;
+  std::unique_ptr<int> value(new int(1));
+  std::uint64_t allocations = counter.allocations();
+  std::uint64_t bytes = counter.bytes();
+  REQUIRE(allocations == 1);
+  REQUIRE(bytes == sizeof(int));
+
+  counter.reset();
+  allocations = counter.allocations();
+  REQUIRE(allocations == 0);
+}
+
+TEST_CASE("Memory usage of a string excludes inline storage.", "[MemoryAccountingTests]") {
+  std::string shortText("a");
+  REQUIRE(memoryUsage(shortText) <= shortText.capacity() + 1);
+
+  std::string longText(1000, 'a');
+  REQUIRE(memoryUsage(longText) == longText.capacity() + 1);
+
+  std::vector<std::string> rows(4, longText);
+  REQUIRE(memoryUsage(rows) >= rows.capacity() * sizeof(std::string) + 4 * 1001);
+}
+
+TEST_CASE("Document edits are accounted to the document.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  MemoryReport before = fixture.context.memoryReport();
+
+  AllocationCounter counter(MemoryCategory::Document);
+  fixture.document->insert(Selection(Location(0, 1)), std::string(1000, 'x'));
+  REQUIRE(counter.allocations() > 0);
+
+  MemoryReport after = fixture.context.memoryReport();
+  REQUIRE(after[MemoryCategory::Document].liveBytes >= before[MemoryCategory::Document].liveBytes + 1000);
+  REQUIRE(after[MemoryCategory::Document].allocated.allocations > before[MemoryCategory::Document].allocated.allocations);
+}
+
+TEST_CASE("The undo history is accounted separately from the document.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  MemoryReport before = fixture.context.memoryReport();
+  REQUIRE(before[MemoryCategory::UndoHistory].liveBytes == 0);
+
+  AllocationCounter counter(MemoryCategory::UndoHistory);
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  for (int index = 0; index < 10; ++index) {
+    fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  }
+
+  REQUIRE(counter.allocations() > 0);
+
+  MemoryReport after = fixture.context.memoryReport();
+  REQUIRE(after[MemoryCategory::UndoHistory].liveBytes > 0);
+  REQUIRE(after.liveBytes() > before.liveBytes());
+}
+
+TEST_CASE("Overlays are accounted in the memory report.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  REQUIRE(fixture.context.memoryReport()[MemoryCategory::Overlays].liveBytes == 0);
+
+  std::vector<Selection> selections;
+  for (std::uint64_t row = 0; row < 2; ++row) {
+    selections.push_back(Selection(Location(0, row), Location(2, row)));
+  }
+
+  SelectionDrawInfo overlay { Color::white(), Color::white(), CursorStyle::VerticalBlock, CursorFlags::None, SelectionSet(selections) };
+  AllocationCounter counter(MemoryCategory::Overlays);
+  fixture.context.setOverlay("highlights", overlay);
+  REQUIRE(counter.allocations() > 0);
+  REQUIRE(fixture.context.memoryReport()[MemoryCategory::Overlays].liveBytes >= 2 * sizeof(Selection));
+
+  fixture.context.clearOverlay("highlights");
+  REQUIRE(fixture.context.memoryReport()[MemoryCategory::Overlays].liveBytes == 0);
+}
+
+TEST_CASE("The script heap is accounted to scripting.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  std::uint64_t before = fixture.context.memoryReport()[MemoryCategory::Scripting].liveBytes;
+  REQUIRE(before > 0);
+
+  AllocationCounter counter(MemoryCategory::Scripting);
+  REQUIRE(fixture.scriptHost.execute("local values = {} for index = 1, 10000 do values[index] = tostring(index) end held = values"));
+  REQUIRE(counter.allocations() > 0);
+  REQUIRE(fixture.context.memoryReport()[MemoryCategory::Scripting].liveBytes > before);
+}
+
+TEST_CASE("Typing a character stays within its allocation budget.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+
+  AllocationCounter counter;
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+  std::uint64_t allocations = counter.allocations();
+
+  // The insertion, its transaction, the cursor selections and the undo history entry.
+  REQUIRE(allocations <= 12);
+}
+
+TEST_CASE("Backspace reads the selections without copying them.", "[MemoryAccountingTests]") {
+  EditContextFixture fixture("one two\nthree four\n");
+  std::string text;
+  std::vector<Selection> cursors;
+  for (std::uint64_t row = 0; row < 1000; ++row) {
+    text += "one two\n";
+    cursors.emplace_back(Location(4, row));
+  }
+
+  fixture.document->insert(Selection(Location(0, 0)), text);
+  fixture.context.selections().replace(SelectionSet(cursors));
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::X, Modifiers(), "x");
+
+  // Copies of the selections, such as those held by transactions, share their storage.
+  SelectionSet shared = fixture.context.selections();
+  AllocationCounter counter(MemoryCategory::Selections);
+  fixture.context.processKeyEvent(Key::Delete, Modifiers(), "");
+  std::uint64_t bytes = counter.bytes();
+
+  REQUIRE(bytes < cursors.size() * sizeof(Selection));
+}
@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Location.hpp"
+#include "Mode.hpp"
+#include "Modifiers.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "TestServices.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  Modifiers shift() {
+    Modifiers result;
+    result.shift = true;
+    return result;
+  }
+}
+
+TEST_CASE("Modes dispatch single key mappings.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 1)));
+  REQUIRE(fixture.popupService.popups == 0);
+}
+
+TEST_CASE("Modes dispatch mappings with modifiers.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::J, shift(), "J");
+  fixture.context.processKeyEvent(Key::J, shift(), "J");
+
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 0), Location(0, 2)));
+  REQUIRE(fixture.popupService.popups == 0);
+}
+
+TEST_CASE("Modes dispatch multiple key mappings.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+  fixture.context.processKeyEvent(Key::P, Modifiers(), "p");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 2)));
+
+  fixture.context.processKeyEvent(Key::L, Modifiers(), "l");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 1), Location(3, 1)));
+  REQUIRE(fixture.popupService.popups == 0);
+}
+
+TEST_CASE("Modes repeat mappings preceded by a count.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::Key3, Modifiers(), "3");
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 3)));
+
+  fixture.context.processKeyEvent(Key::K, Modifiers(), "k");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 2)));
+}
+
+TEST_CASE("Modes report unmapped keys and start a new sequence.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::P, Modifiers(), "p");
+  fixture.context.processKeyEvent(Key::Q, Modifiers(), "q");
+  REQUIRE(fixture.popupService.popups == 1);
+
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 1)));
+  REQUIRE(fixture.popupService.popups == 1);
+}
+
+TEST_CASE("Modes pass counts to commands that take them.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  int reveals = 0;
+  fixture.context.controller().scrollLocationIntoView.connect([&](Location) { ++reveals; });
+
+  fixture.context.processKeyEvent(Key::Key5, Modifiers(), "5");
+  fixture.context.processKeyEvent(Key::Key0, Modifiers(), "0");
+  fixture.context.processKeyEvent(Key::Key0, Modifiers(), "0");
+  fixture.context.processKeyEvent(Key::Key0, Modifiers(), "0");
+  fixture.context.processKeyEvent(Key::J, Modifiers(), "j");
+
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 4)));
+  REQUIRE(reveals == 1);
+}
+
+TEST_CASE("Modes scroll once for repeated commands.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  std::vector<Location> scrolls;
+  fixture.context.controller().scrollToLocation.connect([&](Location location) { scrolls.push_back(location); });
+
+  fixture.context.processKeyEvent(Key::Key5, Modifiers(), "5");
+  fixture.context.processKeyEvent(Key::L, Modifiers(), "l");
+
+  REQUIRE(scrolls.size() == 1);
+  REQUIRE(scrolls.back() == fixture.context.selections().primary().extent());
+}
+
+TEST_CASE("Modes pass counts to selection commands.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::Key2, Modifiers(), "2");
+  fixture.context.processKeyEvent(Key::J, shift(), "J");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 0), Location(0, 2)));
+
+  fixture.context.processKeyEvent(Key::Key9, Modifiers(), "9");
+  fixture.context.processKeyEvent(Key::J, shift(), "J");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 0), Location(0, 4)));
+
+  fixture.context.processKeyEvent(Key::Key3, Modifiers(), "3");
+  fixture.context.processKeyEvent(Key::L, shift(), "L");
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 0), Location(3, 4)));
+}
+
+TEST_CASE("Search mode can search within the selections.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.selections().replace(SelectionSet(std::vector<Selection> { Selection(Location(0, 1), Location(3, 2)), Selection(Location(0, 4), Location(4, 4)) }));
+  fixture.context.processKeyEvent(Key::Slash, shift(), "?");
+  REQUIRE(fixture.context.mode().status() == "s[]/");
+
+  fixture.context.processKeyEvent(Key::O, Modifiers(), "o");
+  REQUIRE(fixture.context.overlays().at("Search").selections.count() == 3);
+
+  fixture.context.processKeyEvent(Key::Return, Modifiers(), "");
+  REQUIRE(fixture.context.selections().count() == 3);
+  REQUIRE(fixture.context.selections()[0] == Selection(Location(0, 1)));
+  REQUIRE(fixture.context.selections()[1] == Selection(Location(2, 2)));
+  REQUIRE(fixture.context.selections()[2] == Selection(Location(1, 4)));
+}
+
+TEST_CASE("Search mode keeps the selections when nothing matches.", "[ModeTests]") {
+  EditContextFixture fixture("zero\none\ntwo\nthree\nfour\n");
+  fixture.context.processKeyEvent(Key::Slash, Modifiers(), "/");
+  REQUIRE(fixture.context.mode().status() == "s/");
+
+  fixture.context.processKeyEvent(Key::Q, Modifiers(), "q");
+  fixture.context.processKeyEvent(Key::Return, Modifiers(), "");
+  REQUIRE(fixture.context.selections().count() == 1);
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(0, 0)));
+}
@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Location.hpp"
+#include "ScriptHost.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "TestServices.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace quip;
+
+TEST_CASE("Edit contexts bind themselves and their documents.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("quip.context:insert(tostring(quip.document.rows))"));
+  
+  REQUIRE(fixture.document->row(0) == "3one two\n");
+  REQUIRE(fixture.context.canUndo());
+}
+
+TEST_CASE("Text views read document rows.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute(
+    "local view = quip.document:view(1) "
+    "local first, last = view:find('four') "
+    "local word = view:sub(first, last) "
+    "local column, row = word:location() "
+    "quip.context:insert(table.concat({ #view, first, last, tostring(word), word:byte(1), column, row }, ','))"
+  ));
+  
+  REQUIRE(fixture.document->row(0) == "11,7,10,four,102,6,1one two\n");
+}
+
+TEST_CASE("Text views of chunks are clamped to their row.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("quip.context:insert(tostring(quip.document:chunk(4, 0, 100)))"));
+  REQUIRE(fixture.document->contents() == "two\none two\nthree four\nfive\n");
+}
+
+TEST_CASE("Text views become stale when the document changes.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("view = quip.document:view(0)"));
+  fixture.document->insert(Selection(Location(0, 0)), "x");
+  
+  REQUIRE_FALSE(fixture.scriptHost.execute("return #view"));
+}
+
+TEST_CASE("Text views held by scripts outlive their document.", "[ScriptHostTests]") {
+  ScriptHost scriptHost(QUIP_RUNTIME_PATH);
+  CountingPopupService popupService;
+  NullStatusService statusService;
+  {
+    EditContext context(&popupService, &statusService, &scriptHost, std::make_shared<Document>("one\n"));
+    REQUIRE(scriptHost.execute("held = quip.document:view(0)"));
+  }
+  
+  REQUIRE(scriptHost.execute(
+    "local isConverted, message = pcall(tostring, held) "
+    "assert(not isConverted and message:find('no longer exists'))"
+  ));
+  REQUIRE(scriptHost.execute("held = nil collectgarbage()"));
+}
+
+TEST_CASE("Selections assigned from Lua are clamped to the document.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("quip.context.selections = { 0, 999, 0, 999 } quip.context:insert('x')"));
+  REQUIRE(fixture.document->contents() == "one two\nthree four\nxfive\n");
+  
+  REQUIRE(fixture.scriptHost.execute("quip.context.selections = { 99, 1, 2, 0 }"));
+  REQUIRE(fixture.context.selections().count() == 1);
+  REQUIRE(fixture.context.selections().primary() == Selection(Location(2, 0), Location(10, 1)));
+}
+
+TEST_CASE("Text copied from Lua is clamped to the document.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute(
+    "local text = quip.document:text(3, 2, 999, 999) "
+    "assert(text == 'e\\n', text) "
+    "assert(quip.document:text(999, 0, 0, 0) == 'one two\\n')"
+  ));
+}
+
+TEST_CASE("Selections can be transformed in bulk from Lua.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  fixture.context.selections().replace(SelectionSet(std::vector<Selection>({ Selection(0, 0, 2, 0), Selection(4, 0, 6, 0), Selection(0, 2, 3, 2) })));
+  REQUIRE(fixture.scriptHost.execute(
+    "local context, document = quip.context, quip.document "
+    "local selections = context.selections "
+    "local text = {} "
+    "for index = 1, #selections, 4 do "
+    "  text[#text + 1] = document:text(selections[index], selections[index + 1], selections[index + 2], selections[index + 3]):upper() "
+    "end "
+    "context:erase() "
+    "assert(context:insertEach(text)) "
+    "assert(not context:insertEach({ 'too', 'many', 'strings', 'here' }))"
+  ));
+  
+  REQUIRE(fixture.document->contents() == "ONE TWO\nthree four\nFIVE\n");
+}
+
+TEST_CASE("Selections can be assigned from Lua.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("quip.context.selections = { 0, 1, 4, 1, 0, 2, 1, 2, primary = 2 }"));
+  
+  REQUIRE(fixture.context.selections().count() == 2);
+  REQUIRE(fixture.context.selections().primary() == Selection(0, 2, 1, 2));
+}
+
+TEST_CASE("Destroyed objects are unbound.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  REQUIRE(fixture.scriptHost.execute("context = quip.context"));
+  {
+    EditContext other(&fixture.popupService, &fixture.statusService, &fixture.scriptHost, std::make_shared<Document>("other\n"));
+    REQUIRE(fixture.scriptHost.execute("assert(quip.document.rows == 1 and quip.context ~= context)"));
+  }
+  
+  REQUIRE(fixture.scriptHost.execute("assert(quip.context == nil and quip.document == nil)"));
+  REQUIRE_FALSE(fixture.scriptHost.execute("context:undo()"));
+  
+  fixture.context.activate();
+  REQUIRE(fixture.scriptHost.execute("assert(quip.document.rows == 3)"));
+}
+
+TEST_CASE("Syntax scripts are loaded on first use.", "[ScriptHostTests]") {
+  EditContextFixture fixture("one two\nthree four\nfive\n");
+  const FileType* fileType = fixture.context.fileTypeDatabase().lookupByExtension("txt");
+  REQUIRE_FALSE(fixture.scriptHost.isLoaded(fileType->syntax));
+  
+  fixture.scriptHost.parseSyntax(fileType->syntax, "plain text\n");
+  REQUIRE(fixture.scriptHost.isLoaded(fileType->syntax));
+}
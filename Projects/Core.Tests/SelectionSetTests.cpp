@@ -1,7 +1,13 @@
 #include "catch.hpp"
 
+#include "Document.hpp"
+#include "SearchExpression.hpp"
 #include "SelectionSet.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 using namespace quip;
 
 TEST_CASE("Selection sets can be default-constructed.", "[SelectionSetTests]") {
@@ -102,3 +108,153 @@ TEST_CASE("Selection sets collapse pairs of overlapping selections.", "[Selectio
   REQUIRE(cursor->origin() == Location(0, 5));
   REQUIRE(cursor->extent() == Location(0, 10));
 }
+
+TEST_CASE("Selection sets collapse nested selections.", "[SelectionSetTests]") {
+  Selection a(Location(1, 0), Location(0, 5));
+  Selection b(Location(5, 0), Location(15, 0));
+  Selection c(Location(0, 3), Location(5, 3));
+  std::vector<Selection> selections { c, b, a };
+  
+  SelectionSet set(selections);
+  REQUIRE(set.count() == 1);
+  
+  SelectionSetIterator cursor = set.begin();
+  REQUIRE(cursor->origin() == Location(1, 0));
+  REQUIRE(cursor->extent() == Location(0, 5));
+}
+
+TEST_CASE("Selection set copies are independent.", "[SelectionSetTests]") {
+  Selection a(Location(0, 0), Location(1, 0));
+  Selection b(Location(0, 1), Location(1, 1));
+  Selection c(Location(0, 2), Location(1, 2));
+  SelectionSet set(std::vector<Selection> { a, b });
+  SelectionSet copy(set);
+  
+  copy[1] = c;
+  REQUIRE(set[1] == b);
+  REQUIRE(copy[1] == c);
+  
+  set.replace(c);
+  REQUIRE(set.count() == 1);
+  REQUIRE(copy.count() == 2);
+  REQUIRE(copy[0] == a);
+}
+
+TEST_CASE("Selection set copies share storage until mutated.", "[SelectionSetTests]") {
+  SelectionSet set(std::vector<Selection> { Selection(Location(0, 0), Location(1, 0)), Selection(Location(0, 1), Location(1, 1)) });
+  SelectionSet copy(set);
+  SelectionSet replaced;
+  replaced.replace(set);
+  
+  const SelectionSet& constantSet = set;
+  const SelectionSet& constantCopy = copy;
+  REQUIRE(&constantSet[0] == &constantCopy[0]);
+  REQUIRE(&constantSet[0] == &static_cast<const SelectionSet&>(replaced)[0]);
+  
+  copy.rotateForward();
+  REQUIRE(&constantSet[0] == &constantCopy[0]);
+  
+  copy[0] = Selection(Location(0, 3), Location(1, 3));
+  REQUIRE(&constantSet[0] != &constantCopy[0]);
+  REQUIRE(copy.primary() == set[1]);
+}
+
+TEST_CASE("Large selection sets are sorted and collapsed.", "[SelectionSetTests]") {
+  // Enough selections to take the radix sort path, in a scrambled order with some overlapping.
+  std::vector<Selection> selections;
+  std::uint64_t state = 12345;
+  for (std::size_t index = 0; index < 5000; ++index) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::uint64_t row = (state >> 33) % 3000;
+    std::uint64_t column = (state >> 20) % 300;
+    selections.emplace_back(Location(column, row), Location(column + 2, row));
+  }
+  
+  std::vector<Selection> expected = selections;
+  std::sort(expected.begin(), expected.end(), [](const Selection& left, const Selection& right) {
+    return left.origin() < right.origin();
+  });
+  
+  SelectionSet set(selections);
+  REQUIRE(set.count() > 0);
+  REQUIRE(set.count() < selections.size());
+  REQUIRE(set[0].origin() == expected.front().origin());
+  for (std::size_t index = 1; index < set.count(); ++index) {
+    REQUIRE(set[index - 1].extent() < set[index].origin());
+  }
+  
+  // Every selection is covered by a collapsed selection; both are ordered by origin.
+  std::size_t covered = 0;
+  std::size_t cursor = 0;
+  for (const Selection& selection : expected) {
+    while (cursor < set.count() && set[cursor].extent() < selection.origin()) {
+      ++cursor;
+    }
+    
+    if (cursor < set.count() && set[cursor].origin() <= selection.origin() && selection.extent() <= set[cursor].extent()) {
+      ++covered;
+    }
+  }
+  
+  REQUIRE(covered == expected.size());
+}
+
+TEST_CASE("Selection sets can be united.", "[SelectionSetTests]") {
+  SelectionSet left(std::vector<Selection> { Selection(Location(0, 0), Location(2, 0)), Selection(Location(0, 2), Location(1, 2)) });
+  SelectionSet right(std::vector<Selection> { Selection(Location(2, 0), Location(4, 0)), Selection(Location(0, 1), Location(1, 1)) });
+  SelectionSet result = left.unionWith(right);
+  
+  REQUIRE(result.count() == 3);
+  REQUIRE(result[0] == Selection(Location(0, 0), Location(4, 0)));
+  REQUIRE(result[1] == Selection(Location(0, 1), Location(1, 1)));
+  REQUIRE(result[2] == Selection(Location(0, 2), Location(1, 2)));
+  REQUIRE(left.unionWith(SelectionSet()).count() == 2);
+}
+
+TEST_CASE("Selection sets can be intersected.", "[SelectionSetTests]") {
+  SelectionSet blocks(std::vector<Selection> { Selection(Location(0, 0), Location(9, 0)), Selection(Location(0, 2), Location(9, 3)) });
+  SelectionSet matches(std::vector<Selection> { Selection(Location(2, 0), Location(4, 0)), Selection(Location(2, 1), Location(4, 1)), Selection(Location(8, 3), Location(2, 4)) });
+  SelectionSet result = matches.intersectionWith(blocks);
+  
+  REQUIRE(result.count() == 2);
+  REQUIRE(result[0] == Selection(Location(2, 0), Location(4, 0)));
+  REQUIRE(result[1] == Selection(Location(8, 3), Location(9, 3)));
+  REQUIRE(matches.intersectionWith(SelectionSet()).count() == 0);
+}
+
+TEST_CASE("Selection sets can be subtracted.", "[SelectionSetTests]") {
+  Document document("abcdef\nghijkl\n");
+  SelectionSet everything(Selection(Location(0, 0), Location(6, 1)));
+  SelectionSet cuts(std::vector<Selection> { Selection(Location(2, 0), Location(3, 0)), Selection(Location(6, 0), Location(0, 1)), Selection(Location(6, 1)) });
+  SelectionSet result = everything.difference(cuts, document);
+  
+  REQUIRE(result.count() == 3);
+  REQUIRE(result[0] == Selection(Location(0, 0), Location(1, 0)));
+  REQUIRE(result[1] == Selection(Location(4, 0), Location(5, 0)));
+  REQUIRE(result[2] == Selection(Location(1, 1), Location(5, 1)));
+  REQUIRE(everything.difference(everything, document).count() == 0);
+}
+
+TEST_CASE("Selection sets can be complemented.", "[SelectionSetTests]") {
+  Document document("abc\ndef\n");
+  SelectionSet selections(Selection(Location(1, 0), Location(0, 1)));
+  SelectionSet result = selections.complement(document);
+  
+  REQUIRE(result.count() == 2);
+  REQUIRE(result[0] == Selection(Location(0, 0)));
+  REQUIRE(result[1] == Selection(Location(1, 1), Location(3, 1)));
+  REQUIRE(result.complement(document).count() == 1);
+  REQUIRE(result.complement(document)[0] == selections[0]);
+  REQUIRE(SelectionSet().complement(Document()).count() == 0);
+}
+
+TEST_CASE("Selection sets can be filtered by a search expression.", "[SelectionSetTests]") {
+  Document document("int a;\nfloat b;\nint c;\n");
+  SelectionSet rows(std::vector<Selection> { Selection(Location(0, 0), Location(5, 0)), Selection(Location(0, 1), Location(7, 1)), Selection(Location(0, 2), Location(5, 2)) });
+  SelectionSet result = rows.matching(SearchExpression("int"), document);
+  
+  REQUIRE(result.count() == 2);
+  REQUIRE(result[0].origin() == Location(0, 0));
+  REQUIRE(result[1].origin() == Location(0, 2));
+  REQUIRE(rows.matching(SearchExpression("("), document).count() == 0);
+}
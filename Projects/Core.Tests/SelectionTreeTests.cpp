@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "SelectionTree.hpp"
+
+#include <random>
+
+using namespace quip;
+
+TEST_CASE("Default-construct a selection tree.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+
+  REQUIRE(tree.isEmpty());
+  REQUIRE(tree.count() == 0);
+  REQUIRE(tree.intersectingRows(0, 100).empty());
+}
+
+TEST_CASE("Selection trees keep selections sorted.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  tree.add(Selection(Location(0, 2), Location(4, 2)));
+  tree.add(Selection(Location(0, 0), Location(4, 0)));
+  tree.add(Selection(Location(0, 1), Location(4, 1)));
+
+  REQUIRE(tree.count() == 3);
+  REQUIRE(tree[0] == Selection(Location(0, 0), Location(4, 0)));
+  REQUIRE(tree[1] == Selection(Location(0, 1), Location(4, 1)));
+  REQUIRE(tree[2] == Selection(Location(0, 2), Location(4, 2)));
+}
+
+TEST_CASE("Selection trees merge overlapping selections.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  tree.add(Selection(Location(0, 0), Location(2, 0)));
+  tree.add(Selection(Location(4, 0), Location(6, 0)));
+  tree.add(Selection(Location(8, 0), Location(10, 0)));
+  tree.add(Selection(Location(2, 0), Location(8, 0)));
+
+  REQUIRE(tree.count() == 1);
+  REQUIRE(tree[0] == Selection(Location(0, 0), Location(10, 0)));
+}
+
+TEST_CASE("Selection trees don't merge adjacent selections.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  tree.add(Selection(Location(0, 0), Location(2, 0)));
+  tree.add(Selection(Location(3, 0), Location(5, 0)));
+
+  REQUIRE(tree.count() == 2);
+}
+
+TEST_CASE("Remove selections from a selection tree.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  tree.add(Selection(Location(0, 0), Location(2, 0)));
+  tree.add(Selection(Location(4, 0), Location(6, 0)));
+
+  REQUIRE_FALSE(tree.remove(Selection(Location(4, 0), Location(5, 0))));
+  REQUIRE(tree.remove(Selection(Location(4, 0), Location(6, 0))));
+  REQUIRE(tree.count() == 1);
+  REQUIRE(tree[0] == Selection(Location(0, 0), Location(2, 0)));
+}
+
+TEST_CASE("Find the selection containing a location.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  tree.add(Selection(Location(2, 0), Location(3, 1)));
+
+  REQUIRE(*tree.containing(Location(10, 0)) == Selection(Location(2, 0), Location(3, 1)));
+  REQUIRE(*tree.containing(Location(3, 1)) == Selection(Location(2, 0), Location(3, 1)));
+  REQUIRE_FALSE(tree.containing(Location(1, 0)).has_value());
+  REQUIRE_FALSE(tree.containing(Location(4, 1)).has_value());
+}
+
+TEST_CASE("Find the selections intersecting a range of rows.", "[SelectionTreeTests]") {
+  SelectionTree tree;
+  for (std::uint64_t row = 0; row < 100; ++row) {
+    tree.add(Selection(Location(0, row), Location(1, row)));
+  }
+
+  tree.add(Selection(Location(5, 10), Location(0, 20)));
+  std::vector<Selection> results = tree.intersectingRows(15, 25);
+
+  REQUIRE(results.size() == 6);
+  REQUIRE(results[0] == Selection(Location(5, 10), Location(1, 20)));
+  REQUIRE(results[1] == Selection(Location(0, 21), Location(1, 21)));
+}
+
+TEST_CASE("Copies of selection trees are independent.", "[SelectionTreeTests]") {
+  SelectionTree tree(Selection(Location(0, 0), Location(2, 0)));
+  SelectionTree copy(tree);
+  copy.add(Selection(Location(4, 0), Location(6, 0)));
+
+  REQUIRE(tree.count() == 1);
+  REQUIRE(copy.count() == 2);
+}
+
+TEST_CASE("Selection trees agree with selection sets.", "[SelectionTreeTests]") {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::uint64_t> columns(0, 2000);
+  std::uniform_int_distribution<std::uint64_t> lengths(0, 20);
+
+  std::vector<Selection> selections;
+  SelectionTree tree;
+  for (std::size_t index = 0; index < 500; ++index) {
+    std::uint64_t column = columns(generator);
+    Selection selection(Location(column, 0), Location(column + lengths(generator), 0));
+    selections.emplace_back(selection);
+    tree.add(selection);
+  }
+
+  SelectionSet expected(selections);
+  SelectionSet actual = tree.toSelectionSet();
+
+  REQUIRE(actual.count() == expected.count());
+  for (std::size_t index = 0; index < expected.count(); ++index) {
+    REQUIRE(actual[index] == expected[index]);
+    REQUIRE(tree[index] == expected[index]);
+  }
+
+  REQUIRE(SelectionTree(expected).count() == expected.count());
+}
+
+TEST_CASE("Selection trees built from selection sets can be queried and modified.", "[SelectionTreeTests]") {
+  std::vector<Selection> selections;
+  for (std::uint64_t row = 0; row < 1000; ++row) {
+    selections.emplace_back(Location(0, row), Location(4, row));
+  }
+
+  SelectionSet set(selections);
+  SelectionTree tree(set);
+  REQUIRE(tree.count() == set.count());
+  for (std::size_t index = 0; index < set.count(); ++index) {
+    REQUIRE(tree[index] == set[index]);
+  }
+
+  REQUIRE(*tree.containing(Location(2, 500)) == Selection(Location(0, 500), Location(4, 500)));
+  REQUIRE(tree.intersectingRows(10, 12).size() == 3);
+
+  tree.add(Selection(Location(3, 10), Location(1, 12)));
+  REQUIRE(tree.count() == set.count() - 2);
+  REQUIRE(*tree.containing(Location(0, 11)) == Selection(Location(0, 10), Location(4, 12)));
+  REQUIRE(tree.remove(Selection(Location(0, 999), Location(4, 999))));
+  REQUIRE(tree.count() == set.count() - 3);
+}
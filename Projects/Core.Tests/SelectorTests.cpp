@@ -3,6 +3,7 @@
 #include "Document.hpp"
 #include "Location.hpp"
 #include "Selection.hpp"
+#include "SelectionSet.hpp"
 #include "Selector.hpp"
 
 using namespace quip;
@@ -109,3 +110,93 @@ TEST_CASE("Select prior word with a full-words basis.", "Selector") {
   REQUIRE(document.contents(*result) == " is");
 }
 
+TEST_CASE("Select word with a count.", "Selector") {
+  Document document("This is a test.");
+  Optional<Selection> result = selectThisOrNextWord(document, Selection(1, 0, 2, 0), 3);
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "a ");
+}
+
+TEST_CASE("Select word with a count past the end of the document.", "Selector") {
+  Document document("This is a test.");
+  Optional<Selection> result = selectThisOrNextWord(document, Selection(1, 0, 2, 0), 500);
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == ".");
+}
+
+TEST_CASE("Select prior word with a count.", "Selector") {
+  Document document("This is not a test.");
+  Optional<Selection> result = selectPriorWord(document, Selection(14, 0, 16, 0), 3);
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == " not");
+}
+
+TEST_CASE("Select prior word with a count past the beginning of the document.", "Selector") {
+  Document document("This is not a test.");
+  Optional<Selection> result = selectPriorWord(document, Selection(14, 0, 16, 0), 500);
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "This");
+}
+
+TEST_CASE("Select word with a count after an edit.", "Selector") {
+  Document document("This is a test.");
+  selectThisOrNextWord(document, Selection(0, 0), 2);
+  document.insert(Selection(5, 0), "not ");
+  Optional<Selection> result = selectThisOrNextWord(document, Selection(0, 0), 3);
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "is ");
+}
+
+TEST_CASE("Select word with a count matches repeated selection.", "Selector") {
+  Document document("int main() {\n  return x+y; // sum\n\n  \tdone();\n}\n");
+  for (std::uint64_t row = 0; row < document.rows(); ++row) {
+    for (std::uint64_t column = 0; column < document.row(row).size(); ++column) {
+      Optional<Selection> forward(Selection(column, row));
+      Optional<Selection> backward(Selection(column, row));
+      for (std::size_t count = 1; count < 24; ++count) {
+        forward = selectThisOrNextWord(document, *forward);
+        backward = selectPriorWord(document, *backward);
+        
+        REQUIRE(*selectThisOrNextWord(document, Selection(column, row), count) == *forward);
+        REQUIRE(*selectPriorWord(document, Selection(column, row), count) == *backward);
+      }
+    }
+  }
+}
+
+
+TEST_CASE("Select blocks on an empty document.", "Selector") {
+  Document document;
+  Optional<Selection> result = selectBlocks(document, Selection(0, 0));
+  
+  REQUIRE(!result.has_value());
+}
+
+TEST_CASE("Select blocks with a basis inside a block.", "Selector") {
+  Document document("f(x) { return [a, b]; }");
+  Optional<Selection> result = selectBlocks(document, Selection(16, 0));
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "[a, b]");
+}
+
+TEST_CASE("Select blocks with a full-block basis.", "Selector") {
+  Document document("f(x) { return [a, b]; }");
+  Optional<Selection> result = selectBlocks(document, Selection(14, 0, 19, 0));
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "{ return [a, b]; }");
+}
+
+TEST_CASE("Select blocks with no enclosing block.", "Selector") {
+  Document document("{ a }\nb\n");
+  Optional<Selection> result = selectBlocks(document, Selection(0, 1));
+  
+  REQUIRE(result.has_value());
+  REQUIRE(document.contents(*result) == "{ a }\nb\n");
+}
@@ -2,6 +2,10 @@
 
 #include "Signal.hpp"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace quip;
 
 TEST_CASE("Signals can connect and trigger a single listener.", "[SignalTests]") {
@@ -93,3 +97,118 @@ TEST_CASE("Signals can disconnect the only listener.", "[SignalTests]") {
   REQUIRE(success);
 }
 
+
+TEST_CASE("Signals return the result of the last connected listener.", "[SignalTests]") {
+  Signal<int ()> signal;
+  REQUIRE(signal.transmit() == 0);
+  
+  signal.connect([] { return 1; });
+  std::uint32_t token = signal.connect([] { return 2; });
+  REQUIRE(signal.transmit() == 2);
+  
+  signal.disconnect(token);
+  REQUIRE(signal.transmit() == 1);
+}
+
+TEST_CASE("Signals can connect a listener while transmitting.", "[SignalTests]") {
+  Signal<void ()> signal;
+  int connectedCalls = 0;
+  signal.connect([&] {
+    signal.connect([&] { ++connectedCalls; });
+  });
+  
+  // Listeners connected during a transmission are not called until the next one.
+  signal.transmit();
+  REQUIRE(connectedCalls == 0);
+  
+  signal.transmit();
+  REQUIRE(connectedCalls == 1);
+}
+
+TEST_CASE("Signals can disconnect a listener while transmitting.", "[SignalTests]") {
+  Signal<void ()> signal;
+  std::uint32_t firstToken = 0;
+  std::uint32_t secondToken = 0;
+  int firstCalls = 0;
+  int secondCalls = 0;
+  firstToken = signal.connect([&] {
+    ++firstCalls;
+    signal.disconnect(firstToken);
+    signal.disconnect(secondToken);
+  });
+  secondToken = signal.connect([&] { ++secondCalls; });
+  
+  signal.transmit();
+  signal.transmit();
+  REQUIRE(firstCalls == 1);
+  REQUIRE(secondCalls == 0);
+}
+
+TEST_CASE("Signals can disconnect many listeners.", "[SignalTests]") {
+  Signal<void ()> signal;
+  std::vector<std::uint32_t> tokens;
+  int calls = 0;
+  for (int index = 0; index < 100; ++index) {
+    tokens.push_back(signal.connect([&] { ++calls; }));
+  }
+  
+  for (std::size_t index = 0; index < tokens.size(); index += 3) {
+    signal.disconnect(tokens[index]);
+    signal.disconnect(tokens[index]);
+  }
+  
+  signal.transmit();
+  REQUIRE(calls == 66);
+}
+
+TEST_CASE("Signals can connect and disconnect listeners from another thread.", "[SignalTests]") {
+  Signal<void ()> signal;
+  std::atomic<int> calls(0);
+  signal.connect([&] { ++calls; });
+  
+  std::thread thread([&] {
+    for (int index = 0; index < 1000; ++index) {
+      signal.disconnect(signal.connect([&] { ++calls; }));
+    }
+  });
+  
+  for (int index = 0; index < 1000; ++index) {
+    signal.transmit();
+  }
+  
+  thread.join();
+  REQUIRE(calls >= 1000);
+}
+
+TEST_CASE("Signals suppress transmissions while blocked.", "[SignalTests]") {
+  Signal<int ()> signal;
+  int calls = 0;
+  signal.connect([&] { return ++calls; });
+  
+  signal.block();
+  REQUIRE(signal.transmit() == 0);
+  REQUIRE(signal.transmit() == 0);
+  REQUIRE(calls == 0);
+  REQUIRE(signal.unblock() == 2);
+  
+  REQUIRE(signal.transmit() == 1);
+  signal.block();
+  REQUIRE(signal.unblock() == 0);
+}
+
+TEST_CASE("Signals report suppressed transmissions when the outermost block ends.", "[SignalTests]") {
+  Signal<int ()> signal;
+  int calls = 0;
+  signal.connect([&] { return ++calls; });
+  
+  signal.block();
+  signal.transmit();
+  signal.block();
+  signal.transmit();
+  REQUIRE(signal.unblock() == 0);
+  
+  REQUIRE(signal.transmit() == 0);
+  REQUIRE(calls == 0);
+  REQUIRE(signal.unblock() == 3);
+  REQUIRE(signal.transmit() == 1);
+}
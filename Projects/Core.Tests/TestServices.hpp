@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Location.hpp"
+#include "PopupService.hpp"
+#include "ScriptHost.hpp"
+#include "StatusService.hpp"
+
+#include <memory>
+#include <string>
+
+namespace quip {
+  // A popup service that only counts the popups created.
+  struct CountingPopupService : PopupService {
+    int popups = 0;
+
+    void tick(double elapsedSeconds) override {
+    }
+
+    PopupHandle createPopupAtLocation(const Location& location, const std::string& text) override {
+      return ++popups;
+    }
+
+    void destroyPopup(PopupHandle popup) override {
+    }
+  };
+
+  // A status service that ignores status updates.
+  struct NullStatusService : StatusService {
+    void setStatus(const std::string& text) override {
+    }
+
+    void setFileType(const std::string& fileType) override {
+    }
+
+    void setLineCount(const std::size_t count) override {
+    }
+  };
+
+  // An edit context over a document with the given contents, bound to its own script host.
+  struct EditContextFixture {
+    ScriptHost scriptHost;
+    CountingPopupService popupService;
+    NullStatusService statusService;
+    std::shared_ptr<Document> document;
+    EditContext context;
+
+    explicit EditContextFixture(const std::string& contents)
+    : scriptHost(QUIP_RUNTIME_PATH)
+    , document(std::make_shared<Document>(contents))
+    , context(&popupService, &statusService, &scriptHost, document) {
+    }
+  };
+}
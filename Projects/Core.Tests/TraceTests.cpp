@@ -0,0 +1,189 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "EditContext.hpp"
+#include "Key.hpp"
+#include "Location.hpp"
+#include "Modifiers.hpp"
+#include "ScriptHost.hpp"
+#include "SearchExpression.hpp"
+#include "Selection.hpp"
+#include "TestServices.hpp"
+#include "Trace.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace quip;
+
+namespace {
+  std::size_t countSpans(const std::vector<TraceEvent>& events, const std::string& name) {
+    std::size_t result = 0;
+    for (const TraceEvent& event : events) {
+      if (name == event.name) {
+        ++result;
+      }
+    }
+
+    return result;
+  }
+}
+
+TEST_CASE("Traces record nothing unless capturing.", "[TraceTests]") {
+  Trace::shared().start();
+  Trace::shared().stop();
+
+  Document document("text\n");
+  document.insert(Selection(Location(0, 0)), "more ");
+
+  REQUIRE_FALSE(Trace::isCapturing());
+  REQUIRE(Trace::shared().events().empty());
+}
+
+TEST_CASE("Traces record spans in instrumented functions.", "[TraceTests]") {
+  EditContextFixture fixture("text\n");
+
+  Trace::shared().start();
+  fixture.context.processKeyEvent(Key::I, Modifiers(), "i");
+  fixture.context.processKeyEvent(Key::A, Modifiers(), "a");
+  fixture.context.undo();
+  Trace::shared().stop();
+
+  std::vector<TraceEvent> events = Trace::shared().events();
+  REQUIRE(countSpans(events, "EditContext::processKeyEvent") == 2);
+  REQUIRE(countSpans(events, "Mode::processKeyEvent") == 2);
+  REQUIRE(countSpans(events, "InsertTransaction::perform") == 1);
+  REQUIRE(countSpans(events, "InsertTransaction::rollback") == 1);
+  REQUIRE(countSpans(events, "Document::insert") == 1);
+  REQUIRE(countSpans(events, "Document::erase") == 1);
+
+  // Spans are ordered by start time, so enclosing spans precede the spans they enclose.
+  REQUIRE(std::string(events.front().name) == "EditContext::processKeyEvent");
+  for (std::size_t index = 1; index < events.size(); ++index) {
+    REQUIRE(events[index - 1].start <= events[index].start);
+  }
+}
+
+TEST_CASE("Traces discard earlier spans when a capture starts.", "[TraceTests]") {
+  Document document("text\n");
+
+  Trace::shared().start();
+  document.matches(SearchExpression("t"));
+  Trace::shared().start();
+  Trace::shared().stop();
+
+  REQUIRE(Trace::shared().events().empty());
+}
+
+TEST_CASE("Traces keep the newest spans when a buffer wraps.", "[TraceTests]") {
+  const char* older = "older";
+  const char* newer = "newer";
+
+  Trace::shared().start();
+  for (std::size_t index = 0; index < 10; ++index) {
+    TraceSpan span(older);
+  }
+
+  for (std::size_t index = 0; index < Trace::BufferCapacity; ++index) {
+    TraceSpan span(newer);
+  }
+
+  Trace::shared().stop();
+
+  std::vector<TraceEvent> events = Trace::shared().events();
+  REQUIRE(events.size() == Trace::BufferCapacity);
+  REQUIRE(countSpans(events, "newer") == Trace::BufferCapacity);
+}
+
+TEST_CASE("Traces record spans from each thread separately.", "[TraceTests]") {
+  Trace::shared().start();
+  {
+    TraceSpan span("main");
+  }
+
+  std::thread worker([]() {
+    TraceSpan span("worker");
+  });
+
+  worker.join();
+  Trace::shared().stop();
+
+  std::vector<TraceEvent> events = Trace::shared().events();
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[0].thread != events[1].thread);
+}
+
+TEST_CASE("Traces reuse the buffers of threads that have exited.", "[TraceTests]") {
+  Trace::shared().start();
+  for (std::size_t index = 0; index < 3 * Trace::RetainedBufferCount; ++index) {
+    std::thread worker([]() {
+      TraceSpan span("worker");
+    });
+
+    worker.join();
+  }
+
+  std::vector<std::thread> workers;
+  for (std::size_t index = 0; index < 2 * Trace::RetainedBufferCount; ++index) {
+    workers.emplace_back([]() {
+      TraceSpan span("concurrent");
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  Trace::shared().stop();
+
+  // The main thread holds one buffer, and exited threads leave at most the retained buffers.
+  REQUIRE(Trace::shared().bufferCount() <= Trace::RetainedBufferCount + 1);
+
+  std::vector<TraceEvent> events = Trace::shared().events();
+  REQUIRE(countSpans(events, "worker") == 3 * Trace::RetainedBufferCount);
+  REQUIRE(countSpans(events, "concurrent") > 0);
+}
+
+TEST_CASE("Traces export Chrome trace events.", "[TraceTests]") {
+  Trace::shared().start();
+  {
+    TraceSpan span("export");
+  }
+
+  Trace::shared().stop();
+
+  std::string trace = Trace::shared().chromeTrace();
+  REQUIRE(trace.find("\"traceEvents\":[") != std::string::npos);
+  REQUIRE(trace.find("{\"name\":\"export\",\"cat\":\"quip\",\"ph\":\"X\",") != std::string::npos);
+}
+
+TEST_CASE("Traces can be captured by scripts.", "[TraceTests]") {
+  char pattern[] = "/tmp/QuipTraceTests.XXXXXX";
+  std::string directory = mkdtemp(pattern);
+  std::string path = directory + "/trace.json";
+
+  ScriptHost scriptHost(QUIP_RUNTIME_PATH);
+  REQUIRE(scriptHost.execute("quip.trace:start() assert(quip.trace.capturing)"));
+  {
+    TraceSpan span("scripted");
+  }
+
+  REQUIRE(scriptHost.execute("quip.trace:stop() assert(not quip.trace.capturing)"));
+  REQUIRE(scriptHost.execute("assert(quip.trace:write('" + path + "'))"));
+
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  REQUIRE(file != nullptr);
+
+  char buffer[256] = { 0 };
+  std::fread(buffer, 1, sizeof(buffer) - 1, file);
+  std::fclose(file);
+
+  REQUIRE(std::string(buffer).find("\"name\":\"scripted\"") != std::string::npos);
+  std::system(("rm -rf '" + directory + "'").c_str());
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include "Document.hpp"
+#include "Location.hpp"
+#include "SearchExpression.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "TrigramIndex.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace quip;
+
+namespace {
+  std::uint32_t trigram(const char* text) {
+    return (static_cast<std::uint32_t>(text[0]) << 16) | (static_cast<std::uint32_t>(text[1]) << 8) | static_cast<std::uint32_t>(text[2]);
+  }
+
+  std::string generateLog(std::size_t rows) {
+    const char* words[] = { "render", "update", "cursor", "signal", "state" };
+    std::string result;
+    for (std::size_t row = 0; row < rows; ++row) {
+      result += words[row % 5];
+      result += " ";
+      result += words[(row / 5) % 5];
+      result += " id=" + std::to_string(row) + "\n";
+    }
+
+    return result;
+  }
+
+  bool sameMatches(const Document& indexed, const Document& plain, const std::string& expression) {
+    SelectionSet left = indexed.matches(SearchExpression(expression));
+    SelectionSet right = plain.matches(SearchExpression(expression));
+    if (left.count() != right.count()) {
+      return false;
+    }
+
+    for (std::size_t index = 0; index < left.count(); ++index) {
+      if (left[index] != right[index]) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+TEST_CASE("Literal text in expressions is required.", "[TrigramIndexTests]") {
+  std::vector<std::uint32_t> trigrams = TrigramIndex::requiredTrigrams("error");
+  REQUIRE(trigrams.size() == 3);
+  REQUIRE(trigrams[0] == trigram("err"));
+  REQUIRE(trigrams[1] == trigram("ror"));
+  REQUIRE(trigrams[2] == trigram("rro"));
+
+  std::vector<std::uint32_t> separated { trigram("bar"), trigram("foo") };
+  std::vector<std::uint32_t> optional { trigram("cde") };
+  std::vector<std::uint32_t> group { trigram("def") };
+  std::vector<std::uint32_t> escaped { trigram(".bc"), trigram("a.b") };
+  std::vector<std::uint32_t> classes { trigram(" do"), trigram("don"), trigram("id="), trigram("one") };
+  REQUIRE(TrigramIndex::requiredTrigrams("foo.*bar") == separated);
+  REQUIRE(TrigramIndex::requiredTrigrams("ab?cde") == optional);
+  REQUIRE(TrigramIndex::requiredTrigrams("(abc)?def") == group);
+  REQUIRE(TrigramIndex::requiredTrigrams("a\\.bc[0-9]+") == escaped);
+  REQUIRE(TrigramIndex::requiredTrigrams("id=\\d+ done") == classes);
+}
+
+TEST_CASE("Expressions that could span rows or alternate are not narrowed.", "[TrigramIndexTests]") {
+  REQUIRE(TrigramIndex::requiredTrigrams("error|warning").empty());
+  REQUIRE(TrigramIndex::requiredTrigrams("error\\s+code").empty());
+  REQUIRE(TrigramIndex::requiredTrigrams("error[^x]code").empty());
+  REQUIRE(TrigramIndex::requiredTrigrams("error\\ncode").empty());
+  REQUIRE(TrigramIndex::requiredTrigrams("ab").empty());
+  REQUIRE(TrigramIndex::requiredTrigrams("a.c").empty());
+}
+
+TEST_CASE("The trigram index narrows searches to candidate chunks.", "[TrigramIndexTests]") {
+  Document document(generateLog(10000) + "needle in the haystack\n" + generateLog(10000));
+  document.trigrams().setEnabled(true);
+
+  std::vector<TrigramIndex::RowRange> ranges = document.trigrams().candidateRows(TrigramIndex::requiredTrigrams("needle"));
+  REQUIRE(ranges.size() == 1);
+  REQUIRE(ranges[0].first <= 10000);
+  REQUIRE(ranges[0].second > 10000);
+  REQUIRE(ranges[0].second - ranges[0].first < 2048);
+
+  SelectionSet matches = document.matches(SearchExpression("need+le"));
+  REQUIRE(matches.count() == 1);
+  REQUIRE(matches[0] == Selection(Location(0, 10000), Location(5, 10000)));
+}
+
+TEST_CASE("Indexed searches find the same matches as full scans.", "[TrigramIndexTests]") {
+  std::string contents = generateLog(5000);
+  Document indexed(contents);
+  Document plain(contents);
+  indexed.trigrams().setEnabled(true);
+
+  REQUIRE(sameMatches(indexed, plain, "cursor"));
+  REQUIRE(sameMatches(indexed, plain, "id=12[0-9]+"));
+  REQUIRE(sameMatches(indexed, plain, "^render"));
+  REQUIRE(sameMatches(indexed, plain, "id=4999\n$"));
+  REQUIRE(sameMatches(indexed, plain, "state update"));
+  REQUIRE(sameMatches(indexed, plain, "missing"));
+}
+
+TEST_CASE("The trigram index is updated when rows are replaced.", "[TrigramIndexTests]") {
+  std::string contents = generateLog(5000);
+  Document indexed(contents);
+  Document plain(contents);
+  indexed.trigrams().setEnabled(true);
+  REQUIRE(indexed.trigrams().build(1000));
+
+  for (Document* document : { &indexed, &plain }) {
+    document->insert(Selection(Location(0, 2500)), "alpha beta\ngamma delta\n");
+    document->erase(Selection(Location(0, 100), Location(0, 1500)));
+    document->insert(Selection(Location(0, 3000)), generateLog(3000) + "epsilon\n");
+  }
+
+  REQUIRE(!indexed.trigrams().isBuilt());
+  REQUIRE(sameMatches(indexed, plain, "alpha"));
+  REQUIRE(sameMatches(indexed, plain, "gamma"));
+  REQUIRE(sameMatches(indexed, plain, "epsilon"));
+  REQUIRE(sameMatches(indexed, plain, "id=1[0-9][0-9] "));
+  REQUIRE(sameMatches(indexed, plain, "id=2999\n"));
+}
+
+TEST_CASE("The trigram index is built in bounded steps.", "[TrigramIndexTests]") {
+  Document document(generateLog(5000));
+  REQUIRE(!document.trigrams().isEnabled());
+  REQUIRE(document.trigrams().memoryUsage() == 0);
+
+  document.trigrams().setEnabled(true);
+  REQUIRE(!document.trigrams().isBuilt());
+  REQUIRE(!document.trigrams().build(2));
+  REQUIRE(document.trigrams().build(3));
+  REQUIRE(document.trigrams().memoryUsage() > 0);
+}
@@ -0,0 +1,42 @@
+#include "MemoryAccounting.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Replacements for the global allocation functions that account each allocation to the current
+// memory category. Executables opt in by adding the objects of the Quip.AllocationHooks library to
+// their sources.
+namespace {
+  void* allocate(std::size_t size) {
+    quip::MemoryAccounting::recordAllocation(size);
+    if (void* result = std::malloc(size == 0 ? 1 : size)) {
+      return result;
+    }
+
+    throw std::bad_alloc();
+  }
+}
+
+void* operator new(std::size_t size) {
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
@@ -2,6 +2,8 @@
 
 #include "Document.hpp"
 #include "EditContext.hpp"
+#include "MemoryAccounting.hpp"
+#include "Trace.hpp"
 
 namespace quip {
   AppendTransaction::AppendTransaction(const SelectionSet& selections, const std::vector<std::string>& text)
@@ -13,19 +15,35 @@ namespace quip {
   }
   
   void AppendTransaction::perform(EditContext& context) {
-    m_rollbackSelections = context.document().append(m_selections, m_text);
+    TraceSpan span("AppendTransaction::perform");
+    
+    // A single text is appended to every selection, without replicating it per selection.
+    if (m_text.size() == 1) {
+      m_rollbackSelections = context.document().append(m_selections, m_text.front());
+    } else {
+      m_rollbackSelections = context.document().append(m_selections, m_text);
+    }
+    
     context.selections().replace(m_rollbackSelections);
   }
   
   void AppendTransaction::rollback(EditContext& context) {
+    TraceSpan span("AppendTransaction::rollback");
+    
     context.selections().replace(context.document().erase(m_rollbackSelections));
   }
   
+  std::size_t AppendTransaction::memoryUsage() const {
+    return sizeof(*this) + m_selections.memoryUsage() + m_rollbackSelections.memoryUsage() + quip::memoryUsage(m_text);
+  }
+  
   std::shared_ptr<Transaction> AppendTransaction::create(const SelectionSet& selections, const std::string& text) {
-    return std::make_shared<AppendTransaction>(selections, std::vector<std::string> {selections.count(), text });
+    MemoryScope scope(MemoryCategory::UndoHistory);
+    return std::make_shared<AppendTransaction>(selections, std::vector<std::string> { text });
   }
   
   std::shared_ptr<Transaction> AppendTransaction::create(const SelectionSet& selections, const std::vector<std::string>& text) {
+    MemoryScope scope(MemoryCategory::UndoHistory);
     return std::make_shared<AppendTransaction>(selections, text);
   }
 }
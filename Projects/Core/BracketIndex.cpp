@@ -0,0 +1,511 @@
+#include "BracketIndex.hpp"
+
+#include "Selection.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+namespace quip {
+  namespace {
+    const char* OpenBlockCharacters = "{[<";
+    const char* CloseBlockCharacters = "}]>";
+
+    // Treap priorities only need to look random, so a counter is hashed rather than drawing from a
+    // generator, which keeps the shape of the tree reproducible.
+    std::uint64_t priorityOf(std::uint64_t value) {
+      value += 0x9e3779b97f4a7c15ULL;
+      value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+      return value ^ (value >> 31);
+    }
+  }
+
+  BracketIndex::Summary::Summary() {
+    sum.fill(0);
+    maximumSuffix.fill(0);
+    minimumPrefix.fill(0);
+  }
+
+  BracketIndex::BracketIndex()
+  : m_root(NoNode)
+  , m_nodesCreated(0) {
+  }
+
+  void BracketIndex::reset(const std::vector<std::string>& rows) {
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_nodes.reserve(rows.size());
+    m_root = build(rows, 0, rows.size());
+  }
+
+  void BracketIndex::replaceRows(std::size_t row, std::size_t removed, const std::vector<std::string>& rows, std::size_t inserted) {
+    // Most edits rewrite rows without changing their number (typing at many cursors rewrites one
+    // row per cursor), so the tree keeps its shape and only the summaries above each row change.
+    if (removed == inserted) {
+      for (std::size_t index = row; index < row + inserted; ++index) {
+        updateRow(index, rows[index]);
+      }
+
+      return;
+    }
+
+    std::uint32_t before = NoNode;
+    std::uint32_t rest = NoNode;
+    std::uint32_t replaced = NoNode;
+    std::uint32_t after = NoNode;
+    split(m_root, row, before, rest);
+    split(rest, removed, replaced, after);
+    releaseNodes(replaced);
+
+    std::uint32_t replacement = build(rows, row, row + inserted);
+    m_root = join(join(before, replacement), after);
+  }
+
+  Optional<Location> BracketIndex::matchingBracket(const Location& location) const {
+    refresh(m_root);
+
+    const Token* token = tokenAt(location);
+    if (token == nullptr) {
+      return Optional<Location>();
+    }
+
+    if (token->depth > 0) {
+      return findCloseAfter(token->kind, location);
+    }
+
+    return findOpenBefore(token->kind, location);
+  }
+
+  Optional<Selection> BracketIndex::enclosingPair(const Location& location) const {
+    return enclosingPair(Selection(location));
+  }
+
+  Optional<Selection> BracketIndex::enclosingPair(const Selection& selection) const {
+    refresh(m_root);
+
+    Optional<Selection> result;
+    for (std::size_t kind = 0; kind < KindCount; ++kind) {
+      Optional<Selection> candidate = pairAt(kind, selection.origin());
+      if (!candidate.has_value()) {
+        candidate = pairEnclosing(kind, selection.origin());
+      }
+
+      // Pairs of the same kind nest properly, so walking outwards will eventually find a pair that
+      // covers the entire selection (or run out of pairs).
+      while (candidate.has_value() && (candidate->extent() < selection.extent() || *candidate == selection)) {
+        candidate = pairEnclosing(kind, candidate->origin());
+      }
+
+      // Pairs of different kinds may not nest properly, in which case the innermost pair is the one
+      // that starts latest.
+      if (candidate.has_value() && (!result.has_value() || candidate->origin() > result->origin())) {
+        result = candidate;
+      }
+    }
+
+    return result;
+  }
+
+  void BracketIndex::tokenize(const std::string& text, std::vector<Token>& results) {
+    results.clear();
+    for (std::size_t column = 0; column < text.size(); ++column) {
+      char character = text[column];
+      for (std::uint8_t kind = 0; kind < KindCount; ++kind) {
+        if (character == OpenBlockCharacters[kind]) {
+          results.push_back(Token { column, kind, 1 });
+        } else if (character == CloseBlockCharacters[kind]) {
+          results.push_back(Token { column, kind, -1 });
+        }
+      }
+    }
+  }
+
+  BracketIndex::Summary BracketIndex::summarize(const std::vector<Token>& tokens) {
+    Summary result;
+    for (const Token& token : tokens) {
+      result.sum[token.kind] += token.depth;
+      result.minimumPrefix[token.kind] = std::min(result.minimumPrefix[token.kind], result.sum[token.kind]);
+    }
+
+    std::array<std::int32_t, KindCount> suffix;
+    suffix.fill(0);
+    for (std::vector<Token>::const_reverse_iterator token = tokens.rbegin(); token != tokens.rend(); ++token) {
+      suffix[token->kind] += token->depth;
+      result.maximumSuffix[token->kind] = std::max(result.maximumSuffix[token->kind], suffix[token->kind]);
+    }
+
+    return result;
+  }
+
+  BracketIndex::Summary BracketIndex::combine(const Summary& left, const Summary& right) {
+    Summary result;
+    for (std::size_t kind = 0; kind < KindCount; ++kind) {
+      result.sum[kind] = left.sum[kind] + right.sum[kind];
+      result.maximumSuffix[kind] = std::max(right.maximumSuffix[kind], right.sum[kind] + left.maximumSuffix[kind]);
+      result.minimumPrefix[kind] = std::min(left.minimumPrefix[kind], left.sum[kind] + right.minimumPrefix[kind]);
+    }
+
+    return result;
+  }
+
+  std::size_t BracketIndex::rows() const {
+    return sizeOf(m_root);
+  }
+
+  std::uint32_t BracketIndex::sizeOf(std::uint32_t node) const {
+    return node == NoNode ? 0 : m_nodes[node].size;
+  }
+
+  std::uint32_t BracketIndex::createNode(const std::string& text) {
+    std::uint32_t node = 0;
+    if (m_freeNodes.empty()) {
+      node = static_cast<std::uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+    } else {
+      node = m_freeNodes.back();
+      m_freeNodes.pop_back();
+    }
+
+    Node& result = m_nodes[node];
+    tokenize(text, result.tokens);
+    result.row = summarize(result.tokens);
+    result.priority = priorityOf(m_nodesCreated++);
+    result.left = NoNode;
+    result.right = NoNode;
+    updateNode(node);
+    return node;
+  }
+
+  void BracketIndex::releaseNodes(std::uint32_t node) {
+    if (node == NoNode) {
+      return;
+    }
+
+    releaseNodes(m_nodes[node].left);
+    releaseNodes(m_nodes[node].right);
+    m_nodes[node].tokens = std::vector<Token>();
+    m_freeNodes.push_back(node);
+  }
+
+  void BracketIndex::updateNode(std::uint32_t node) {
+    // The subtree summary is recomputed by the next query, so that a run of edits between queries
+    // combines each summary once.
+    Node& current = m_nodes[node];
+    current.size = 1 + sizeOf(current.left) + sizeOf(current.right);
+    current.isStale = true;
+  }
+
+  void BracketIndex::updateRow(std::size_t row, const std::string& text) {
+    // Find the row's node, marking the subtrees along the way as stale.
+    std::uint32_t node = m_root;
+    for (;;) {
+      Node& current = m_nodes[node];
+      current.isStale = true;
+
+      std::size_t leftSize = sizeOf(current.left);
+      if (row < leftSize) {
+        node = current.left;
+      } else if (row == leftSize) {
+        break;
+      } else {
+        row -= leftSize + 1;
+        node = current.right;
+      }
+    }
+
+    Node& current = m_nodes[node];
+    tokenize(text, current.tokens);
+    current.row = summarize(current.tokens);
+  }
+
+  void BracketIndex::refresh(std::uint32_t node) const {
+    if (node == NoNode || !m_nodes[node].isStale) {
+      return;
+    }
+
+    const Node& current = m_nodes[node];
+    refresh(current.left);
+    refresh(current.right);
+
+    current.subtree = current.row;
+    if (current.left != NoNode) {
+      current.subtree = combine(m_nodes[current.left].subtree, current.subtree);
+    }
+
+    if (current.right != NoNode) {
+      current.subtree = combine(current.subtree, m_nodes[current.right].subtree);
+    }
+
+    current.isStale = false;
+  }
+
+  std::uint32_t BracketIndex::build(const std::vector<std::string>& rows, std::size_t first, std::size_t last) {
+    // Build a balanced tree over the rows in [first, last), then restore the heap order of the
+    // priorities by sifting each node's priority down, as in heapsort. Only the priority values
+    // move, so the rows stay in order and the tree stays balanced.
+    if (first >= last) {
+      return NoNode;
+    }
+
+    std::size_t middle = first + (last - first) / 2;
+    std::uint32_t node = createNode(rows[middle]);
+    std::uint32_t left = build(rows, first, middle);
+    std::uint32_t right = build(rows, middle + 1, last);
+    m_nodes[node].left = left;
+    m_nodes[node].right = right;
+    updateNode(node);
+
+    for (std::uint32_t cursor = node;;) {
+      std::uint32_t largest = cursor;
+      for (std::uint32_t child : { m_nodes[cursor].left, m_nodes[cursor].right }) {
+        if (child != NoNode && m_nodes[child].priority > m_nodes[largest].priority) {
+          largest = child;
+        }
+      }
+
+      if (largest == cursor) {
+        break;
+      }
+
+      std::swap(m_nodes[cursor].priority, m_nodes[largest].priority);
+      cursor = largest;
+    }
+
+    return node;
+  }
+
+  void BracketIndex::split(std::uint32_t node, std::size_t count, std::uint32_t& left, std::uint32_t& right) {
+    // Split a tree into its first rows, up to the specified count, and the remainder.
+    if (node == NoNode) {
+      left = NoNode;
+      right = NoNode;
+      return;
+    }
+
+    std::size_t leftSize = sizeOf(m_nodes[node].left);
+    if (count <= leftSize) {
+      split(m_nodes[node].left, count, left, m_nodes[node].left);
+      right = node;
+    } else {
+      split(m_nodes[node].right, count - leftSize - 1, m_nodes[node].right, right);
+      left = node;
+    }
+
+    updateNode(node);
+  }
+
+  std::uint32_t BracketIndex::join(std::uint32_t left, std::uint32_t right) {
+    // Join two trees, where every row in the left tree precedes every row in the right tree.
+    if (left == NoNode) {
+      return right;
+    } else if (right == NoNode) {
+      return left;
+    }
+
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+      m_nodes[left].right = join(m_nodes[left].right, right);
+      updateNode(left);
+      return left;
+    }
+
+    m_nodes[right].left = join(left, m_nodes[right].left);
+    updateNode(right);
+    return right;
+  }
+
+  const std::vector<BracketIndex::Token>& BracketIndex::tokensOfRow(std::size_t row) const {
+    std::uint32_t node = m_root;
+    for (;;) {
+      const Node& current = m_nodes[node];
+      std::size_t leftSize = sizeOf(current.left);
+      if (row < leftSize) {
+        node = current.left;
+      } else if (row == leftSize) {
+        return current.tokens;
+      } else {
+        row -= leftSize + 1;
+        node = current.right;
+      }
+    }
+  }
+
+  const BracketIndex::Token* BracketIndex::tokenAt(const Location& location) const {
+    if (location.row() >= rows()) {
+      return nullptr;
+    }
+
+    const std::vector<Token>& tokens = tokensOfRow(location.row());
+    std::vector<Token>::const_iterator cursor = std::lower_bound(tokens.begin(), tokens.end(), location.column(), [](const Token& token, std::uint64_t column) {
+      return token.column < column;
+    });
+
+    if (cursor == tokens.end() || cursor->column != location.column()) {
+      return nullptr;
+    }
+
+    return &(*cursor);
+  }
+
+  Optional<Location> BracketIndex::findOpenBefore(std::size_t kind, const Location& location) const {
+    if (location.row() >= rows()) {
+      return Optional<Location>();
+    }
+
+    // Walk backwards accumulating depth; the first open bracket that brings the depth to one is
+    // the nearest unbalanced open bracket.
+    std::int32_t depth = 0;
+    const std::vector<Token>& tokens = tokensOfRow(location.row());
+    for (std::vector<Token>::const_reverse_iterator token = tokens.rbegin(); token != tokens.rend(); ++token) {
+      if (token->column < location.column() && token->kind == kind) {
+        depth += token->depth;
+        if (depth >= 1) {
+          return Location(token->column, location.row());
+        }
+      }
+    }
+
+    std::size_t row = 0;
+    if (descendBackward(m_root, 0, location.row(), kind, depth, row)) {
+      const std::vector<Token>& tokens = tokensOfRow(row);
+      for (std::vector<Token>::const_reverse_iterator token = tokens.rbegin(); token != tokens.rend(); ++token) {
+        if (token->kind == kind) {
+          depth += token->depth;
+          if (depth >= 1) {
+            return Location(token->column, row);
+          }
+        }
+      }
+    }
+
+    return Optional<Location>();
+  }
+
+  Optional<Location> BracketIndex::findCloseAfter(std::size_t kind, const Location& location) const {
+    if (location.row() >= rows()) {
+      return Optional<Location>();
+    }
+
+    // Walk forwards accumulating depth; the first close bracket that brings the depth to negative
+    // one is the nearest unbalanced close bracket.
+    std::int32_t depth = 0;
+    for (const Token& token : tokensOfRow(location.row())) {
+      if (token.column > location.column() && token.kind == kind) {
+        depth += token.depth;
+        if (depth <= -1) {
+          return Location(token.column, location.row());
+        }
+      }
+    }
+
+    std::size_t row = 0;
+    if (descendForward(m_root, 0, location.row() + 1, kind, depth, row)) {
+      for (const Token& token : tokensOfRow(row)) {
+        if (token.kind == kind) {
+          depth += token.depth;
+          if (depth <= -1) {
+            return Location(token.column, row);
+          }
+        }
+      }
+    }
+
+    return Optional<Location>();
+  }
+
+  bool BracketIndex::descendBackward(std::uint32_t node, std::size_t offset, std::size_t limit, std::size_t kind, std::int32_t& depth, std::size_t& row) const {
+    // Search the rows of the subtree, which begins at the offset, that are before the limit, latest
+    // first. Subtrees entirely before the limit are skipped when their summary rules them out.
+    if (node == NoNode || offset >= limit) {
+      return false;
+    }
+
+    const Node& current = m_nodes[node];
+    if (offset + current.size <= limit && depth + current.subtree.maximumSuffix[kind] < 1) {
+      depth += current.subtree.sum[kind];
+      return false;
+    }
+
+    std::size_t position = offset + sizeOf(current.left);
+    if (descendBackward(current.right, position + 1, limit, kind, depth, row)) {
+      return true;
+    }
+
+    if (position < limit) {
+      if (depth + current.row.maximumSuffix[kind] >= 1) {
+        row = position;
+        return true;
+      }
+
+      depth += current.row.sum[kind];
+    }
+
+    return descendBackward(current.left, offset, limit, kind, depth, row);
+  }
+
+  bool BracketIndex::descendForward(std::uint32_t node, std::size_t offset, std::size_t limit, std::size_t kind, std::int32_t& depth, std::size_t& row) const {
+    // Search the rows of the subtree, which begins at the offset, that are at or after the limit,
+    // earliest first. Subtrees entirely after the limit are skipped when their summary rules them
+    // out.
+    if (node == NoNode || offset + m_nodes[node].size <= limit) {
+      return false;
+    }
+
+    const Node& current = m_nodes[node];
+    if (offset >= limit && depth + current.subtree.minimumPrefix[kind] > -1) {
+      depth += current.subtree.sum[kind];
+      return false;
+    }
+
+    std::size_t position = offset + sizeOf(current.left);
+    if (descendForward(current.left, offset, limit, kind, depth, row)) {
+      return true;
+    }
+
+    if (position >= limit) {
+      if (depth + current.row.minimumPrefix[kind] <= -1) {
+        row = position;
+        return true;
+      }
+
+      depth += current.row.sum[kind];
+    }
+
+    return descendForward(current.right, position + 1, limit, kind, depth, row);
+  }
+
+  Optional<Selection> BracketIndex::pairAt(std::size_t kind, const Location& location) const {
+    const Token* token = tokenAt(location);
+    if (token == nullptr || token->kind != kind) {
+      return Optional<Selection>();
+    }
+
+    if (token->depth > 0) {
+      Optional<Location> close = findCloseAfter(kind, location);
+      if (close.has_value()) {
+        return Selection(location, *close);
+      }
+    } else {
+      Optional<Location> open = findOpenBefore(kind, location);
+      if (open.has_value()) {
+        return Selection(*open, location);
+      }
+    }
+
+    return Optional<Selection>();
+  }
+
+  Optional<Selection> BracketIndex::pairEnclosing(std::size_t kind, const Location& location) const {
+    Optional<Location> open = findOpenBefore(kind, location);
+    if (!open.has_value()) {
+      return Optional<Selection>();
+    }
+
+    Optional<Location> close = findCloseAfter(kind, *open);
+    if (!close.has_value()) {
+      return Optional<Selection>();
+    }
+
+    return Selection(*open, *close);
+  }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Location.hpp"
+#include "Optional.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace quip {
+  struct Selection;
+
+  // An index of the block characters (braces, square brackets and angle brackets) in a document,
+  // used to answer bracket matching and nesting queries without scanning the document text.
+  //
+  // Each row's block characters are tokenized when the row changes. The rows are kept in a treap
+  // ordered by position, and each node summarizes the depth changes of the rows in its subtree, so
+  // that the nearest unbalanced bracket in either direction can be found in logarithmic time. Each
+  // kind of bracket nests independently of the others, so (for example) a stray less-than operator
+  // doesn't disturb the matching of braces.
+  //
+  // The index is kept up to date by the owning document as rows are replaced. Rewriting rows in
+  // place only retokenizes them; replacing rows with a different number splits the treap around
+  // them and joins the replacements in. Either way the cost of an edit is logarithmic in the number
+  // of rows (plus the number of rows replaced). The summaries of changed subtrees are recomputed by
+  // the next query, so a run of edits doesn't pay for them on every keystroke.
+  struct BracketIndex {
+    BracketIndex();
+
+    void reset(const std::vector<std::string>& rows);
+    void replaceRows(std::size_t row, std::size_t removed, const std::vector<std::string>& rows, std::size_t inserted);
+
+    // Get the location of the bracket matching the one at the specified location, if any.
+    Optional<Location> matchingBracket(const Location& location) const;
+
+    // Get the innermost bracket pair containing the specified location. The brackets themselves are
+    // considered to be inside the pair.
+    Optional<Selection> enclosingPair(const Location& location) const;
+
+    // Get the innermost bracket pair containing the specified selection, other than the selection
+    // itself.
+    Optional<Selection> enclosingPair(const Selection& selection) const;
+
+  private:
+    static constexpr std::size_t KindCount = 3;
+
+    struct Token {
+      std::uint64_t column;
+      std::uint8_t kind;
+      std::int8_t depth;
+    };
+
+    struct Summary {
+      std::array<std::int32_t, KindCount> sum;
+      std::array<std::int32_t, KindCount> maximumSuffix;
+      std::array<std::int32_t, KindCount> minimumPrefix;
+
+      Summary();
+    };
+
+    // Nodes are pooled and refer to each other by index.
+    static constexpr std::uint32_t NoNode = 0xFFFFFFFF;
+
+    struct Node {
+      std::vector<Token> tokens;
+      Summary row;
+
+      // The summary of the node's subtree, which is recomputed when a query needs it after the
+      // subtree has changed.
+      mutable Summary subtree;
+      mutable bool isStale;
+
+      std::uint64_t priority;
+      std::uint32_t left;
+      std::uint32_t right;
+      std::uint32_t size;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_freeNodes;
+    std::uint32_t m_root;
+    std::uint64_t m_nodesCreated;
+
+    static void tokenize(const std::string& text, std::vector<Token>& results);
+    static Summary summarize(const std::vector<Token>& tokens);
+    static Summary combine(const Summary& left, const Summary& right);
+
+    std::size_t rows() const;
+    std::uint32_t sizeOf(std::uint32_t node) const;
+
+    std::uint32_t createNode(const std::string& text);
+    void releaseNodes(std::uint32_t node);
+    void updateNode(std::uint32_t node);
+    void updateRow(std::size_t row, const std::string& text);
+    void refresh(std::uint32_t node) const;
+
+    std::uint32_t build(const std::vector<std::string>& rows, std::size_t first, std::size_t last);
+    void split(std::uint32_t node, std::size_t count, std::uint32_t& left, std::uint32_t& right);
+    std::uint32_t join(std::uint32_t left, std::uint32_t right);
+
+    const std::vector<Token>& tokensOfRow(std::size_t row) const;
+
+    const Token* tokenAt(const Location& location) const;
+
+    Optional<Location> findOpenBefore(std::size_t kind, const Location& location) const;
+    Optional<Location> findCloseAfter(std::size_t kind, const Location& location) const;
+    bool descendBackward(std::uint32_t node, std::size_t offset, std::size_t limit, std::size_t kind, std::int32_t& depth, std::size_t& row) const;
+    bool descendForward(std::uint32_t node, std::size_t offset, std::size_t limit, std::size_t kind, std::int32_t& depth, std::size_t& row) const;
+
+    Optional<Selection> pairAt(std::size_t kind, const Location& location) const;
+    Optional<Selection> pairEnclosing(std::size_t kind, const Location& location) const;
+  };
+}
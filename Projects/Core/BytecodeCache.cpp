@@ -0,0 +1,174 @@
+#include "BytecodeCache.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quip {
+  namespace {
+    const char Magic[4] = { 'Q', 'L', 'B', 'C' };
+    const std::uint32_t FormatVersion = 1;
+    
+    // The header of a cache entry, which is followed by the bytecode itself.
+    struct EntryHeader {
+      char magic[4];
+      std::uint32_t version;
+      std::int64_t modified;
+      std::uint64_t size;
+      std::uint64_t hash;
+    };
+    
+    std::uint64_t hashBytes(const char* bytes, std::size_t count) {
+      // 64-bit FNV-1a.
+      std::uint64_t result = 14695981039346656037ull;
+      for (std::size_t index = 0; index < count; ++index) {
+        result ^= static_cast<unsigned char>(bytes[index]);
+        result *= 1099511628211ull;
+      }
+      
+      return result;
+    }
+    
+    bool readFile(const std::string& path, std::string& contents) {
+      std::FILE* file = std::fopen(path.c_str(), "rb");
+      if (file == nullptr) {
+        return false;
+      }
+      
+      // Read in large blocks; the files are small, so this is usually a single read.
+      char buffer[16384];
+      contents.clear();
+      std::size_t count = 0;
+      while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, count);
+      }
+      
+      bool result = std::ferror(file) == 0;
+      std::fclose(file);
+      return result;
+    }
+    
+    // Write a file by writing a uniquely named temporary file beside it and renaming that over the
+    // file, so concurrent readers (and writers) never see a partial file.
+    bool replaceFile(const std::string& path, const std::string& contents) {
+      std::string pattern = path + ".XXXXXX";
+      std::vector<char> temporaryPath(pattern.begin(), pattern.end());
+      temporaryPath.push_back('\0');
+      int descriptor = mkstemp(temporaryPath.data());
+      if (descriptor == -1) {
+        return false;
+      }
+      
+      const char* bytes = contents.data();
+      std::size_t remaining = contents.size();
+      while (remaining > 0) {
+        ssize_t count = write(descriptor, bytes, remaining);
+        if (count == -1 && errno == EINTR) {
+          continue;
+        } else if (count <= 0) {
+          break;
+        }
+        
+        bytes += count;
+        remaining -= static_cast<std::size_t>(count);
+      }
+      
+      bool result = close(descriptor) == 0 && remaining == 0 && std::rename(temporaryPath.data(), path.c_str()) == 0;
+      if (!result) {
+        std::remove(temporaryPath.data());
+      }
+      
+      return result;
+    }
+    
+    int writeChunk(lua_State* state, const void* bytes, std::size_t count, void* buffer) {
+      reinterpret_cast<std::string*>(buffer)->append(reinterpret_cast<const char*>(bytes), count);
+      return 0;
+    }
+  }
+  
+  BytecodeCache::BytecodeCache()
+  : m_hits(0)
+  , m_misses(0) {
+  }
+  
+  BytecodeCache::BytecodeCache(const std::string& directory)
+  : m_directory(directory)
+  , m_hits(0)
+  , m_misses(0) {
+  }
+  
+  const std::string& BytecodeCache::directory() const {
+    return m_directory;
+  }
+  
+  int BytecodeCache::load(lua_State* state, const std::string& path) {
+    std::string chunkName = "@" + path;
+    std::string source;
+    struct stat status;
+    if (!readFile(path, source) || stat(path.c_str(), &status) != 0) {
+      lua_pushfstring(state, "cannot open %s", path.c_str());
+      return LUA_ERRFILE;
+    }
+    
+    if (m_directory.empty()) {
+      return luaL_loadbufferx(state, source.data(), source.size(), chunkName.c_str(), "t");
+    }
+    
+    EntryHeader expected;
+    std::memcpy(expected.magic, Magic, sizeof(Magic));
+    expected.version = FormatVersion * 1000 + LUA_VERSION_NUM;
+    expected.modified = static_cast<std::int64_t>(status.st_mtime);
+    expected.size = source.size();
+    expected.hash = hashBytes(source.data(), source.size());
+    
+    std::string entry;
+    std::string cachePath = entryPath(path);
+    if (readFile(cachePath, entry) && entry.size() > sizeof(EntryHeader)) {
+      EntryHeader actual;
+      std::memcpy(&actual, entry.data(), sizeof(EntryHeader));
+      if (std::memcmp(&actual, &expected, sizeof(EntryHeader)) == 0) {
+        int result = luaL_loadbufferx(state, entry.data() + sizeof(EntryHeader), entry.size() - sizeof(EntryHeader), chunkName.c_str(), "b");
+        if (result == LUA_OK) {
+          ++m_hits;
+          return result;
+        }
+        
+        // The entry is damaged; fall back to the source (which will rewrite it).
+        lua_pop(state, 1);
+      }
+    }
+    
+    ++m_misses;
+    int result = luaL_loadbufferx(state, source.data(), source.size(), chunkName.c_str(), "t");
+    if (result != LUA_OK) {
+      return result;
+    }
+    
+    // Debug information is kept so errors still report source lines.
+    std::string bytecode(reinterpret_cast<const char*>(&expected), sizeof(EntryHeader));
+    lua_dump(state, writeChunk, &bytecode, 0);
+    
+    // Failing to write the cache is not an error; the script was still loaded.
+    replaceFile(cachePath, bytecode);
+    return result;
+  }
+  
+  std::size_t BytecodeCache::hits() const {
+    return m_hits;
+  }
+  
+  std::size_t BytecodeCache::misses() const {
+    return m_misses;
+  }
+  
+  std::string BytecodeCache::entryPath(const std::string& path) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.luac", static_cast<unsigned long long>(hashBytes(path.data(), path.size())));
+    return m_directory + "/" + name;
+  }
+}
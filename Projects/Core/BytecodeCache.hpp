@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Lua.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace quip {
+  // Loads Lua source files through an on-disk cache of their compiled bytecode.
+  //
+  // Each cached chunk is stored in its own file in the cache directory, named for a hash of the
+  // source path, and records the source file's modification time, size and content hash. A cached
+  // chunk is used only if all three still match the source file; otherwise the source is compiled
+  // and the cache entry is rewritten. An empty cache directory disables caching.
+  struct BytecodeCache {
+    BytecodeCache();
+    explicit BytecodeCache(const std::string& directory);
+    
+    const std::string& directory() const;
+    
+    // Load the chunk for the specified source file onto the Lua stack, returning the Lua status
+    // code. On failure, the error message is pushed instead, as with luaL_loadfile.
+    int load(lua_State* state, const std::string& path);
+    
+    std::size_t hits() const;
+    std::size_t misses() const;
+    
+  private:
+    std::string m_directory;
+    std::size_t m_hits;
+    std::size_t m_misses;
+    
+    std::string entryPath(const std::string& path) const;
+  };
+}
@@ -1,10 +1,14 @@
 #include "Document.hpp"
 
 #include "DocumentIterator.hpp"
+#include "LuaBinding.hpp"
+#include "MemoryAccounting.hpp"
 #include "ReverseDocumentIterator.hpp"
 #include "SearchExpression.hpp"
 #include "Selection.hpp"
 #include "SelectionSet.hpp"
+#include "TextView.hpp"
+#include "Trace.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -14,11 +18,52 @@
 #include <string>
 
 namespace quip {
-  Document::Document() {
+  namespace {
+    TextView viewRow(Document& document, std::size_t row) {
+      return TextView(document, row);
+    }
+    
+    TextView viewChunk(Document& document, const Location& location, std::size_t length) {
+      return TextView(document, location.row(), location.column(), length);
+    }
+    
+    std::string copyText(Document& document, const Selection& selection) {
+      return document.contents(document.clamp(selection));
+    }
+    
+    void indexTrigrams(Document& document) {
+      document.trigrams().setEnabled(true);
+    }
+    
+    // Find the location of an offset into the contents of a selection, given the offsets at which
+    // each of the selection's rows end.
+    Location locationInSelection(const Location& origin, const std::vector<std::size_t>& rowEnds, std::size_t offset) {
+      std::size_t index = std::upper_bound(rowEnds.begin(), rowEnds.end(), offset) - rowEnds.begin();
+      if (index == 0) {
+        return Location(origin.column() + offset, origin.row());
+      }
+      
+      return Location(offset - rowEnds[index - 1], origin.row() + index);
+    }
+  }
+  
+  Document::Document()
+  : m_revision(0)
+  , m_lifetime(std::make_shared<char>())
+  , m_words(m_rows)
+  , m_trigrams(m_rows) {
   }
   
   Document::Document(const std::string& content)
-  : m_rows(decompose(content)) {
+  : m_revision(0)
+  , m_lifetime(std::make_shared<char>())
+  , m_words(m_rows)
+  , m_trigrams(m_rows) {
+    MemoryScope scope(MemoryCategory::Document);
+    m_rows = decompose(content);
+    m_brackets.reset(m_rows);
+    m_words.reset();
+    m_trigrams.reset();
   }
   
   std::string Document::contents() const {
@@ -44,6 +89,14 @@ namespace quip {
     return !text.empty() && text.back() != '\n';
   }
   
+  std::uint64_t Document::revision() const noexcept {
+    return m_revision;
+  }
+  
+  std::weak_ptr<const void> Document::lifetime() const {
+    return m_lifetime;
+  }
+  
   std::string Document::contents(const Selection& selection) const {
     if (m_rows.size() == 0) {
       // Selections always cover at least one character, so it's not
@@ -139,6 +192,23 @@ namespace quip {
     return from <= to ? result : -result;
   }
   
+  Location Document::clamp(const Location& location) const {
+    if (m_rows.size() == 0) {
+      return Location(0, 0);
+    }
+    
+    std::uint64_t row = std::min<std::uint64_t>(location.row(), m_rows.size() - 1);
+    std::uint64_t column = std::min<std::uint64_t>(location.column(), m_rows[row].size() - 1);
+    return Location(column, row);
+  }
+  
+  Selection Document::clamp(const Selection& selection) const {
+    // Selections from outside the editor may also be reversed.
+    Location origin = clamp(selection.origin());
+    Location extent = clamp(selection.extent());
+    return Selection(std::min(origin, extent), std::max(origin, extent));
+  }
+  
   const std::string& Document::path() const {
     return m_path;
   }
@@ -178,79 +248,15 @@ namespace quip {
   }
   
   SelectionSet Document::insert(const SelectionSet& selections, const std::string& text) {
-    std::vector<std::string> replicated(selections.count(), text);
-    return insert(selections, replicated);
+    return insert(selections, &text, 0);
   }
   
   SelectionSet Document::insert(const SelectionSet& selections, const std::vector<std::string>& text) {
-    if (selections.count() == 0 || text.size() == 0) {
+    if (text.size() == 0) {
       return selections;
     }
     
-    // The updated selection set cannot be larger than the initial selection set, so storage
-    // can be reserved up front.
-    std::vector<Selection> updated;
-    updated.reserve(selections.count());
-    
-    std::int64_t columnShift = 0;
-    std::int64_t rowShift = 0;
-    for (std::uint64_t index = 0; index < selections.count(); ++index) {
-      std::vector<std::string> lines = decompose(text[index]);
-      if (lines.size() == 0) {
-        continue;
-      }
-      
-      if (m_rows.size() == 0) {
-        // If the document is empty, just copy the entire lines array in and break the loop.
-        // The selection set is basically irrelevant; the only legal set for an empty document
-        // consists entirely of the single-character selection at (0, 0).
-        m_rows = lines;
-        updated.emplace_back(Location(m_rows.back().size(), m_rows.size() - 1));
-        break;
-      }
-      
-      const Selection& selection = selections[index];
-      Location origin = selection.origin().adjustBy(columnShift, rowShift);
-      std::string prefix = m_rows[origin.row()].substr(0, origin.column());
-      std::string suffix = m_rows[origin.row()].substr(origin.column());
-      std::uint64_t rowsToInsert = lines.size() - 1;
-      if (lines.back().back() == '\n') {
-        ++rowsToInsert;
-      }
-      
-      // Compose resulting text, inserting rows as needed.
-      m_rows[origin.row()] = prefix + lines.front();
-      m_rows.insert(m_rows.begin() + origin.row() + 1, rowsToInsert, "");
-      for (std::uint64_t line = 1; line <= lines.size() - 1; ++line) {
-        m_rows[origin.row() + line] = lines[line];
-      }
-      
-      m_rows[origin.row() + rowsToInsert] += suffix;
-      
-      // Update shifts to track how this selection impacts any subsequent selections.
-      columnShift += lines.front().size();
-      rowShift += rowsToInsert;
-      if (index + 1 < selections.count()) {
-        const Selection& next = selections[index + 1];
-        if (selection.extent().row() != next.origin().row()) {
-          // Whether or not adjacent selections have the same line in common impacts how
-          // to shift the next selection.
-          columnShift = 0;
-        }
-      }
-      
-      // Insert operations displace selections such that the origin remains after the
-      // text that was inserted.
-      if (rowsToInsert == 0) {
-        updated.emplace_back(Location(origin.column() + lines.front().size(), origin.row()));
-      } else {
-        std::uint64_t row = origin.row() + rowsToInsert;
-        updated.emplace_back(Location(m_rows[row].size() - suffix.size(), row));
-      }
-    }
-    
-    m_documentModifiedSignal.transmit();
-    return SelectionSet(updated);
+    return insert(selections, text.data(), 1);
   }
   
   SelectionSet Document::append(const Selection& selection, const std::string& text) {
@@ -258,25 +264,15 @@ namespace quip {
   }
   
   SelectionSet Document::append(const SelectionSet& selections, const std::string& text) {
-    std::vector<std::string> replicated(selections.count(), text);
-    return append(selections, replicated);
+    return append(selections, &text, 0);
   }
   
   SelectionSet Document::append(const SelectionSet& selections, const std::vector<std::string>& text) {
-    std::vector<Selection> adjusted;
-    adjusted.reserve(selections.count());
-    for (const Selection& selection : selections) {
-      DocumentIterator iterator = at(selection.extent());
-      if (iterator != end()) {
-        ++iterator;
-      }
-      
-      adjusted.emplace_back(iterator.location());
+    if (text.size() == 0) {
+      return selections;
     }
     
-    SelectionSet result(adjusted);
-    insert(result, text);
-    return result;
+    return append(selections, text.data(), 1);
   }
   
   SelectionSet Document::erase(const Selection& selection) {
@@ -284,6 +280,9 @@ namespace quip {
   }
   
   SelectionSet Document::erase(const SelectionSet& selections) {
+    TraceSpan span("Document::erase");
+    MemoryScope scope(MemoryCategory::Document);
+    
     if (m_rows.size() == 0 || selections.count() == 0) {
       return selections;
     }
@@ -306,14 +305,14 @@ namespace quip {
       bool hasLastCharacterInRow = extent.column() == row(extent.row()).size() - 1;
       bool hasLastRowInDocument = extent.row() == m_rows.size() - 1;
       
-      // Determine how many rows to remove and how to compose the resulting text.
-      std::string prefix = m_rows[origin.row()].substr(0, origin.column());
-      std::string suffix;
+      // Determine how many rows to remove and where the text following the erased region
+      // begins.
+      Location end;
       if (hasLastCharacterInRow && !hasLastRowInDocument) {
-        suffix = m_rows[extent.row() + 1];
+        end = Location(0, extent.row() + 1);
         ++rowsToRemove;
       } else {
-        suffix = m_rows[extent.row()].substr(extent.column() + 1);
+        end = Location(extent.column() + 1, extent.row());
       }
 
       // Update shifts to track how this selection impacts any subsequent selections.
@@ -339,11 +338,21 @@ namespace quip {
         }
       }
       
-      // Remove rows and write composed text.
-      std::vector<std::string>::iterator firstRemovedRow = m_rows.begin() + origin.row();
-      std::vector<std::string>::iterator lastRemovedRow = firstRemovedRow + rowsToRemove;
-      m_rows.erase(firstRemovedRow, lastRemovedRow);
-      m_rows[origin.row()] = prefix + suffix;
+      // Compose the resulting text in the origin row, then remove the rest.
+      std::string& composed = m_rows[origin.row()];
+      if (end.row() == origin.row()) {
+        composed.erase(origin.column(), end.column() - origin.column());
+      } else {
+        composed.erase(origin.column());
+        composed.append(m_rows[end.row()], end.column(), std::string::npos);
+        
+        std::vector<std::string>::iterator firstRemovedRow = m_rows.begin() + origin.row() + 1;
+        std::vector<std::string>::iterator lastRemovedRow = firstRemovedRow + rowsToRemove;
+        m_rows.erase(firstRemovedRow, lastRemovedRow);
+      }
+      
+      rowsReplaced(origin.row(), rowsToRemove + 1, 1);
+      m_markers.replace(origin, end, origin);
       
       // Erase operations collapse selections to the origin, generally. However, it's
       // possible that the origin no longer exists.
@@ -364,13 +373,24 @@ namespace quip {
     // a default-constructed, empty document.
     if (m_rows.size() == 1 && m_rows.back().size() == 0) {
       m_rows.clear();
+      rowsReplaced(0, 1, 0);
     }
     
     m_documentModifiedSignal.transmit();
-    return SelectionSet(updated);
+    return SelectionSet(std::move(updated));
   }
   
   SelectionSet Document::matches(const SearchExpression& expression) const {
+    TraceSpan span("Document::matches");
+    
+    // Only scan the chunks of rows that the trigram index can't rule out.
+    if (expression.valid() && m_trigrams.isEnabled()) {
+      std::vector<std::uint32_t> trigrams = TrigramIndex::requiredTrigrams(expression.expression());
+      if (!trigrams.empty()) {
+        return matchesInRows(expression, m_trigrams.candidateRows(trigrams));
+      }
+    }
+    
     std::vector<Selection> results;
     if (expression.valid()) {
       std::string content;
@@ -399,33 +419,300 @@ namespace quip {
       }
     }
     
-    return SelectionSet(results);
+    return SelectionSet(std::move(results));
+  }
+  
+  SelectionSet Document::matches(const SearchExpression& expression, const SelectionSet& within) const {
+    TraceSpan span("Document::matches");
+    
+    std::vector<Selection> results;
+    if (!expression.valid() || m_rows.empty()) {
+      return SelectionSet(std::move(results));
+    }
+    
+    std::vector<std::size_t> rowEnds;
+    for (const Selection& selection : within) {
+      Location origin = selection.origin();
+      Location extent = selection.extent();
+      std::string content = contents(selection);
+      
+      // The offsets (within the content) at which each of the selection's rows end.
+      rowEnds.clear();
+      std::size_t length = 0;
+      for (std::uint64_t row = origin.row(); row <= extent.row(); ++row) {
+        length += row == extent.row() ? extent.column() + 1 : m_rows[row].size();
+        length -= row == origin.row() ? origin.column() : 0;
+        rowEnds.emplace_back(length);
+      }
+      
+      std::regex_constants::match_flag_type flags = std::regex_constants::match_not_null;
+      if (origin.column() > 0) {
+        flags |= std::regex_constants::match_not_bol;
+      }
+      
+      if (extent.column() + 1 < m_rows[extent.row()].size()) {
+        flags |= std::regex_constants::match_not_eol;
+      }
+      
+      std::sregex_iterator cursor(content.begin(), content.end(), expression.pattern(), flags);
+      std::sregex_iterator end;
+      while (cursor != end) {
+        if (cursor->length() == 0) {
+          // As above, an empty match is only produced by the libc++ bug.
+          break;
+        }
+        
+        std::size_t first = cursor->position();
+        std::size_t last = first + cursor->length() - 1;
+        results.emplace_back(locationInSelection(origin, rowEnds, first), locationInSelection(origin, rowEnds, last));
+        ++cursor;
+      }
+    }
+    
+    return SelectionSet(std::move(results));
+  }
+  
+  std::uint32_t Document::createMarker(const Location& location) {
+    return m_markers.create(location);
+  }
+  
+  void Document::removeMarker(std::uint32_t marker) {
+    m_markers.remove(marker);
+  }
+  
+  Location Document::markerLocation(std::uint32_t marker) const {
+    return m_markers.location(marker);
+  }
+  
+  const BracketIndex& Document::brackets() const {
+    return m_brackets;
+  }
+  
+  const WordIndex& Document::words() const {
+    return m_words;
+  }
+  
+  TrigramIndex& Document::trigrams() {
+    return m_trigrams;
+  }
+  
+  const TrigramIndex& Document::trigrams() const {
+    return m_trigrams;
   }
   
   Signal<void()>& Document::onDocumentModified() {
     return m_documentModifiedSignal;
   }
   
-  std::vector<std::string> Document::decompose(const std::string& text) const {
-    std::vector<std::string> results;
-    if (text.size() == 0) {
-      return results;
+  std::size_t Document::memoryUsage() const {
+    return quip::memoryUsage(m_rows) + quip::memoryUsage(m_path) + m_trigrams.memoryUsage();
+  }
+  
+  LuaBinding Document::binding() {
+    LuaBinding result;
+    result.addProperty("path", &Document::path);
+    result.addProperty("rows", &Document::rows);
+    result.addFunction("view", &viewRow);
+    result.addFunction("chunk", &viewChunk);
+    result.addFunction("text", &copyText);
+    result.addFunction("indexTrigrams", &indexTrigrams);
+    
+    return result;
+  }
+  
+  SelectionSet Document::insert(const SelectionSet& selections, const std::string* text, std::size_t stride) {
+    TraceSpan span("Document::insert");
+    MemoryScope scope(MemoryCategory::Document);
+    
+    if (selections.count() == 0) {
+      return selections;
+    }
+    
+    // The updated selection set cannot be larger than the initial selection set, so storage
+    // can be reserved up front.
+    std::vector<Selection> updated;
+    updated.reserve(selections.count());
+    
+    // When every selection receives the same text (a stride of zero), it only needs to be
+    // decomposed once. Otherwise the lines are decomposed into the same storage each time.
+    std::vector<std::string> lines;
+    if (stride == 0) {
+      decompose(*text, lines);
+    }
+    
+    std::int64_t columnShift = 0;
+    std::int64_t rowShift = 0;
+    for (std::uint64_t index = 0; index < selections.count(); ++index) {
+      if (stride != 0) {
+        decompose(text[index * stride], lines);
+      }
+      
+      if (lines.size() == 0) {
+        continue;
+      }
+      
+      if (m_rows.size() == 0) {
+        // If the document is empty, just copy the entire lines array in and break the loop.
+        // The selection set is basically irrelevant; the only legal set for an empty document
+        // consists entirely of the single-character selection at (0, 0).
+        m_rows = lines;
+        rowsReplaced(0, 0, m_rows.size());
+        updated.emplace_back(Location(m_rows.back().size(), m_rows.size() - 1));
+        m_markers.replace(Location(0, 0), Location(0, 0), updated.back().origin());
+        break;
+      }
+      
+      const Selection& selection = selections[index];
+      Location origin = selection.origin().adjustBy(columnShift, rowShift);
+      std::size_t suffixSize = m_rows[origin.row()].size() - origin.column();
+      std::uint64_t rowsToInsert = lines.size() - 1;
+      if (lines.back().back() == '\n') {
+        ++rowsToInsert;
+      }
+      
+      // Compose resulting text, inserting rows as needed. Text that stays on a single row is
+      // spliced into that row in place.
+      if (rowsToInsert == 0) {
+        m_rows[origin.row()].insert(origin.column(), lines.front());
+      } else {
+        std::string suffix = m_rows[origin.row()].substr(origin.column());
+        m_rows[origin.row()].replace(origin.column(), std::string::npos, lines.front());
+        m_rows.insert(m_rows.begin() + origin.row() + 1, rowsToInsert, std::string());
+        for (std::uint64_t line = 1; line <= lines.size() - 1; ++line) {
+          m_rows[origin.row() + line] = lines[line];
+        }
+        
+        m_rows[origin.row() + rowsToInsert] += suffix;
+      }
+      
+      rowsReplaced(origin.row(), 1, rowsToInsert + 1);
+      
+      // Update shifts to track how this selection impacts any subsequent selections.
+      columnShift += lines.front().size();
+      rowShift += rowsToInsert;
+      if (index + 1 < selections.count()) {
+        const Selection& next = selections[index + 1];
+        if (selection.extent().row() != next.origin().row()) {
+          // Whether or not adjacent selections have the same line in common impacts how
+          // to shift the next selection.
+          columnShift = 0;
+        }
+      }
+      
+      // Insert operations displace selections such that the origin remains after the
+      // text that was inserted.
+      if (rowsToInsert == 0) {
+        updated.emplace_back(Location(origin.column() + lines.front().size(), origin.row()));
+      } else {
+        std::uint64_t row = origin.row() + rowsToInsert;
+        updated.emplace_back(Location(m_rows[row].size() - suffixSize, row));
+      }
+      
+      m_markers.replace(origin, origin, updated.back().origin());
+    }
+    
+    m_documentModifiedSignal.transmit();
+    return SelectionSet(std::move(updated));
+  }
+  
+  SelectionSet Document::append(const SelectionSet& selections, const std::string* text, std::size_t stride) {
+    TraceSpan span("Document::append");
+    MemoryScope scope(MemoryCategory::Document);
+    
+    std::vector<Selection> adjusted;
+    adjusted.reserve(selections.count());
+    for (const Selection& selection : selections) {
+      DocumentIterator iterator = at(selection.extent());
+      if (iterator != end()) {
+        ++iterator;
+      }
+      
+      adjusted.emplace_back(iterator.location());
     }
     
+    SelectionSet result(std::move(adjusted));
+    insert(result, text, stride);
+    return result;
+  }
+  
+  std::vector<std::string> Document::decompose(const std::string& text) const {
+    std::vector<std::string> results;
+    decompose(text, results);
+    return results;
+  }
+  
+  void Document::decompose(const std::string& text, std::vector<std::string>& results) const {
+    // Existing strings in the results are assigned rather than replaced so their storage can
+    // be reused.
+    std::size_t count = 0;
     std::string::size_type start = 0;
     std::string::size_type end = 0;
     while (start < text.size()) {
+      if (count == results.size()) {
+        results.emplace_back();
+      }
+      
       end = text.find_first_of('\n', start);
       if (end != std::string::npos) {
-        results.emplace_back(text.substr(start, end - start + 1));
+        results[count++].assign(text, start, end - start + 1);
         start = end + 1;
       } else {
-        results.emplace_back(text.substr(start));
+        results[count++].assign(text, start, std::string::npos);
         break;
       }
     }
     
-    return results;
+    results.resize(count);
+  }
+  
+  void Document::rowsReplaced(std::size_t row, std::size_t removed, std::size_t inserted) {
+    // Keep the document's indices consistent with the rows that were just rewritten.
+    ++m_revision;
+    m_brackets.replaceRows(row, removed, m_rows, inserted);
+    m_words.replaceRows(row, removed, inserted);
+    m_trigrams.replaceRows(row, removed, inserted);
+  }
+  
+  SelectionSet Document::matchesInRows(const SearchExpression& expression, const std::vector<TrigramIndex::RowRange>& ranges) const {
+    // The index only narrows expressions whose matches lie within single rows, so each range can
+    // be scanned independently. Assertions only treat the ends of the document as the ends of
+    // the text, as a full scan does.
+    std::vector<Selection> results;
+    std::vector<std::size_t> rowEnds;
+    for (const TrigramIndex::RowRange& range : ranges) {
+      std::string content;
+      rowEnds.clear();
+      for (std::size_t row = range.first; row < range.second; ++row) {
+        content += m_rows[row];
+        rowEnds.emplace_back(content.size());
+      }
+      
+      std::regex_constants::match_flag_type flags = std::regex_constants::match_not_null;
+      if (range.first > 0) {
+        flags |= std::regex_constants::match_not_bol;
+      }
+      
+      if (range.second < m_rows.size()) {
+        flags |= std::regex_constants::match_not_eol;
+      }
+      
+      Location origin(0, range.first);
+      std::sregex_iterator cursor(content.begin(), content.end(), expression.pattern(), flags);
+      std::sregex_iterator end;
+      while (cursor != end) {
+        if (cursor->length() == 0) {
+          // As in a full scan, an empty match is only produced by the libc++ bug.
+          break;
+        }
+        
+        std::size_t first = cursor->position();
+        std::size_t last = first + cursor->length() - 1;
+        results.emplace_back(locationInSelection(origin, rowEnds, first), locationInSelection(origin, rowEnds, last));
+        ++cursor;
+      }
+    }
+    
+    return SelectionSet(std::move(results));
   }
   
   std::vector<std::size_t> Document::buildSpanTable(std::string * contents) const {
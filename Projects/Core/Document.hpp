@@ -1,13 +1,19 @@
 #pragma once
 
+#include "BracketIndex.hpp"
 #include "Location.hpp"
+#include "MarkerSet.hpp"
 #include "Signal.hpp"
+#include "TrigramIndex.hpp"
+#include "WordIndex.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace quip {
   struct DocumentIterator;
+  struct LuaBinding;
   struct ReverseDocumentIterator;
   struct SearchExpression;
   struct Selection;
@@ -19,6 +25,13 @@ namespace quip {
     
     bool isEmpty() const noexcept;
     bool isMissingTrailingNewline() const noexcept;
+    
+    // Get a counter that changes whenever the document's text is modified.
+    std::uint64_t revision() const noexcept;
+    
+    // Get a handle that expires when the document is destroyed, so that objects which refer to the
+    // document but may outlive it (such as text views held by scripts) can tell that it is gone.
+    std::weak_ptr<const void> lifetime() const;
         
     std::string contents() const;
     std::string contents(const Selection& selection) const;
@@ -36,6 +49,11 @@ namespace quip {
     
     std::int64_t distance(const Location& from, const Location& to) const;
     
+    // Get the nearest location (or selection) within the document, for coordinates that come from
+    // outside the editor, such as from scripts.
+    Location clamp(const Location& location) const;
+    Selection clamp(const Selection& selection) const;
+    
     const std::string& path() const;
     void setPath(const std::string& path);
 
@@ -56,16 +74,53 @@ namespace quip {
     SelectionSet erase(const SelectionSet& selections);
     
     SelectionSet matches(const SearchExpression& expression) const;
+    
+    // Get the matches within the text covered by the selections, which is the only text scanned.
+    // Matches do not span selections, and assertions treat the bounds of each selection as the
+    // bounds of the text only where they are also the bounds of a row.
+    SelectionSet matches(const SearchExpression& expression, const SelectionSet& within) const;
+    
+    std::uint32_t createMarker(const Location& location);
+    void removeMarker(std::uint32_t marker);
+    Location markerLocation(std::uint32_t marker) const;
+    
+    const BracketIndex& brackets() const;
+    const WordIndex& words() const;
+    
+    // The trigram index narrows searches when enabled, which is worthwhile for large documents
+    // that are searched repeatedly.
+    TrigramIndex& trigrams();
+    const TrigramIndex& trigrams() const;
         
     Signal<void()>& onDocumentModified();
     
+    // Estimate the heap memory held by the document's text.
+    std::size_t memoryUsage() const;
+    
+    static LuaBinding binding();
+    
   private:
     std::string m_path;    
     std::vector<std::string> m_rows;
+    std::uint64_t m_revision;
+    std::shared_ptr<const void> m_lifetime;
+    
+    BracketIndex m_brackets;
+    WordIndex m_words;
+    TrigramIndex m_trigrams;
+    MarkerSet m_markers;
     
     Signal<void()> m_documentModifiedSignal;
     
+    SelectionSet insert(const SelectionSet& selections, const std::string* text, std::size_t stride);
+    SelectionSet append(const SelectionSet& selections, const std::string* text, std::size_t stride);
+    
     std::vector<std::string> decompose(const std::string& text) const;
+    void decompose(const std::string& text, std::vector<std::string>& results) const;
+    
+    void rowsReplaced(std::size_t row, std::size_t removed, std::size_t inserted);
+    
+    SelectionSet matchesInRows(const SearchExpression& expression, const std::vector<TrigramIndex::RowRange>& ranges) const;
     
     std::vector<std::size_t> buildSpanTable(std::string* contents) const;
     Location linearPositionToLocation(const std::vector<std::size_t>& spanTable, std::size_t position) const;
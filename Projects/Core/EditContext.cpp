@@ -1,37 +1,125 @@
 #include "EditContext.hpp"
 
+#include "AppendTransaction.hpp"
 #include "Document.hpp"
 #include "EditMode.hpp"
+#include "EraseTransaction.hpp"
+#include "InsertTransaction.hpp"
 #include "JumpMode.hpp"
+#include "KeystrokeLatency.hpp"
 #include "Location.hpp"
+#include "LuaBinding.hpp"
+#include "MemoryAccounting.hpp"
 #include "Mode.hpp"
 #include "NormalMode.hpp"
+#include "ScriptHost.hpp"
 #include "SearchMode.hpp"
 #include "Selection.hpp"
+#include "Trace.hpp"
 #include "Transaction.hpp"
 
+#include <chrono>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace quip {
+  namespace {
+    // Clear a flag for the lifetime of the guard, restoring its previous value afterwards.
+    struct FlagPause {
+      explicit FlagPause(bool& flag)
+      : m_flag(flag)
+      , m_value(flag) {
+        m_flag = false;
+      }
+      
+      FlagPause(const FlagPause&) = delete;
+      FlagPause& operator=(const FlagPause&) = delete;
+      
+      ~FlagPause() {
+        m_flag = m_value;
+      }
+      
+    private:
+      bool& m_flag;
+      bool m_value;
+    };
+    
+    SelectionSet getSelections(const EditContext& context) {
+      return context.selections();
+    }
+    
+    void setSelections(EditContext& context, const SelectionSet& selections) {
+      // The context always has at least one selection, and scripts may assign any coordinates.
+      if (selections.count() == 0) {
+        return;
+      }
+      
+      std::vector<Selection> clamped;
+      clamped.reserve(selections.count());
+      for (const Selection& selection : selections) {
+        clamped.emplace_back(context.document().clamp(selection));
+      }
+      
+      // Clamping may merge selections, so find the primary selection again afterwards.
+      Selection primary = context.document().clamp(selections.primary());
+      SelectionSet result(std::move(clamped));
+      for (std::size_t rotation = 0; rotation < result.count() && !(result.primary().origin() <= primary.origin() && primary.origin() <= result.primary().extent()); ++rotation) {
+        result.rotateForward();
+      }
+      
+      context.selections().replace(result);
+    }
+    
+    void insertText(EditContext& context, const std::string& text) {
+      context.performTransaction(InsertTransaction::create(context.selections(), text));
+    }
+    
+    void appendText(EditContext& context, const std::string& text) {
+      context.performTransaction(AppendTransaction::create(context.selections(), text));
+    }
+    
+    // Per-selection text must match the selections one to one; the transaction is not performed
+    // otherwise.
+    bool insertEachText(EditContext& context, const std::vector<std::string>& text) {
+      if (text.size() != context.selections().count()) {
+        return false;
+      }
+      
+      context.performTransaction(InsertTransaction::create(context.selections(), text));
+      return true;
+    }
+    
+    bool appendEachText(EditContext& context, const std::vector<std::string>& text) {
+      if (text.size() != context.selections().count()) {
+        return false;
+      }
+      
+      context.performTransaction(AppendTransaction::create(context.selections(), text));
+      return true;
+    }
+    
+    void eraseText(EditContext& context) {
+      context.performTransaction(EraseTransaction::create(context.selections()));
+    }
+    
+    void enterNamedMode(EditContext& context, const std::string& name) {
+      context.enterMode(name);
+    }
+  }
+
   EditContext::EditContext(PopupService* popupService, StatusService* statusService, ScriptHost* scriptHost)
   : EditContext(popupService, statusService, scriptHost, std::make_shared<Document>()) {
   }
   
   EditContext::EditContext(PopupService* popupService, StatusService* statusService, ScriptHost* scriptHost, std::shared_ptr<Document> document)
   : m_document(document)
-  , m_fileTypeDatabase(*scriptHost) 
+  , m_fileTypeDatabase(FileTypeDatabase::standard(scriptHost->scriptRootPath()))
   , m_selections(Selection(Location(0, 0)))
   , m_popupService(popupService)
-  , m_statusService(statusService) {
-    
-    // Populate with standard file types.
-    m_fileTypeDatabase.registerFileType("Text", "text", {"txt", "text"});
-    m_fileTypeDatabase.registerFileType("Markdown", "markdown", {"md", "markdown"});
-    m_fileTypeDatabase.registerFileType("C++ Source", "cpp", {"cpp", "cxx"});
-    m_fileTypeDatabase.registerFileType("C++ Header", "cpp", {"hpp", "hxx"});
-    m_fileTypeDatabase.registerFileType("C Source", "cpp", {"c"});
-    m_fileTypeDatabase.registerFileType("C/C++ Header", "cpp", {"h"});
-    m_fileTypeDatabase.registerFileType("GLSL Shader Source", "glsl", {"fsh", "vsh"});
+  , m_statusService(statusService)
+  , m_scriptHost(scriptHost)
+  , m_isRecording(false) {
     
     // Populate with standard modes.
     m_modes.insert(std::make_pair("EditMode", std::make_shared<EditMode>()));
@@ -40,6 +128,18 @@ namespace quip {
     m_modes.insert(std::make_pair("SearchMode", std::make_shared<SearchMode>()));
     
     enterMode("NormalMode");
+    activate();
+  }
+  
+  EditContext::~EditContext() {
+    if (m_scriptHost->unbind("context", this)) {
+      m_scriptHost->unbind("document", m_document.get());
+    }
+  }
+  
+  void EditContext::activate() {
+    m_scriptHost->bind(this, "context");
+    m_scriptHost->bind(m_document.get(), "document");
   }
   
   Document& EditContext::document() {
@@ -50,6 +150,10 @@ namespace quip {
     return m_selections;
   }
   
+  const SelectionSet& EditContext::selections() const {
+    return m_selections;
+  }
+  
   Mode& EditContext::mode() {
     return *m_modeHistory.top();
   }
@@ -59,6 +163,7 @@ namespace quip {
   }
   
   void EditContext::setOverlay(const std::string& name, const SelectionDrawInfo& overlay) {
+    MemoryScope scope(MemoryCategory::Overlays);
     m_overlays[name] = overlay;
   }
   
@@ -91,7 +196,9 @@ namespace quip {
   void EditContext::performTransaction(std::shared_ptr<Transaction> transaction) {
     transaction->perform(*this);
     m_onTransactionApplied.transmit(ChangeType::Do);
-    m_undoStack.push(transaction);
+    
+    MemoryScope scope(MemoryCategory::UndoHistory);
+    m_undoStack.push_back(transaction);
   }
   
   bool EditContext::canUndo() const noexcept {
@@ -100,11 +207,12 @@ namespace quip {
   
   void EditContext::undo() {
     if (canUndo()) {
-      m_undoStack.top()->rollback(*this);
+      m_undoStack.back()->rollback(*this);
       m_onTransactionApplied.transmit(ChangeType::Undo);
-      m_redoStack.push(m_undoStack.top());
       
-      m_undoStack.pop();
+      MemoryScope scope(MemoryCategory::UndoHistory);
+      m_redoStack.push_back(m_undoStack.back());
+      m_undoStack.pop_back();
     }
   }
   
@@ -114,20 +222,104 @@ namespace quip {
   
   void EditContext::redo() {
     if (canRedo()) {
-      m_redoStack.top()->perform(*this);
+      m_redoStack.back()->perform(*this);
       m_onTransactionApplied.transmit(ChangeType::Redo);
-      m_undoStack.push(m_redoStack.top());
-
-      m_redoStack.pop();
+      
+      MemoryScope scope(MemoryCategory::UndoHistory);
+      m_undoStack.push_back(m_redoStack.back());
+      m_redoStack.pop_back();
+    }
+  }
+  
+  MemoryReport EditContext::memoryReport() const {
+    MemoryReport result;
+    result[MemoryCategory::Document].liveBytes = m_document->memoryUsage();
+    result[MemoryCategory::Selections].liveBytes = m_selections.memoryUsage();
+    result[MemoryCategory::Scripting].liveBytes = m_scriptHost->memoryUsage();
+    
+    std::size_t history = (m_undoStack.capacity() + m_redoStack.capacity()) * sizeof(std::shared_ptr<Transaction>);
+    for (const std::shared_ptr<Transaction>& transaction : m_undoStack) {
+      history += transaction->memoryUsage();
+    }
+    
+    for (const std::shared_ptr<Transaction>& transaction : m_redoStack) {
+      history += transaction->memoryUsage();
     }
+    
+    result[MemoryCategory::UndoHistory].liveBytes = history;
+    
+    // Each overlay is a node of the map.
+    std::size_t overlays = 0;
+    for (const std::pair<const std::string, SelectionDrawInfo>& overlay : m_overlays) {
+      overlays += sizeof(overlay) + memoryUsage(overlay.first) + overlay.second.selections.memoryUsage();
+    }
+    
+    result[MemoryCategory::Overlays].liveBytes = overlays;
+    return result;
   }
   
   bool EditContext::processKeyEvent(Key key, Modifiers modifiers) {
-    return mode().processKeyEvent(key, modifiers, *this);
+    TraceSpan span("EditContext::processKeyEvent");
+    KeystrokeLatency::Clock::time_point start = KeystrokeLatency::Clock::now();
+    
+    // The mode may change while the event is processed; the latency is attributed to the mode
+    // that received it.
+    Mode& current = mode();
+    bool result = current.processKeyEvent(key, modifiers, *this);
+    recordLatency(current, start);
+    return result;
   }
   
   bool EditContext::processKeyEvent(Key key, Modifiers modifiers, const std::string& text) {
-    return mode().processKeyEvent(key, modifiers, text, *this);
+    TraceSpan span("EditContext::processKeyEvent");
+    KeystrokeLatency::Clock::time_point start = KeystrokeLatency::Clock::now();
+    
+    if (m_isRecording) {
+      m_recording.append(KeyEvent { key, modifiers, text });
+    }
+    
+    Mode& current = mode();
+    bool result = current.processKeyEvent(key, modifiers, text, *this);
+    recordLatency(current, start);
+    return result;
+  }
+  
+  void EditContext::startRecording() {
+    m_recording = Macro();
+    m_isRecording = true;
+  }
+  
+  Macro EditContext::stopRecording() {
+    m_isRecording = false;
+    
+    Macro result;
+    std::swap(result, m_recording);
+    return result;
+  }
+  
+  bool EditContext::isRecording() const {
+    return m_isRecording;
+  }
+  
+  void EditContext::replay(const Macro& macro) {
+    // Replayed events are not recorded again. The guards restore the recording state and end the
+    // suppression of signals even if a command throws.
+    FlagPause recording(m_isRecording);
+    ScrollBatch scrolls(*this);
+    Signal<void ()>& documentModified = m_document->onDocumentModified();
+    SignalBlock<Signal<void ()>> modifications(documentModified);
+    
+    KeyEvent event;
+    std::size_t offset = 0;
+    while (macro.read(offset, event)) {
+      mode().processKeyEvent(event.key, event.modifiers, event.text, *this);
+    }
+    
+    if (modifications.release() > 0) {
+      documentModified.transmit();
+    }
+    
+    scrolls.finish();
   }
   
   ViewController& EditContext::controller() {
@@ -143,10 +335,54 @@ namespace quip {
   }
   
   const FileTypeDatabase& EditContext::fileTypeDatabase() const {
-    return m_fileTypeDatabase;
+    return *m_fileTypeDatabase;
   }
   
   Signal<void (ChangeType)>& EditContext::onTransactionApplied() {
     return m_onTransactionApplied;
   }
+  
+  LuaBinding EditContext::binding() {
+    LuaBinding result;
+    result.addProperty("selections", &getSelections, &setSelections);
+    result.addFunction("insert", &insertText);
+    result.addFunction("append", &appendText);
+    result.addFunction("insertEach", &insertEachText);
+    result.addFunction("appendEach", &appendEachText);
+    result.addFunction("erase", &eraseText);
+    result.addFunction("undo", &EditContext::undo);
+    result.addFunction("redo", &EditContext::redo);
+    result.addFunction("enterMode", &enterNamedMode);
+    result.addFunction("leaveMode", &EditContext::leaveMode);
+    
+    return result;
+  }
+  
+  void EditContext::recordLatency(const Mode& mode, KeystrokeLatency::Clock::time_point start) {
+    std::uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(KeystrokeLatency::Clock::now() - start).count();
+    for (const std::pair<const std::string, std::shared_ptr<Mode>>& entry : m_modes) {
+      if (entry.second.get() == &mode) {
+        KeystrokeLatency::shared().record(entry.first, mode.command(), nanoseconds);
+        return;
+      }
+    }
+  }
+  
+  ScrollBatch::ScrollBatch(EditContext& context)
+  : m_context(context)
+  , m_scrolls(context.controller().scrollToLocation)
+  , m_reveals(context.controller().scrollLocationIntoView) {
+  }
+  
+  void ScrollBatch::finish() {
+    std::size_t scrolls = m_scrolls.release();
+    std::size_t reveals = m_reveals.release();
+    
+    Location extent = m_context.selections().primary().extent();
+    if (scrolls > 0) {
+      m_context.controller().scrollToLocation.transmit(extent);
+    } else if (reveals > 0) {
+      m_context.controller().scrollLocationIntoView.transmit(extent);
+    }
+  }
 }
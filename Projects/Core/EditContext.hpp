@@ -3,6 +3,9 @@
 #include "ChangeType.hpp"
 #include "FileTypeDatabase.hpp"
 #include "Key.hpp"
+#include "KeystrokeLatency.hpp"
+#include "Macro.hpp"
+#include "MemoryAccounting.hpp"
 #include "Modifiers.hpp"
 #include "PopupService.hpp"
 #include "SelectionDrawInfo.hpp"
@@ -15,9 +18,11 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <vector>
 
 namespace quip {
   struct Document;
+  struct LuaBinding;
   struct Mode;
   struct ScriptHost;
   struct Transaction;
@@ -25,9 +30,15 @@ namespace quip {
   struct EditContext {
     EditContext(PopupService* popupService, StatusService* statusService, ScriptHost* scriptHost);
     EditContext(PopupService* popupService, StatusService* statusService, ScriptHost* scriptHost, std::shared_ptr<Document> document);
+    ~EditContext ();
+    
+    // Bind this context and its document to scripts as quip.context and quip.document. A context
+    // activates itself when it is created; if it is still active when destroyed, it unbinds both.
+    void activate ();
     
     Document & document ();
     SelectionSet & selections ();
+    const SelectionSet & selections () const;
     Mode & mode ();
 
     const std::map<std::string, SelectionDrawInfo> & overlays () const;
@@ -44,10 +55,24 @@ namespace quip {
     void undo ();
     bool canRedo () const noexcept;
     void redo ();
+    
+    // Get the memory held by this context (and its document), and the allocations made by each
+    // subsystem.
+    MemoryReport memoryReport () const;
 
     bool processKeyEvent(Key key, Modifiers modifiers);
     bool processKeyEvent(Key key, Modifiers modifiers, const std::string& text);
     
+    // Record the key events (with text) processed until recording is stopped.
+    void startRecording ();
+    Macro stopRecording ();
+    bool isRecording () const;
+    
+    // Process the key events of a macro. Scroll and document modification signals are suppressed
+    // while the macro is replayed, and each is transmitted at most once afterwards. Transactions
+    // are still reported as they are applied, so observers counting changes stay in step.
+    void replay (const Macro & macro);
+    
     ViewController & controller ();
     PopupService & popupService ();
     StatusService & statusService ();
@@ -56,9 +81,11 @@ namespace quip {
     
     Signal<void (ChangeType)> & onTransactionApplied ();
     
+    static LuaBinding binding ();
+    
   private:
     std::shared_ptr<Document> m_document;
-    FileTypeDatabase m_fileTypeDatabase;
+    std::shared_ptr<const FileTypeDatabase> m_fileTypeDatabase;
     
     SelectionSet m_selections;
     std::map<std::string, SelectionDrawInfo> m_overlays;
@@ -66,13 +93,34 @@ namespace quip {
     std::map<std::string, std::shared_ptr<Mode>> m_modes;
     std::stack<std::shared_ptr<Mode>> m_modeHistory;
     
-    std::stack<std::shared_ptr<Transaction>> m_undoStack;
-    std::stack<std::shared_ptr<Transaction>> m_redoStack;
+    std::vector<std::shared_ptr<Transaction>> m_undoStack;
+    std::vector<std::shared_ptr<Transaction>> m_redoStack;
     
     ViewController m_controller;
     PopupService* m_popupService;
     StatusService* m_statusService;
+    ScriptHost* m_scriptHost;
     
     Signal<void (ChangeType)> m_onTransactionApplied;
+    
+    bool m_isRecording;
+    Macro m_recording;
+    
+    void recordLatency (const Mode & mode, KeystrokeLatency::Clock::time_point start);
+  };
+  
+  // Suppress the scroll signals of a context's controller while a batch of commands runs. Finishing
+  // the batch transmits at most one scroll (to the primary selection's extent) in place of those
+  // suppressed; a batch that is destroyed without finishing, such as by an exception, only ends the
+  // suppression.
+  struct ScrollBatch {
+    explicit ScrollBatch (EditContext & context);
+    
+    void finish ();
+    
+  private:
+    EditContext & m_context;
+    SignalBlock<Signal<void (Location)>> m_scrolls;
+    SignalBlock<Signal<void (Location)>> m_reveals;
   };
 }
@@ -7,53 +7,9 @@
 #include "InsertTransaction.hpp"
 
 namespace quip {
-  namespace {
-    void backspace(EditContext& context, bool isAppending) {
-      // Functionally, this is equivalent to erasing a selection that starts just before each
-      // actual selection in the set. If appending, it's equivalent to erasing the selection
-      // collapsed to its origin.
-      std::vector<Selection> adjusted;
-      std::vector<Selection> replacement;
-      adjusted.reserve(context.selections().count());
-      
-      std::size_t bias = isAppending ? 0 : 1;
-      for (const Selection& selection : context.selections()) {
-        Location origin = selection.origin();
-        if (isAppending) {
-          adjusted.emplace_back(Selection(origin));
-        }
-        else if (origin.column() == 0) {
-          if (origin.row() == 0) {
-            continue;
-          }
-          
-          origin = Location(context.document().row(origin.row() - 1).length() - 1, origin.row() - 1);
-        }
-        else {
-          origin = origin.adjustBy(-bias, 0);
-        }
-        
-        adjusted.emplace_back(Selection(origin));
-        
-        Location replacementLocation = origin;
-        if (isAppending) {
-          replacementLocation = replacementLocation.adjustBy(-1, 0);
-        }
-        
-        replacement.emplace_back(Selection(replacementLocation));
-      }
-      
-      SelectionSet set(adjusted);
-      if (set.count() > 0) {
-        context.document().erase(set);
-        context.selections().replace(SelectionSet(replacement));
-      }
-    }
-  }
-  
   EditMode::EditMode()
   : m_useAppendBehavior(false) {
-    addMapping(Key::Escape, &EditMode::commitInsert);
+    addMapping(Key::Escape, "<Esc>", &EditMode::commitInsert);
   }
   
   CursorStyle EditMode::cursorStyle() const {
@@ -95,7 +51,7 @@ namespace quip {
         }
         return true;
       case Key::Delete:
-        backspace(context, m_useAppendBehavior);
+        backspace(context);
         return true;
       case Key::ArrowUp:
       case Key::ArrowDown:
@@ -105,9 +61,10 @@ namespace quip {
       default:
         if (text.size() > 0) {
           if (key == Key::Return) {
-            std::vector<std::string> indented(context.selections().count(), text);
-            for (std::uint32_t index = 0; index < context.selections().count(); ++index) {
-              const Selection& selection = context.selections()[index];
+            const SelectionSet& selections = context.selections();
+            std::vector<std::string> indented(selections.count(), text);
+            for (std::uint32_t index = 0; index < selections.count(); ++index) {
+              const Selection& selection = selections[index];
               std::string indent = document.isEmpty() ? "" : document.indentOfRow(selection.extent().row());
               indented[index] += indent;
             }
@@ -133,6 +90,50 @@ namespace quip {
     return false;
   }
   
+  void EditMode::backspace(EditContext& context) {
+    // Functionally, this is equivalent to erasing a selection that starts just before each
+    // actual selection in the set. If appending, it's equivalent to erasing the selection
+    // collapsed to its origin. The working storage is kept between keystrokes.
+    const SelectionSet& selections = context.selections();
+    m_adjusted.clear();
+    m_replacement.clear();
+    m_adjusted.reserve(selections.count());
+    m_replacement.reserve(selections.count());
+    
+    std::size_t bias = m_useAppendBehavior ? 0 : 1;
+    for (const Selection& selection : selections) {
+      Location origin = selection.origin();
+      if (m_useAppendBehavior) {
+        m_adjusted.emplace_back(Selection(origin));
+      }
+      else if (origin.column() == 0) {
+        if (origin.row() == 0) {
+          continue;
+        }
+        
+        origin = Location(context.document().row(origin.row() - 1).length() - 1, origin.row() - 1);
+      }
+      else {
+        origin = origin.adjustBy(-bias, 0);
+      }
+      
+      m_adjusted.emplace_back(Selection(origin));
+      
+      Location replacementLocation = origin;
+      if (m_useAppendBehavior) {
+        replacementLocation = replacementLocation.adjustBy(-1, 0);
+      }
+      
+      m_replacement.emplace_back(Selection(replacementLocation));
+    }
+    
+    SelectionSet set(m_adjusted);
+    if (set.count() > 0) {
+      context.document().erase(set);
+      context.selections().replace(SelectionSet(m_replacement));
+    }
+  }
+  
   void EditMode::commitInsert(EditContext& context) {
     context.leaveMode();
   }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Mode.hpp"
+#include "Selection.hpp"
+
+#include <vector>
 
 namespace quip {
   struct EditContext;
@@ -25,8 +28,12 @@ namespace quip {
     bool onUnmappedKey (Key key, const std::string & text, EditContext & context) override;
     
   private:
+    void backspace (EditContext & context);
     void commitInsert (EditContext & context);
     
     bool m_useAppendBehavior;
+    
+    std::vector<Selection> m_adjusted;
+    std::vector<Selection> m_replacement;
   };
 }
@@ -2,6 +2,8 @@
 
 #include "Document.hpp"
 #include "EditContext.hpp"
+#include "MemoryAccounting.hpp"
+#include "Trace.hpp"
 
 namespace quip {
   EraseTransaction::EraseTransaction(const SelectionSet& selections)
@@ -12,6 +14,8 @@ namespace quip {
   }
   
   void EraseTransaction::perform(EditContext& context) {
+    TraceSpan span("EraseTransaction::perform");
+    
     // Capture the text covered by the selections prior to erasing it so that it
     // can be restored later.
     m_text = context.document().contents(m_selections);
@@ -20,10 +24,17 @@ namespace quip {
   }
   
   void EraseTransaction::rollback(EditContext& context) {
+    TraceSpan span("EraseTransaction::rollback");
+    
     context.selections().replace(context.document().insert(m_selections, m_text));
   }
   
+  std::size_t EraseTransaction::memoryUsage() const {
+    return sizeof(*this) + m_selections.memoryUsage() + quip::memoryUsage(m_text);
+  }
+  
   std::shared_ptr<Transaction> EraseTransaction::create(const SelectionSet& selections) {
+    MemoryScope scope(MemoryCategory::UndoHistory);
     return std::make_shared<EraseTransaction>(selections);
   }
 }
@@ -16,6 +16,8 @@ namespace quip {
     void perform (EditContext & context) override;
     void rollback (EditContext & context) override;
     
+    std::size_t memoryUsage () const override;
+    
     static std::shared_ptr<Transaction> create (const SelectionSet & selections);
     
   private:
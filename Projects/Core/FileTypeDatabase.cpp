@@ -1,32 +1,110 @@
 #include "FileTypeDatabase.hpp"
 
-#include "ScriptHost.hpp"
+#include <cstring>
+#include <map>
+#include <mutex>
 
 namespace quip {
-  FileTypeDatabase::FileTypeDatabase(ScriptHost& scriptHost)
-  : m_scriptHost(scriptHost) {
-    m_unknownFileType.name = "?";
-    m_unknownFileType.syntax = m_scriptHost.getScript(m_scriptHost.scriptRootPath() + "/syntax/text.lua");
+  namespace {
+    std::uint64_t hashExtension(const char* extension, std::size_t length) {
+      // 64-bit FNV-1a.
+      std::uint64_t result = 14695981039346656037ull;
+      for (std::size_t index = 0; index < length; ++index) {
+        result ^= static_cast<unsigned char>(extension[index]);
+        result *= 1099511628211ull;
+      }
+      
+      return result;
+    }
   }
   
-  void FileTypeDatabase::registerFileType(const std::string& displayName, const std::string& canonicalName, const std::vector<std::string>& extensions) {
-    m_knownTypes.emplace_back(std::make_unique<FileType>());
+  constexpr std::uint32_t FileTypeDatabase::EmptySlot;
+  
+  FileTypeDatabase::FileTypeDatabase(const std::string& scriptRootPath, const std::vector<FileTypeRegistration>& registrations) {
+    // The unknown file type is always the first type.
+    m_types.reserve(registrations.size() + 1);
+    m_types.push_back(FileType { "?", Script(scriptRootPath + "/syntax/text.lua") });
     
-    FileType* type = m_knownTypes.back().get();
-    type->name = displayName;
-    type->syntax = m_scriptHost.getScript(m_scriptHost.scriptRootPath() + "/syntax/" + canonicalName + ".lua");
+    std::size_t extensions = 0;
+    for (const FileTypeRegistration& registration : registrations) {
+      extensions += registration.extensions.size();
+    }
     
-    for (const std::string & extension : extensions) {
-      m_knownExtensions.emplace(extension, type);
+    // Keep the table at most half full so probe sequences stay short.
+    std::size_t capacity = 8;
+    while (capacity < extensions * 2) {
+      capacity *= 2;
+    }
+    
+    m_slots.assign(capacity, Slot { 0, EmptySlot, EmptySlot });
+    m_mask = capacity - 1;
+    
+    for (const FileTypeRegistration& registration : registrations) {
+      std::uint32_t type = static_cast<std::uint32_t>(m_types.size());
+      m_types.push_back(FileType { registration.displayName, Script(scriptRootPath + "/syntax/" + registration.canonicalName + ".lua") });
+      
+      for (const std::string& extension : registration.extensions) {
+        std::uint64_t hash = hashExtension(extension.data(), extension.size());
+        std::size_t index = hash & m_mask;
+        while (m_slots[index].extension != EmptySlot && m_extensions[m_slots[index].extension] != extension) {
+          index = (index + 1) & m_mask;
+        }
+        
+        // Like the map this replaced, the first registration of an extension wins.
+        if (m_slots[index].extension == EmptySlot) {
+          m_slots[index] = Slot { hash, static_cast<std::uint32_t>(m_extensions.size()), type };
+          m_extensions.push_back(extension);
+        }
+      }
     }
   }
   
   const FileType* FileTypeDatabase::lookupByExtension(const std::string& extension) const {
-    std::map<std::string, FileType*>::const_iterator cursor = m_knownExtensions.find(extension);
-    if (cursor != std::end(m_knownExtensions)) {
-      return cursor->second;
+    return lookup(extension.data(), extension.size());
+  }
+  
+  const FileType* FileTypeDatabase::lookupByPath(const std::string& path) const {
+    std::size_t separator = path.find_last_of("./");
+    if (separator == std::string::npos || path[separator] != '.') {
+      return lookup("", 0);
+    }
+    
+    return lookup(path.data() + separator + 1, path.size() - separator - 1);
+  }
+  
+  std::shared_ptr<const FileTypeDatabase> FileTypeDatabase::standard(const std::string& scriptRootPath) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const FileTypeDatabase>> databases;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const FileTypeDatabase>& result = databases[scriptRootPath];
+    if (result == nullptr) {
+      result = std::make_shared<const FileTypeDatabase>(scriptRootPath, std::vector<FileTypeRegistration> {
+        { "Text", "text", { "txt", "text" } },
+        { "Markdown", "markdown", { "md", "markdown" } },
+        { "C++ Source", "cpp", { "cpp", "cxx" } },
+        { "C++ Header", "cpp", { "hpp", "hxx" } },
+        { "C Source", "cpp", { "c" } },
+        { "C/C++ Header", "cpp", { "h" } },
+        { "GLSL Shader Source", "glsl", { "fsh", "vsh" } }
+      });
+    }
+    
+    return result;
+  }
+  
+  const FileType* FileTypeDatabase::lookup(const char* extension, std::size_t length) const {
+    std::uint64_t hash = hashExtension(extension, length);
+    for (std::size_t index = hash & m_mask; m_slots[index].extension != EmptySlot; index = (index + 1) & m_mask) {
+      const Slot& slot = m_slots[index];
+      if (slot.hash == hash) {
+        const std::string& candidate = m_extensions[slot.extension];
+        if (candidate.size() == length && std::memcmp(candidate.data(), extension, length) == 0) {
+          return &m_types[slot.type];
+        }
+      }
     }
     
-    return &m_unknownFileType;
+    return &m_types.front();
   }
 }
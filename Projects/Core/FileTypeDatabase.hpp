@@ -2,30 +2,58 @@
 
 #include "Script.hpp"
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace quip {
-  struct ScriptHost;
-  
   struct FileType {
     std::string name;
     Script syntax;
   };
   
+  struct FileTypeRegistration {
+    std::string displayName;
+    std::string canonicalName;
+    std::vector<std::string> extensions;
+  };
+  
+  // An immutable registry of file types, looked up by file extension.
+  //
+  // Extensions are stored in an open-addressed hash table, so a lookup hashes the extension once
+  // and usually compares a single entry. Since the database never changes after construction, it
+  // can be shared between edit contexts and queried from any thread. Syntax scripts are named but
+  // not loaded; the script host loads them when they are first used.
   struct FileTypeDatabase {
-    FileTypeDatabase(ScriptHost& scriptHost);
+    FileTypeDatabase(const std::string& scriptRootPath, const std::vector<FileTypeRegistration>& registrations);
     
-    void registerFileType(const std::string& displayName, const std::string& canonicalName, const std::vector<std::string>& extensions);
+    FileTypeDatabase(const FileTypeDatabase& other) = delete;
+    FileTypeDatabase& operator=(const FileTypeDatabase& other) = delete;
     
+    // Look up a file type; these never fail, returning the unknown file type instead.
     const FileType* lookupByExtension(const std::string& extension) const;
+    const FileType* lookupByPath(const std::string& path) const;
+    
+    // Get the database of standard file types for the specified script root, which is created
+    // once and then shared by the whole process.
+    static std::shared_ptr<const FileTypeDatabase> standard(const std::string& scriptRootPath);
     
   private:
-    ScriptHost& m_scriptHost;
+    struct Slot {
+      std::uint64_t hash;
+      std::uint32_t extension;
+      std::uint32_t type;
+    };
+    
+    static constexpr std::uint32_t EmptySlot = 0xffffffff;
+    
+    std::vector<FileType> m_types;
+    std::vector<std::string> m_extensions;
+    std::vector<Slot> m_slots;
+    std::size_t m_mask;
     
-    FileType m_unknownFileType;
-    std::vector<std::unique_ptr<FileType>> m_knownTypes;
-    std::map<std::string, FileType*> m_knownExtensions;
+    const FileType* lookup(const char* extension, std::size_t length) const;
   };
 }
@@ -0,0 +1,152 @@
+#include "IncrementalSearch.hpp"
+
+#include "Document.hpp"
+#include "DocumentIterator.hpp"
+#include "SearchExpression.hpp"
+#include "Selection.hpp"
+#include "Trace.hpp"
+
+namespace quip {
+  namespace {
+    // Determine whether an expression only matches its own text.
+    bool isLiteral(const std::string& expression) {
+      return expression.find_first_of("^$\\.*+?()[]{}|") == std::string::npos;
+    }
+
+    // Determine whether two occurrences of a literal can overlap, which requires a proper prefix of
+    // the literal that is also a suffix of it.
+    bool canOverlap(const std::string& literal) {
+      for (std::size_t length = 1; length < literal.size(); ++length) {
+        if (literal.compare(0, length, literal, literal.size() - length, length) == 0) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+  }
+
+  IncrementalSearch::IncrementalSearch()
+  : m_revision(0)
+  , m_isScoped(false)
+  , m_scans(0)
+  , m_refinements(0)
+  , m_restorations(0) {
+  }
+
+  void IncrementalSearch::clear() {
+    m_history.clear();
+    m_isScoped = false;
+    m_scope = SelectionSet();
+  }
+
+  SelectionSet IncrementalSearch::matches(const Document& document, const SearchExpression& expression) {
+    if (m_isScoped) {
+      clear();
+    }
+
+    return search(document, expression);
+  }
+
+  SelectionSet IncrementalSearch::matches(const Document& document, const SearchExpression& expression, const SelectionSet& within) {
+    if (!m_isScoped) {
+      clear();
+      m_isScoped = true;
+      m_scope = within;
+    }
+
+    return search(document, expression);
+  }
+
+  std::size_t IncrementalSearch::scans() const {
+    return m_scans;
+  }
+
+  std::size_t IncrementalSearch::refinements() const {
+    return m_refinements;
+  }
+
+  std::size_t IncrementalSearch::restorations() const {
+    return m_restorations;
+  }
+
+  SelectionSet IncrementalSearch::search(const Document& document, const SearchExpression& expression) {
+    if (!expression.valid()) {
+      return SelectionSet();
+    }
+
+    const std::string& text = expression.expression();
+    if (document.revision() != m_revision) {
+      m_history.clear();
+      m_revision = document.revision();
+    }
+
+    // Discard the cached searches that the expression doesn't extend.
+    while (!m_history.empty()) {
+      const std::string& previous = m_history.back().first;
+      if (previous.size() <= text.size() && text.compare(0, previous.size(), previous) == 0) {
+        break;
+      }
+
+      m_history.pop_back();
+    }
+
+    SelectionSet result;
+    if (!m_history.empty() && m_history.back().first == text) {
+      ++m_restorations;
+      return m_history.back().second;
+    } else if (!m_history.empty() && isLiteral(text) && !canOverlap(m_history.back().first) && !canOverlap(text)) {
+      ++m_refinements;
+      result = refine(document, m_history.back().second, text.substr(m_history.back().first.size()));
+    } else {
+      ++m_scans;
+      result = scan(document, expression);
+    }
+
+    m_history.emplace_back(text, result);
+    return result;
+  }
+
+  SelectionSet IncrementalSearch::scan(const Document& document, const SearchExpression& expression) const {
+    return m_isScoped ? document.matches(expression, m_scope) : document.matches(expression);
+  }
+
+  SelectionSet IncrementalSearch::refine(const Document& document, const SelectionSet& previous, const std::string& suffix) const {
+    TraceSpan span("IncrementalSearch::refine");
+
+    std::vector<Selection> results;
+    std::size_t scopeIndex = 0;
+    DocumentIterator end = document.end();
+    for (const Selection& match : previous) {
+      // Extend the match over the suffix, one character at a time.
+      DocumentIterator cursor = document.at(match.extent());
+      bool isExtended = true;
+      for (char character : suffix) {
+        ++cursor;
+        if (cursor == end || *cursor != character) {
+          isExtended = false;
+          break;
+        }
+      }
+
+      if (!isExtended) {
+        continue;
+      }
+
+      // Scoped matches can't extend past the selection that contains them.
+      if (m_isScoped) {
+        while (scopeIndex < m_scope.count() && m_scope[scopeIndex].extent() < match.origin()) {
+          ++scopeIndex;
+        }
+
+        if (scopeIndex == m_scope.count() || m_scope[scopeIndex].extent() < cursor.location()) {
+          continue;
+        }
+      }
+
+      results.emplace_back(match.origin(), cursor.location());
+    }
+
+    return SelectionSet(std::move(results));
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SelectionSet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace quip {
+  struct Document;
+  struct SearchExpression;
+
+  // Finds the matches for a search expression as it is typed.
+  //
+  // The matches for each expression are cached until the search is cleared, so removing characters
+  // from the end of the expression restores earlier matches without searching again. Appending
+  // characters to a literal expression filters and extends the previous matches rather than
+  // scanning the document, where that provably finds the same matches as a scan: when neither the
+  // previous literal nor the longer one can overlap itself, the scan finds every occurrence of
+  // both, and every occurrence of the longer literal begins with one of the previous literal.
+  struct IncrementalSearch {
+    IncrementalSearch();
+
+    // Forget the cached matches, and whether the search is within selections.
+    void clear();
+
+    // Search the whole document, or only within the selections (which must not change until the
+    // search is cleared).
+    SelectionSet matches(const Document& document, const SearchExpression& expression);
+    SelectionSet matches(const Document& document, const SearchExpression& expression, const SelectionSet& within);
+
+    // Count how the matches were found since construction, for diagnostics and tests.
+    std::size_t scans() const;
+    std::size_t refinements() const;
+    std::size_t restorations() const;
+
+  private:
+    std::vector<std::pair<std::string, SelectionSet>> m_history;
+    std::uint64_t m_revision;
+    bool m_isScoped;
+    SelectionSet m_scope;
+
+    std::size_t m_scans;
+    std::size_t m_refinements;
+    std::size_t m_restorations;
+
+    SelectionSet search(const Document& document, const SearchExpression& expression);
+    SelectionSet scan(const Document& document, const SearchExpression& expression) const;
+    SelectionSet refine(const Document& document, const SelectionSet& previous, const std::string& suffix) const;
+  };
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace quip {
+  template<typename, std::size_t = 4 * sizeof(void*)> struct InplaceFunction;
+  
+  // A type-erased callable wrapper, like std::function, that always stores its target inline.
+  // Targets must fit within the specified capacity (by default, enough for a member function
+  // pointer and an object pointer) and this is enforced at compile time, so constructing, copying
+  // and calling an inplace function never allocates. Targets must also be nothrow move
+  // constructible, so that moving an inplace function never throws.
+  //
+  // As with std::function, a member pointer target is called through std::mem_fn, and a null
+  // function or member pointer leaves the function empty. Calling an empty function throws
+  // std::bad_function_call.
+  template<typename ReturnType, typename... ArgumentTypes, std::size_t Capacity>
+  struct InplaceFunction<ReturnType (ArgumentTypes...), Capacity> {
+    InplaceFunction() noexcept
+    : m_invoke(nullptr)
+    , m_manage(nullptr) {
+    }
+    
+    InplaceFunction(std::nullptr_t) noexcept
+    : InplaceFunction() {
+    }
+    
+    template<typename FunctionType, typename = typename std::enable_if<!std::is_same<typename std::decay<FunctionType>::type, InplaceFunction>::value>::type>
+    InplaceFunction(FunctionType&& function)
+    : InplaceFunction() {
+      typedef typename std::decay<FunctionType>::type TargetType;
+      typedef std::integral_constant<bool, std::is_pointer<TargetType>::value || std::is_member_pointer<TargetType>::value> IsPointer;
+      if (isNull(function, IsPointer())) {
+        return;
+      }
+      
+      store(wrap(std::forward<FunctionType>(function), std::is_member_pointer<TargetType>()));
+    }
+    
+    InplaceFunction(const InplaceFunction& other)
+    : m_invoke(other.m_invoke)
+    , m_manage(other.m_manage) {
+      if (m_manage != nullptr) {
+        m_manage(Operation::Copy, &m_storage, const_cast<Storage*>(&other.m_storage));
+      }
+    }
+    
+    InplaceFunction(InplaceFunction&& other) noexcept
+    : m_invoke(other.m_invoke)
+    , m_manage(other.m_manage) {
+      if (m_manage != nullptr) {
+        m_manage(Operation::Move, &m_storage, &other.m_storage);
+      }
+    }
+    
+    ~InplaceFunction() {
+      clear();
+    }
+    
+    InplaceFunction& operator= (const InplaceFunction& other) {
+      if (this != &other) {
+        clear();
+        if (other.m_manage != nullptr) {
+          other.m_manage(Operation::Copy, &m_storage, const_cast<Storage*>(&other.m_storage));
+          m_invoke = other.m_invoke;
+          m_manage = other.m_manage;
+        }
+      }
+      
+      return *this;
+    }
+    
+    InplaceFunction& operator= (InplaceFunction&& other) noexcept {
+      if (this != &other) {
+        clear();
+        if (other.m_manage != nullptr) {
+          other.m_manage(Operation::Move, &m_storage, &other.m_storage);
+          m_invoke = other.m_invoke;
+          m_manage = other.m_manage;
+        }
+      }
+      
+      return *this;
+    }
+    
+    InplaceFunction& operator= (std::nullptr_t) {
+      clear();
+      return *this;
+    }
+    
+    explicit operator bool() const noexcept {
+      return m_invoke != nullptr;
+    }
+    
+    ReturnType operator() (ArgumentTypes... arguments) const {
+      if (m_invoke == nullptr) {
+        throw std::bad_function_call();
+      }
+      
+      return m_invoke(const_cast<Storage*>(&m_storage), std::forward<ArgumentTypes>(arguments)...);
+    }
+    
+  private:
+    typedef typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type Storage;
+    
+    enum struct Operation {
+      Copy,
+      Move,
+      Destroy
+    };
+    
+    typedef ReturnType (*InvokeType)(Storage*, ArgumentTypes&&...);
+    typedef void (*ManageType)(Operation, Storage*, Storage*);
+    
+    Storage m_storage;
+    InvokeType m_invoke;
+    ManageType m_manage;
+    
+    template<typename FunctionType>
+    static bool isNull(const FunctionType& function, std::true_type) noexcept {
+      return function == nullptr;
+    }
+    
+    template<typename FunctionType>
+    static bool isNull(const FunctionType& function, std::false_type) noexcept {
+      return false;
+    }
+    
+    template<typename FunctionType>
+    static FunctionType&& wrap(FunctionType&& function, std::false_type) noexcept {
+      return std::forward<FunctionType>(function);
+    }
+    
+    template<typename MemberType>
+    static auto wrap(MemberType member, std::true_type) noexcept -> decltype(std::mem_fn(member)) {
+      return std::mem_fn(member);
+    }
+    
+    template<typename FunctionType>
+    void store(FunctionType&& function) {
+      typedef typename std::decay<FunctionType>::type TargetType;
+      static_assert(sizeof(TargetType) <= Capacity, "The target is too large for the inplace function.");
+      static_assert(alignof(TargetType) <= alignof(Storage), "The target is too strictly aligned for the inplace function.");
+      static_assert(std::is_nothrow_move_constructible<TargetType>::value, "The target must be nothrow move constructible.");
+      
+      new (&m_storage) TargetType(std::forward<FunctionType>(function));
+      m_invoke = &invoke<TargetType>;
+      m_manage = &manage<TargetType>;
+    }
+    
+    template<typename TargetType>
+    static ReturnType invoke(Storage* storage, ArgumentTypes&&... arguments) {
+      return (*reinterpret_cast<TargetType*>(storage))(std::forward<ArgumentTypes>(arguments)...);
+    }
+    
+    template<typename TargetType>
+    static void manage(Operation operation, Storage* target, Storage* source) {
+      switch (operation) {
+        case Operation::Copy:
+          new (target) TargetType(*reinterpret_cast<const TargetType*>(source));
+          break;
+        case Operation::Move:
+          new (target) TargetType(std::move(*reinterpret_cast<TargetType*>(source)));
+          break;
+        case Operation::Destroy:
+          reinterpret_cast<TargetType*>(target)->~TargetType();
+          break;
+      }
+    }
+    
+    void clear() {
+      if (m_manage != nullptr) {
+        m_manage(Operation::Destroy, &m_storage, nullptr);
+      }
+      
+      m_invoke = nullptr;
+      m_manage = nullptr;
+    }
+  };
+  
+  template<typename SignatureType, std::size_t Capacity>
+  bool operator== (const InplaceFunction<SignatureType, Capacity>& function, std::nullptr_t) noexcept {
+    return !function;
+  }
+  
+  template<typename SignatureType, std::size_t Capacity>
+  bool operator== (std::nullptr_t, const InplaceFunction<SignatureType, Capacity>& function) noexcept {
+    return !function;
+  }
+  
+  template<typename SignatureType, std::size_t Capacity>
+  bool operator!= (const InplaceFunction<SignatureType, Capacity>& function, std::nullptr_t) noexcept {
+    return static_cast<bool>(function);
+  }
+  
+  template<typename SignatureType, std::size_t Capacity>
+  bool operator!= (std::nullptr_t, const InplaceFunction<SignatureType, Capacity>& function) noexcept {
+    return static_cast<bool>(function);
+  }
+}
@@ -2,6 +2,8 @@
 
 #include "Document.hpp"
 #include "EditContext.hpp"
+#include "MemoryAccounting.hpp"
+#include "Trace.hpp"
 
 namespace quip {
   InsertTransaction::InsertTransaction(const SelectionSet& selections, const std::vector<std::string>& text)
@@ -13,18 +15,33 @@ namespace quip {
   }
   
   void InsertTransaction::perform(EditContext& context) {
-    context.selections().replace(context.document().insert(m_selections, m_text));
+    TraceSpan span("InsertTransaction::perform");
+    
+    // A single text is inserted at every selection, without replicating it per selection.
+    if (m_text.size() == 1) {
+      context.selections().replace(context.document().insert(m_selections, m_text.front()));
+    } else {
+      context.selections().replace(context.document().insert(m_selections, m_text));
+    }
   }
   
   void InsertTransaction::rollback(EditContext& context) {
+    TraceSpan span("InsertTransaction::rollback");
+    
     context.selections().replace(context.document().erase(m_selections));
   }
   
+  std::size_t InsertTransaction::memoryUsage() const {
+    return sizeof(*this) + m_selections.memoryUsage() + quip::memoryUsage(m_text);
+  }
+  
   std::shared_ptr<Transaction> InsertTransaction::create(const SelectionSet& selections, const std::string& text) {
-    return std::make_shared<InsertTransaction>(selections, std::vector<std::string> {selections.count(), text });
+    MemoryScope scope(MemoryCategory::UndoHistory);
+    return std::make_shared<InsertTransaction>(selections, std::vector<std::string> { text });
   }
   
   std::shared_ptr<Transaction> InsertTransaction::create(const SelectionSet& selections, const std::vector<std::string>& text) {
+    MemoryScope scope(MemoryCategory::UndoHistory);
     return std::make_shared<InsertTransaction>(selections, text);
   }
 }
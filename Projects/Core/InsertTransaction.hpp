@@ -17,6 +17,8 @@ namespace quip {
     void perform (EditContext & context) override;
     void rollback (EditContext & context) override;
     
+    std::size_t memoryUsage () const override;
+    
     static std::shared_ptr<Transaction> create (const SelectionSet & selections, const std::string & text);
     static std::shared_ptr<Transaction> create (const SelectionSet & selections, const std::vector<std::string> & text);
     
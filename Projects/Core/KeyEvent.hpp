@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Key.hpp"
+#include "Modifiers.hpp"
+
+#include <string>
+
+namespace quip {
+  // A single key press, as delivered to EditContext::processKeyEvent.
+  struct KeyEvent {
+    Key key;
+    Modifiers modifiers;
+    std::string text;
+  };
+}
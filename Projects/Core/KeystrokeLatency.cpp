@@ -0,0 +1,146 @@
+#include "KeystrokeLatency.hpp"
+
+#include "LuaBinding.hpp"
+
+#include <cstdio>
+
+namespace quip {
+  namespace {
+    LatencyHistogram& histogramNamed(std::map<std::string, LatencyHistogram, std::less<>>& histograms, const char* name) {
+      // Look the name up without constructing a string, which allocates for long names.
+      std::map<std::string, LatencyHistogram, std::less<>>::iterator cursor = histograms.find(name);
+      if (cursor == histograms.end()) {
+        cursor = histograms.emplace(name, LatencyHistogram()).first;
+      }
+
+      return cursor->second;
+    }
+
+    const LatencyHistogram* findHistogram(const std::map<std::string, LatencyHistogram, std::less<>>& histograms, const std::string& name) {
+      std::map<std::string, LatencyHistogram, std::less<>>::const_iterator cursor = histograms.find(name);
+      return cursor != histograms.end() ? &cursor->second : nullptr;
+    }
+
+    void appendSummary(std::string& text, const LatencyHistogram& histogram) {
+      char buffer[160];
+      std::snprintf(buffer, sizeof(buffer), "{ \"count\": %llu, \"p50\": %llu, \"p99\": %llu, \"max\": %llu }", static_cast<unsigned long long>(histogram.count()), static_cast<unsigned long long>(histogram.percentile(50.0)), static_cast<unsigned long long>(histogram.percentile(99.0)), static_cast<unsigned long long>(histogram.maximum()));
+      text += buffer;
+    }
+
+    void appendSummaries(std::string& text, const std::map<std::string, LatencyHistogram, std::less<>>& histograms) {
+      text += "{";
+      for (std::map<std::string, LatencyHistogram, std::less<>>::const_iterator cursor = histograms.begin(); cursor != histograms.end(); ++cursor) {
+        text += cursor == histograms.begin() ? "\n    \"" : ",\n    \"";
+
+        // Mode names and key sequence expressions only need quotes and backslashes escaped.
+        for (char character : cursor->first) {
+          if (character == '"' || character == '\\') {
+            text += '\\';
+          }
+
+          text += character;
+        }
+
+        text += "\": ";
+        appendSummary(text, cursor->second);
+      }
+
+      text += histograms.empty() ? "}" : "\n  }";
+    }
+
+    // Lua receives latencies in nanoseconds, and zero for modes or commands with no recorded events.
+    std::uint64_t summarize(const LatencyHistogram* histogram, double percentage) {
+      return histogram != nullptr ? histogram->percentile(percentage) : 0;
+    }
+
+    std::uint64_t modePercentile(KeystrokeLatency& latency, const std::string& name, double percentage) {
+      return summarize(latency.mode(name), percentage);
+    }
+
+    std::uint64_t commandPercentile(KeystrokeLatency& latency, const std::string& name, double percentage) {
+      return summarize(latency.command(name), percentage);
+    }
+
+    std::uint64_t percentile(KeystrokeLatency& latency, double percentage) {
+      return latency.all().percentile(percentage);
+    }
+
+    std::uint64_t maximum(const KeystrokeLatency& latency) {
+      return latency.all().maximum();
+    }
+
+    std::uint64_t count(const KeystrokeLatency& latency) {
+      return latency.all().count();
+    }
+  }
+
+  KeystrokeLatency::KeystrokeLatency() {
+  }
+
+  KeystrokeLatency& KeystrokeLatency::shared() {
+    static KeystrokeLatency latency;
+    return latency;
+  }
+
+  void KeystrokeLatency::record(const std::string& mode, const char* command, std::uint64_t nanoseconds) {
+    m_all.record(nanoseconds);
+    histogramNamed(m_modes, mode.c_str()).record(nanoseconds);
+    if (command != nullptr) {
+      histogramNamed(m_commands, command).record(nanoseconds);
+    }
+  }
+
+  void KeystrokeLatency::clear() {
+    m_all.clear();
+    m_modes.clear();
+    m_commands.clear();
+  }
+
+  const LatencyHistogram& KeystrokeLatency::all() const {
+    return m_all;
+  }
+
+  const LatencyHistogram* KeystrokeLatency::mode(const std::string& name) const {
+    return findHistogram(m_modes, name);
+  }
+
+  const LatencyHistogram* KeystrokeLatency::command(const std::string& name) const {
+    return findHistogram(m_commands, name);
+  }
+
+  std::string KeystrokeLatency::report() const {
+    std::string result = "{\n  \"units\": \"ns\",\n  \"all\": ";
+    appendSummary(result, m_all);
+    result += ",\n  \"modes\": ";
+    appendSummaries(result, m_modes);
+    result += ",\n  \"commands\": ";
+    appendSummaries(result, m_commands);
+    result += "\n}\n";
+    return result;
+  }
+
+  bool KeystrokeLatency::write(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+      return false;
+    }
+
+    std::string text = report();
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && written;
+  }
+
+  LuaBinding KeystrokeLatency::binding() {
+    LuaBinding result;
+    result.addProperty("count", &count);
+    result.addProperty("maximum", &maximum);
+    result.addFunction("percentile", &percentile);
+    result.addFunction("modePercentile", &modePercentile);
+    result.addFunction("commandPercentile", &commandPercentile);
+    result.addFunction("report", &KeystrokeLatency::report);
+    result.addFunction("write", &KeystrokeLatency::write);
+    result.addFunction("clear", &KeystrokeLatency::clear);
+
+    return result;
+  }
+}
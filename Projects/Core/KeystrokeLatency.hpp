@@ -0,0 +1,54 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace quip {
+  struct LuaBinding;
+
+  // Accounts for the latency of every key event processed by an edit context: the time from the
+  // context receiving the event until the mode has handled it, including any transactions performed
+  // and the transaction signals they transmit.
+  //
+  // Latencies (in nanoseconds) are recorded into one histogram for all key events, one per mode and
+  // one per command, so that tail latencies can be attributed to the commands that cause them. The
+  // accounting is shared by every context and, like the contexts, is only used from the main thread.
+  struct KeystrokeLatency {
+    typedef std::chrono::steady_clock Clock;
+
+    static KeystrokeLatency& shared();
+
+    // Record a key event's latency. The command is null for key events that only continue a key
+    // sequence or count; those are recorded against the mode but not any command.
+    void record(const std::string& mode, const char* command, std::uint64_t nanoseconds);
+    void clear();
+
+    const LatencyHistogram& all() const;
+
+    // Get the histogram for the specified mode or command, or null if it has no recorded events.
+    const LatencyHistogram* mode(const std::string& name) const;
+    const LatencyHistogram* command(const std::string& name) const;
+
+    // Get the count, 50th and 99th percentile and maximum latency overall, per mode and per command,
+    // as JSON.
+    std::string report() const;
+    bool write(const std::string& path) const;
+
+    static LuaBinding binding();
+
+    KeystrokeLatency(const KeystrokeLatency& other) = delete;
+    KeystrokeLatency& operator=(const KeystrokeLatency& other) = delete;
+
+  private:
+    LatencyHistogram m_all;
+    std::map<std::string, LatencyHistogram, std::less<>> m_modes;
+    std::map<std::string, LatencyHistogram, std::less<>> m_commands;
+
+    KeystrokeLatency();
+  };
+}
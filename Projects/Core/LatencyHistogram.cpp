@@ -0,0 +1,99 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace quip {
+  namespace {
+    unsigned mostSignificantBit(std::uint64_t value) {
+      unsigned result = 0;
+      while (value >>= 1) {
+        ++result;
+      }
+
+      return result;
+    }
+  }
+
+  constexpr unsigned LatencyHistogram::SubBucketBits;
+  constexpr unsigned LatencyHistogram::MaximumBits;
+
+  LatencyHistogram::LatencyHistogram()
+  : m_counts(indexOf((std::uint64_t(1) << MaximumBits) - 1) + 1, 0)
+  , m_count(0)
+  , m_minimum(0)
+  , m_maximum(0) {
+  }
+
+  void LatencyHistogram::record(std::uint64_t value) {
+    value = std::min(value, (std::uint64_t(1) << MaximumBits) - 1);
+    ++m_counts[indexOf(value)];
+
+    m_minimum = m_count == 0 ? value : std::min(m_minimum, value);
+    m_maximum = std::max(m_maximum, value);
+    ++m_count;
+  }
+
+  void LatencyHistogram::clear() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_minimum = 0;
+    m_maximum = 0;
+  }
+
+  std::uint64_t LatencyHistogram::count() const {
+    return m_count;
+  }
+
+  std::uint64_t LatencyHistogram::minimum() const {
+    return m_minimum;
+  }
+
+  std::uint64_t LatencyHistogram::maximum() const {
+    return m_maximum;
+  }
+
+  std::uint64_t LatencyHistogram::percentile(double percentage) const {
+    if (m_count == 0) {
+      return 0;
+    }
+
+    double clamped = std::min(std::max(percentage, 0.0), 100.0);
+    std::uint64_t target = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * m_count)), 1);
+
+    std::uint64_t total = 0;
+    for (std::size_t index = 0; index < m_counts.size(); ++index) {
+      total += m_counts[index];
+      if (total >= target) {
+        return std::min(highestEquivalentValue(index), m_maximum);
+      }
+    }
+
+    return m_maximum;
+  }
+
+  std::size_t LatencyHistogram::indexOf(std::uint64_t value) {
+    // Values below twice the sub-bucket count are their own index. Above that, each power of two
+    // occupies one run of sub-buckets, indexed by the value's leading bits.
+    const std::uint64_t linear = std::uint64_t(2) << SubBucketBits;
+    if (value < linear) {
+      return static_cast<std::size_t>(value);
+    }
+
+    unsigned shift = mostSignificantBit(value) - SubBucketBits;
+    std::uint64_t subBucket = (value >> shift) - (std::uint64_t(1) << SubBucketBits);
+    return static_cast<std::size_t>(linear + ((shift - 1) << SubBucketBits) + subBucket);
+  }
+
+  std::uint64_t LatencyHistogram::highestEquivalentValue(std::size_t index) {
+    const std::uint64_t linear = std::uint64_t(2) << SubBucketBits;
+    if (index < linear) {
+      return index;
+    }
+
+    std::uint64_t offset = index - linear;
+    unsigned shift = static_cast<unsigned>(offset >> SubBucketBits) + 1;
+    std::uint64_t leading = (offset & ((std::uint64_t(1) << SubBucketBits) - 1)) + (std::uint64_t(1) << SubBucketBits);
+    return ((leading + 1) << shift) - 1;
+  }
+}
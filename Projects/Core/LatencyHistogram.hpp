@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quip {
+  // A histogram of latencies (or any non-negative integers) with bounded relative error, in the
+  // style of HdrHistogram.
+  //
+  // Values below 64 are counted exactly. Larger values are counted in buckets that split each power
+  // of two into 32 equal parts, so a reported percentile is within about 3% of the true value while
+  // the histogram occupies a fixed 11 KB regardless of how many values it records. Values of 2^48
+  // (about 78 hours, in nanoseconds) and above are counted as 2^48 - 1.
+  struct LatencyHistogram {
+    LatencyHistogram();
+
+    void record(std::uint64_t value);
+    void clear();
+
+    std::uint64_t count() const;
+    std::uint64_t minimum() const;
+    std::uint64_t maximum() const;
+
+    // Get the value at the specified percentile (between zero and one hundred): the highest value
+    // equivalent to the smallest recorded value that is at least that percentage of all recorded
+    // values, clamped to the maximum. Empty histograms report zero.
+    std::uint64_t percentile(double percentage) const;
+
+  private:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr unsigned MaximumBits = 48;
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_count;
+    std::uint64_t m_minimum;
+    std::uint64_t m_maximum;
+
+    static std::size_t indexOf(std::uint64_t value);
+    static std::uint64_t highestEquivalentValue(std::size_t index);
+  };
+}
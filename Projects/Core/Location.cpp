@@ -1,12 +1,15 @@
 #include "Location.hpp"
 
-#include <limits>
+#include <algorithm>
 #include <utility>
 
 namespace quip {
   namespace {
-    constexpr std::uint64_t InvalidLocationColumn = std::numeric_limits<std::uint64_t>::max() - 1;
-    constexpr std::uint64_t InvalidLocationRow = std::numeric_limits<std::uint64_t>::max() - 1;
+    constexpr unsigned int RowShift = 32;
+    constexpr std::uint64_t CoordinateMask = 0xFFFFFFFF;
+    
+    // Both coordinates saturate at the invalid coordinate.
+    constexpr std::uint64_t InvalidCoordinate = CoordinateMask;
   }
   
   Location::Location()
@@ -14,41 +17,53 @@ namespace quip {
   }
   
   Location::Location(std::uint64_t column, std::uint64_t row)
-  : m_column(column)
-  , m_row(row) {
+  : m_key((std::min(row, InvalidCoordinate) << RowShift) | std::min(column, InvalidCoordinate)) {
   }
   
   bool Location::isValid() const {
-    return m_column != InvalidLocationColumn && m_row != InvalidLocationRow;
+    return column() != InvalidCoordinate && row() != InvalidCoordinate;
   }
   
   std::uint64_t Location::column() const {
-    return m_column;
+    return m_key & CoordinateMask;
   }
   
   std::uint64_t Location::row() const {
-    return m_row;
+    return m_key >> RowShift;
   }
   
   Location Location::adjustBy(std::int64_t columnDelta, std::int64_t rowDelta) const {
+    std::uint64_t column = this->column();
+    std::uint64_t row = this->row();
+    
     // Clamp to zero (preventing wraparound).
-    if (columnDelta < 0 && -columnDelta > m_column) {
-      columnDelta = -m_column;
+    if (columnDelta < 0 && -columnDelta > column) {
+      columnDelta = -column;
     }
     
-    if (rowDelta < 0 && -rowDelta > m_row) {
-      rowDelta = -m_row;
+    if (rowDelta < 0 && -rowDelta > row) {
+      rowDelta = -row;
     }
     
-    return Location(m_column + columnDelta, m_row + rowDelta);
+    return Location(column + columnDelta, row + rowDelta);
+  }
+  
+  std::uint64_t Location::key() const {
+    return m_key;
+  }
+  
+  Location Location::fromKey(std::uint64_t key) {
+    Location result;
+    result.m_key = key;
+    return result;
   }
   
   Location Location::invalid() {
-    return Location(InvalidLocationColumn, InvalidLocationRow);
+    return Location(InvalidCoordinate, InvalidCoordinate);
   }
   
   bool operator==(const Location& left, const Location& right) {
-    return left.column() == right.column() && left.row() == right.row();
+    return left.key() == right.key();
   }
   
   bool operator!=(const Location& left, const Location& right) {
@@ -56,32 +71,23 @@ namespace quip {
   }
   
   bool operator<(const Location& left, const Location& right) {
-    if (left.row() < right.row()) {
-      return true;
-    }
-    
-    if (left.row() == right.row() && left.column() < right.column()) {
-      return true;
-    }
-    
-    return false;
+    return left.key() < right.key();
   }
   
   bool operator<=(const Location& left, const Location& right) {
-    return (left == right) || (left < right);
+    return left.key() <= right.key();
   }
   
   bool operator>(const Location& left, const Location& right) {
-    return !(left <= right);
+    return left.key() > right.key();
   }
   
   bool operator>=(const Location& left, const Location& right) {
-    return (left == right) || (left > right);
+    return left.key() >= right.key();
   }
   
   void swap(Location& left, Location& right) {
     using std::swap;
-    swap(left.m_column, right.m_column);
-    swap(left.m_row, right.m_row);
+    swap(left.m_key, right.m_key);
   }
 }
@@ -3,11 +3,14 @@
 #include <cstdint>
 
 namespace quip {
-  // An unsigned 64-bit column and row position within a document.
+  // An unsigned column and row position within a document.
   //
   // Locations start at (0, 0) and are not tied directly to any particular document.
   // Locations may refer to any cell within the addressible space, although the value
   // (0xFFFFFFFF, 0xFFFFFFFF) is reserved as an "invalid location" sentinel.
+  //
+  // The column and row are packed into a single 64-bit key, row first, so that keys
+  // order the same way locations do. Columns and rows beyond 32 bits are clamped.
   struct Location {
     Location();
     Location(std::uint64_t column, std::uint64_t row);
@@ -19,13 +22,16 @@ namespace quip {
     
     Location adjustBy(std::int64_t columnDelta, std::int64_t rowDelta) const;
     
+    // Get the packed key of the location, or the location with a packed key.
+    std::uint64_t key() const;
+    static Location fromKey(std::uint64_t key);
+    
     static Location invalid();
     
     friend void swap(Location& left, Location& right);
 
   private:
-    std::uint64_t m_column;
-    std::uint64_t m_row;
+    std::uint64_t m_key;
   };
   
   bool operator==(const Location& left, const Location& right);
@@ -1,70 +1,163 @@
 #pragma once
 
+#include "InplaceFunction.hpp"
 #include "Lua.hpp"
+#include "LuaValue.hpp"
 
-#include <experimental/tuple>
+#include <cstddef>
 #include <string>
-#include <unordered_map>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace quip {
+  // Describes the functions and properties of a native type that are exposed to Lua.
+  //
+  // Each member is assigned an integer slot when it is added. A bound object resolves member names
+  // to slots once, when it is bound, so a call from Lua dispatches directly through the slot without
+  // any string handling. Arguments are read in place from the Lua stack (at offsets computed at
+  // compile time from the argument types) and results are pushed directly; see LuaValue for the
+  // supported types.
   struct LuaBinding {
-    bool hasFunction(const std::string& name) const;
+    // A member thunk takes the target object, the Lua state and the stack index of the first
+    // argument (or, for setters, the new value), and returns the number of results it pushed.
+    typedef InplaceFunction<int (void*, lua_State*, int)> Thunk;
+    
+    struct Member {
+      std::string name;
+      Thunk function;
+      Thunk getter;
+      Thunk setter;
+    };
     
     template<typename ObjectType, typename ReturnType, typename... Arguments>
     void addFunction(const std::string& name, ReturnType (ObjectType::*function)(Arguments...)) {
-      m_functions[name] = [this, function](auto object, auto state) {
+      member(name).function = [function](void* object, lua_State* state, int base) {
+        ObjectType* target = reinterpret_cast<ObjectType*>(object);
+        return Call<ReturnType, Arguments...>::invoke([target, function](auto&&... arguments) -> ReturnType {
+          return (target->*function)(std::forward<decltype(arguments)>(arguments)...);
+        }, state, base);
+      };
+    }
+    
+    template<typename ObjectType, typename ReturnType, typename... Arguments>
+    void addFunction(const std::string& name, ReturnType (ObjectType::*function)(Arguments...) const) {
+      member(name).function = [function](void* object, lua_State* state, int base) {
+        const ObjectType* target = reinterpret_cast<const ObjectType*>(object);
+        return Call<ReturnType, Arguments...>::invoke([target, function](auto&&... arguments) -> ReturnType {
+          return (target->*function)(std::forward<decltype(arguments)>(arguments)...);
+        }, state, base);
+      };
+    }
+    
+    // Add a function implemented outside the bound type, which receives the object as its first
+    // argument. This allows a binding to adapt native APIs to a shape that suits Lua.
+    template<typename ObjectType, typename ReturnType, typename... Arguments>
+    void addFunction(const std::string& name, ReturnType (*function)(ObjectType&, Arguments...)) {
+      member(name).function = [function](void* object, lua_State* state, int base) {
         ObjectType* target = reinterpret_cast<ObjectType*>(object);
-        std::tuple<Arguments...> arguments;
-        popValues(state, arguments);
-        
-        // Before applying, stick the member pointer in front of the parameter tuple (it will
-        // become the 'this' pointer).
-        std::experimental::apply(function, std::tuple_cat(std::make_tuple(target), arguments));
+        return Call<ReturnType, Arguments...>::invoke([target, function](auto&&... arguments) -> ReturnType {
+          return function(*target, std::forward<decltype(arguments)>(arguments)...);
+        }, state, base);
       };
     }
     
     template<typename ObjectType, typename PropertyType>
-    void addProperty(const std::string& name, PropertyType (ObjectType::*getter)() const, void (ObjectType::*setter)(PropertyType)) {
-      m_getters[name] = [this, getter] (void* object, lua_State* state) {
+    void addProperty(const std::string& name, PropertyType (ObjectType::*getter)() const) {
+      static_assert(LuaValue<typename std::decay<PropertyType>::type>::Size == 1, "Properties must occupy a single Lua value.");
+      
+      member(name).getter = [getter](void* object, lua_State* state, int) {
+        const ObjectType* target = reinterpret_cast<const ObjectType*>(object);
+        return Call<PropertyType>::invoke([target, getter]() -> PropertyType {
+          return (target->*getter)();
+        }, state, 0);
+      };
+    }
+    
+    template<typename ObjectType, typename PropertyType, typename SetterType>
+    void addProperty(const std::string& name, PropertyType (ObjectType::*getter)() const, void (ObjectType::*setter)(SetterType)) {
+      addProperty(name, getter);
+      
+      member(name).setter = [setter](void* object, lua_State* state, int base) {
         ObjectType* target = reinterpret_cast<ObjectType*>(object);
-        PropertyType result = (target->*getter)();
-        pushValue(state, result);
+        return Call<void, SetterType>::invoke([target, setter](SetterType value) {
+          (target->*setter)(value);
+        }, state, base);
       };
+    }
+    
+    template<typename ObjectType, typename PropertyType>
+    void addProperty(const std::string& name, PropertyType (*getter)(const ObjectType&)) {
+      static_assert(LuaValue<typename std::decay<PropertyType>::type>::Size == 1, "Properties must occupy a single Lua value.");
       
-      m_setters[name] = [this, setter] (void* object, lua_State* state) {
-        typename std::remove_const<typename std::remove_reference<PropertyType>::type>::type value;
-        popValue(state, &value);
-        
+      member(name).getter = [getter](void* object, lua_State* state, int) {
+        const ObjectType* target = reinterpret_cast<const ObjectType*>(object);
+        return Call<PropertyType>::invoke([target, getter]() -> PropertyType {
+          return getter(*target);
+        }, state, 0);
+      };
+    }
+    
+    template<typename ObjectType, typename PropertyType, typename SetterType>
+    void addProperty(const std::string& name, PropertyType (*getter)(const ObjectType&), void (*setter)(ObjectType&, SetterType)) {
+      addProperty(name, getter);
+      
+      member(name).setter = [setter](void* object, lua_State* state, int base) {
         ObjectType* target = reinterpret_cast<ObjectType*>(object);
-        (target->*setter)(value);
+        return Call<void, SetterType>::invoke([target, setter](SetterType value) {
+          setter(*target, value);
+        }, state, base);
       };
     }
     
-    void invokeFunction(const std::string& name, void* object, lua_State* state) const;
-    void invokePropertyGetter(const std::string& name, void* object, lua_State* state) const;
-    void invokePropertySetter(const std::string& name, void* object, lua_State* state) const;
+    const std::vector<Member>& members() const;
     
   private:
-    std::unordered_map<std::string, std::function<void (void*, lua_State*)>> m_getters;
-    std::unordered_map<std::string, std::function<void (void*, lua_State*)>> m_setters;
-    std::unordered_map<std::string, std::function<void (void*, lua_State*)>> m_functions;
-    
-    void pushValue(lua_State* state, const std::string& value);
-    void pushValue(lua_State* state, float value);
+    std::vector<Member> m_members;
     
-    void popValue(lua_State* state, std::string* value);
-    void popValue(lua_State* state, float* value);
-    void popValues(lua_State* state, std::tuple<>& values);
+    Member& member(const std::string& name);
     
-    template<typename FirstArgument, typename... RemainingArguments>
-    void popValues(lua_State* state, std::tuple<FirstArgument, RemainingArguments...>& values) {
-      FirstArgument first;
-      popValue(state, &first);
+    // Get the offset of an argument from the first argument, in Lua stack slots.
+    template<typename... Arguments>
+    static constexpr int offset(std::size_t index) {
+      const int sizes[] = { LuaValue<typename std::decay<Arguments>::type>::Size..., 0 };
       
-      std::tuple<RemainingArguments...> remaining;
-      popValues(state, remaining);
+      int result = 0;
+      for (std::size_t argument = 0; argument < index; ++argument) {
+        result += sizes[argument];
+      }
       
-      values = std::tuple_cat(remaining, std::make_tuple(first));
+      return result;
     }
+    
+    // Read the arguments from the Lua stack, pass them to the invoker and push its result.
+    template<typename ReturnType, typename... Arguments>
+    struct Call {
+      template<typename InvokerType>
+      static int invoke(const InvokerType& invoker, lua_State* state, int base) {
+        return invoke(invoker, state, base, std::index_sequence_for<Arguments...>());
+      }
+      
+      template<typename InvokerType, std::size_t... Indices>
+      static int invoke(const InvokerType& invoker, lua_State* state, int base, std::index_sequence<Indices...>) {
+        typedef LuaValue<typename std::decay<ReturnType>::type> ResultValue;
+        ResultValue::push(state, invoker(LuaValue<typename std::decay<Arguments>::type>::get(state, base + offset<Arguments...>(Indices))...));
+        return ResultValue::Size;
+      }
+    };
+    
+    template<typename... Arguments>
+    struct Call<void, Arguments...> {
+      template<typename InvokerType>
+      static int invoke(const InvokerType& invoker, lua_State* state, int base) {
+        return invoke(invoker, state, base, std::index_sequence_for<Arguments...>());
+      }
+      
+      template<typename InvokerType, std::size_t... Indices>
+      static int invoke(const InvokerType& invoker, lua_State* state, int base, std::index_sequence<Indices...>) {
+        invoker(LuaValue<typename std::decay<Arguments>::type>::get(state, base + offset<Arguments...>(Indices))...);
+        return 0;
+      }
+    };
   };
 }
@@ -0,0 +1,291 @@
+#include "LuaValue.hpp"
+
+#include "Selection.hpp"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace quip {
+  namespace {
+    std::uint64_t getCoordinate(lua_State* state, int table, lua_Integer index) {
+      lua_rawgeti(state, table, index);
+      lua_Integer result = lua_tointeger(state, -1);
+      lua_pop(state, 1);
+      
+      return result < 0 ? 0 : static_cast<std::uint64_t>(result);
+    }
+    
+    const char* TextViewMetatable = "quip.TextView";
+    
+    // Check that the argument is a text view that can still be read. These functions are called
+    // directly from Lua, and raising an error unwinds without running destructors, so they must
+    // not hold any objects that own resources.
+    const TextView& checkTextView(lua_State* state, int index) {
+      const TextView* view = reinterpret_cast<const TextView*>(luaL_checkudata(state, index, TextViewMetatable));
+      if (!view->isAlive()) {
+        luaL_error(state, "text view is stale; the document no longer exists");
+      } else if (!view->isValid()) {
+        luaL_error(state, "text view is stale; the document was modified");
+      }
+      
+      return *view;
+    }
+    
+    // Convert a one-based, possibly negative string library position into a zero-based offset.
+    lua_Integer relativeOffset(lua_Integer position, std::size_t length) {
+      if (position >= 0) {
+        return position - 1;
+      }
+      
+      return static_cast<lua_Integer>(length) + position;
+    }
+    
+    // Views hold a reference to their document's lifetime, which must be released.
+    int textViewCollect(lua_State* state) {
+      TextView* view = reinterpret_cast<TextView*>(luaL_checkudata(state, 1, TextViewMetatable));
+      view->~TextView();
+      return 0;
+    }
+    
+    int textViewLength(lua_State* state) {
+      lua_pushinteger(state, static_cast<lua_Integer>(checkTextView(state, 1).size()));
+      return 1;
+    }
+    
+    int textViewToString(lua_State* state) {
+      const TextView& view = checkTextView(state, 1);
+      lua_pushlstring(state, view.data(), view.size());
+      return 1;
+    }
+    
+    int textViewByte(lua_State* state) {
+      const TextView& view = checkTextView(state, 1);
+      lua_Integer offset = relativeOffset(luaL_optinteger(state, 2, 1), view.size());
+      if (offset < 0 || static_cast<std::size_t>(offset) >= view.size()) {
+        return 0;
+      }
+      
+      lua_pushinteger(state, static_cast<unsigned char>(view.data()[offset]));
+      return 1;
+    }
+    
+    int textViewSub(lua_State* state) {
+      const TextView& view = checkTextView(state, 1);
+      lua_Integer first = std::max<lua_Integer>(relativeOffset(luaL_checkinteger(state, 2), view.size()), 0);
+      lua_Integer last = std::min<lua_Integer>(relativeOffset(luaL_optinteger(state, 3, -1), view.size()), static_cast<lua_Integer>(view.size()) - 1);
+      std::size_t length = last >= first ? static_cast<std::size_t>(last - first + 1) : 0;
+      LuaValue<TextView>::push(state, view.subview(static_cast<std::size_t>(first), length));
+      return 1;
+    }
+    
+    int textViewFind(lua_State* state) {
+      const TextView& view = checkTextView(state, 1);
+      std::size_t patternLength = 0;
+      const char* pattern = luaL_checklstring(state, 2, &patternLength);
+      lua_Integer offset = std::max<lua_Integer>(relativeOffset(luaL_optinteger(state, 3, 1), view.size()), 0);
+      if (static_cast<std::size_t>(offset) > view.size()) {
+        return 0;
+      }
+      
+      const char* first = view.data() + offset;
+      const char* last = view.data() + view.size();
+      const char* match = std::search(first, last, pattern, pattern + patternLength);
+      if (match == last && patternLength > 0) {
+        return 0;
+      }
+      
+      lua_Integer position = static_cast<lua_Integer>(match - view.data()) + 1;
+      lua_pushinteger(state, position);
+      lua_pushinteger(state, position + static_cast<lua_Integer>(patternLength) - 1);
+      return 2;
+    }
+    
+    int textViewLocation(lua_State* state) {
+      const TextView& view = checkTextView(state, 1);
+      LuaValue<Location>::push(state, Location(view.column(), view.row()));
+      return 2;
+    }
+    
+    const luaL_Reg TextViewMethods[] = {
+      { "byte", textViewByte },
+      { "find", textViewFind },
+      { "location", textViewLocation },
+      { "sub", textViewSub },
+      { nullptr, nullptr }
+    };
+    
+    const luaL_Reg TextViewMetamethods[] = {
+      { "__gc", textViewCollect },
+      { "__len", textViewLength },
+      { "__tostring", textViewToString },
+      { nullptr, nullptr }
+    };
+  }
+  
+  void LuaValue<bool>::push(lua_State* state, bool value) {
+    lua_pushboolean(state, value);
+  }
+  
+  bool LuaValue<bool>::get(lua_State* state, int index) {
+    return lua_toboolean(state, index) != 0;
+  }
+  
+  void LuaValue<int>::push(lua_State* state, int value) {
+    lua_pushinteger(state, value);
+  }
+  
+  int LuaValue<int>::get(lua_State* state, int index) {
+    return static_cast<int>(lua_tointeger(state, index));
+  }
+  
+  void LuaValue<float>::push(lua_State* state, float value) {
+    lua_pushnumber(state, value);
+  }
+  
+  float LuaValue<float>::get(lua_State* state, int index) {
+    return static_cast<float>(lua_tonumber(state, index));
+  }
+  
+  void LuaValue<double>::push(lua_State* state, double value) {
+    lua_pushnumber(state, value);
+  }
+  
+  double LuaValue<double>::get(lua_State* state, int index) {
+    return lua_tonumber(state, index);
+  }
+  
+  void LuaValue<std::string>::push(lua_State* state, const std::string& value) {
+    lua_pushlstring(state, value.data(), value.size());
+  }
+  
+  std::string LuaValue<std::string>::get(lua_State* state, int index) {
+    std::size_t length = 0;
+    const char* text = lua_tolstring(state, index, &length);
+    return text != nullptr ? std::string(text, length) : std::string();
+  }
+  
+  void LuaValue<Location>::push(lua_State* state, const Location& value) {
+    lua_pushinteger(state, static_cast<lua_Integer>(value.column()));
+    lua_pushinteger(state, static_cast<lua_Integer>(value.row()));
+  }
+  
+  Location LuaValue<Location>::get(lua_State* state, int index) {
+    return Location(LuaUnsignedValue<std::uint64_t>::get(state, index), LuaUnsignedValue<std::uint64_t>::get(state, index + 1));
+  }
+  
+  void LuaValue<Selection>::push(lua_State* state, const Selection& value) {
+    LuaValue<Location>::push(state, value.origin());
+    LuaValue<Location>::push(state, value.extent());
+  }
+  
+  Selection LuaValue<Selection>::get(lua_State* state, int index) {
+    return Selection(LuaValue<Location>::get(state, index), LuaValue<Location>::get(state, index + 2));
+  }
+  
+  void LuaValue<SelectionSet>::push(lua_State* state, const SelectionSet& value) {
+    lua_createtable(state, static_cast<int>(value.count() * 4), 1);
+    
+    lua_Integer index = 1;
+    for (const Selection& selection : value) {
+      lua_pushinteger(state, static_cast<lua_Integer>(selection.origin().column()));
+      lua_rawseti(state, -2, index++);
+      lua_pushinteger(state, static_cast<lua_Integer>(selection.origin().row()));
+      lua_rawseti(state, -2, index++);
+      lua_pushinteger(state, static_cast<lua_Integer>(selection.extent().column()));
+      lua_rawseti(state, -2, index++);
+      lua_pushinteger(state, static_cast<lua_Integer>(selection.extent().row()));
+      lua_rawseti(state, -2, index++);
+    }
+    
+    // The selections are in document order, so the primary selection has to be identified by index.
+    for (std::size_t primary = 0; primary < value.count(); ++primary) {
+      if (&value[primary] == &value.primary()) {
+        lua_pushinteger(state, static_cast<lua_Integer>(primary + 1));
+        lua_setfield(state, -2, "primary");
+        break;
+      }
+    }
+  }
+  
+  SelectionSet LuaValue<SelectionSet>::get(lua_State* state, int index) {
+    if (!lua_istable(state, index)) {
+      return SelectionSet();
+    }
+    
+    int table = lua_absindex(state, index);
+    std::size_t count = lua_rawlen(state, table) / 4;
+    std::vector<Selection> selections;
+    selections.reserve(count);
+    for (std::size_t selection = 0; selection < count; ++selection) {
+      lua_Integer base = static_cast<lua_Integer>(selection * 4);
+      Location origin(getCoordinate(state, table, base + 1), getCoordinate(state, table, base + 2));
+      Location extent(getCoordinate(state, table, base + 3), getCoordinate(state, table, base + 4));
+      selections.emplace_back(origin, extent);
+    }
+    
+    if (selections.empty()) {
+      return SelectionSet();
+    }
+    
+    Selection primary = selections.front();
+    lua_getfield(state, table, "primary");
+    lua_Integer primaryIndex = lua_tointeger(state, -1);
+    lua_pop(state, 1);
+    if (primaryIndex >= 1 && static_cast<std::size_t>(primaryIndex) <= count) {
+      primary = selections[primaryIndex - 1];
+    }
+    
+    // Overlapping selections may be merged, so find the primary selection again afterwards.
+    SelectionSet result(std::move(selections));
+    for (std::size_t rotation = 0; rotation < result.count() && !(result.primary().origin() <= primary.origin() && primary.origin() <= result.primary().extent()); ++rotation) {
+      result.rotateForward();
+    }
+    
+    return result;
+  }
+  
+  void LuaValue<std::vector<std::string>>::push(lua_State* state, const std::vector<std::string>& value) {
+    lua_createtable(state, static_cast<int>(value.size()), 0);
+    for (std::size_t index = 0; index < value.size(); ++index) {
+      lua_pushlstring(state, value[index].data(), value[index].size());
+      lua_rawseti(state, -2, static_cast<lua_Integer>(index + 1));
+    }
+  }
+  
+  std::vector<std::string> LuaValue<std::vector<std::string>>::get(lua_State* state, int index) {
+    std::vector<std::string> results;
+    if (!lua_istable(state, index)) {
+      return results;
+    }
+    
+    int table = lua_absindex(state, index);
+    std::size_t count = lua_rawlen(state, table);
+    results.reserve(count);
+    for (std::size_t item = 1; item <= count; ++item) {
+      lua_rawgeti(state, table, static_cast<lua_Integer>(item));
+      results.emplace_back(LuaValue<std::string>::get(state, -1));
+      lua_pop(state, 1);
+    }
+    
+    return results;
+  }
+  
+  void LuaValue<TextView>::push(lua_State* state, const TextView& value) {
+    TextView* view = reinterpret_cast<TextView*>(lua_newuserdata(state, sizeof(TextView)));
+    new (view) TextView(value);
+    
+    if (luaL_newmetatable(state, TextViewMetatable)) {
+      luaL_setfuncs(state, TextViewMetamethods, 0);
+      luaL_newlib(state, TextViewMethods);
+      lua_setfield(state, -2, "__index");
+    }
+    
+    lua_setmetatable(state, -2);
+  }
+  
+  TextView LuaValue<TextView>::get(lua_State* state, int index) {
+    TextView* view = reinterpret_cast<TextView*>(luaL_testudata(state, index, TextViewMetatable));
+    return view != nullptr ? *view : TextView();
+  }
+}
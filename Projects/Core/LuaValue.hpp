@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Location.hpp"
+#include "Lua.hpp"
+#include "Selection.hpp"
+#include "SelectionSet.hpp"
+#include "TextView.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace quip {
+  // Conversions between native values and values on the Lua stack, used by LuaBinding to marshal
+  // arguments and results. Each specialization reports how many stack slots a value occupies.
+  //
+  // Values are passed directly on the stack rather than boxed in userdata. A location occupies two
+  // slots (column and row, both zero-based, as in the rest of Core), so functions taking or
+  // returning locations take or return two values in Lua. A selection set is a flat array of
+  // origin and extent coordinates, four integers per selection, with a "primary" field holding
+  // the (one-based) index of the primary selection. A single selection occupies four slots.
+  //
+  // Text views are userdata supporting the length operator, tostring, and byte, sub and (plain)
+  // find methods that mirror the string library, so scripts can scan document text without copying
+  // it into Lua strings. Using a view after its document has been modified raises an error.
+  template<typename ValueType>
+  struct LuaValue;
+  
+  template<>
+  struct LuaValue<bool> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, bool value);
+    static bool get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<int> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, int value);
+    static int get(lua_State* state, int index);
+  };
+  
+  // Unsigned values are clamped to zero when read, since Lua integers are signed. Each unsigned
+  // type is handled separately because std::size_t and std::uint64_t are distinct types on some
+  // platforms.
+  template<typename UnsignedType>
+  struct LuaUnsignedValue {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, UnsignedType value) {
+      lua_pushinteger(state, static_cast<lua_Integer>(value));
+    }
+    
+    static UnsignedType get(lua_State* state, int index) {
+      lua_Integer result = lua_tointeger(state, index);
+      return result < 0 ? 0 : static_cast<UnsignedType>(result);
+    }
+  };
+  
+  template<>
+  struct LuaValue<unsigned int> : LuaUnsignedValue<unsigned int> {
+  };
+  
+  template<>
+  struct LuaValue<unsigned long> : LuaUnsignedValue<unsigned long> {
+  };
+  
+  template<>
+  struct LuaValue<unsigned long long> : LuaUnsignedValue<unsigned long long> {
+  };
+  
+  template<>
+  struct LuaValue<float> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, float value);
+    static float get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<double> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, double value);
+    static double get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<std::string> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, const std::string& value);
+    static std::string get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<Location> {
+    static constexpr int Size = 2;
+    
+    static void push(lua_State* state, const Location& value);
+    static Location get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<Selection> {
+    static constexpr int Size = 4;
+    
+    static void push(lua_State* state, const Selection& value);
+    static Selection get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<SelectionSet> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, const SelectionSet& value);
+    static SelectionSet get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<std::vector<std::string>> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, const std::vector<std::string>& value);
+    static std::vector<std::string> get(lua_State* state, int index);
+  };
+  
+  template<>
+  struct LuaValue<TextView> {
+    static constexpr int Size = 1;
+    
+    static void push(lua_State* state, const TextView& value);
+    static TextView get(lua_State* state, int index);
+  };
+}
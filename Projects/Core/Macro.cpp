@@ -0,0 +1,121 @@
+#include "Macro.hpp"
+
+#include <algorithm>
+
+namespace quip {
+  namespace {
+    const std::uint8_t Header[] = { 'Q', 'M', 1 };
+    const std::size_t HeaderSize = sizeof(Header);
+    
+    const std::uint8_t ControlFlag = 0x1;
+    const std::uint8_t OptionFlag = 0x2;
+    const std::uint8_t ShiftFlag = 0x4;
+  }
+  
+  Macro::Macro()
+  : m_bytes(Header, Header + HeaderSize)
+  , m_count(0) {
+  }
+  
+  Optional<Macro> Macro::fromBytes(const std::vector<std::uint8_t>& bytes) {
+    if (bytes.size() < HeaderSize || !std::equal(Header, Header + HeaderSize, bytes.begin())) {
+      return Optional<Macro>();
+    }
+    
+    Macro result;
+    result.m_bytes = bytes;
+    
+    // Validate the log by reading every event in it.
+    KeyEvent event;
+    std::size_t offset = HeaderSize;
+    while (offset < bytes.size()) {
+      if (!result.read(offset, event)) {
+        return Optional<Macro>();
+      }
+      
+      ++result.m_count;
+    }
+    
+    return result;
+  }
+  
+  bool Macro::isEmpty() const {
+    return m_count == 0;
+  }
+  
+  std::size_t Macro::count() const {
+    return m_count;
+  }
+  
+  const std::vector<std::uint8_t>& Macro::bytes() const {
+    return m_bytes;
+  }
+  
+  void Macro::append(const KeyEvent& event) {
+    appendNumber(static_cast<std::uint32_t>(event.key));
+    
+    std::uint8_t flags = 0;
+    flags |= event.modifiers.control ? ControlFlag : 0;
+    flags |= event.modifiers.option ? OptionFlag : 0;
+    flags |= event.modifiers.shift ? ShiftFlag : 0;
+    m_bytes.push_back(flags);
+    
+    appendNumber(static_cast<std::uint32_t>(event.text.size()));
+    m_bytes.insert(m_bytes.end(), event.text.begin(), event.text.end());
+    ++m_count;
+  }
+  
+  bool Macro::read(std::size_t& offset, KeyEvent& event) const {
+    if (offset < HeaderSize) {
+      offset = HeaderSize;
+    }
+    
+    std::size_t cursor = offset;
+    std::uint32_t key = 0;
+    std::uint32_t length = 0;
+    if (!readNumber(cursor, key) || cursor >= m_bytes.size()) {
+      return false;
+    }
+    
+    std::uint8_t flags = m_bytes[cursor++];
+    if (!readNumber(cursor, length) || length > m_bytes.size() - cursor) {
+      return false;
+    }
+    
+    event.key = static_cast<Key>(key);
+    event.modifiers.control = (flags & ControlFlag) != 0;
+    event.modifiers.option = (flags & OptionFlag) != 0;
+    event.modifiers.shift = (flags & ShiftFlag) != 0;
+    event.text.assign(m_bytes.begin() + cursor, m_bytes.begin() + cursor + length);
+    
+    offset = cursor + length;
+    return true;
+  }
+  
+  void Macro::appendNumber(std::uint32_t value) {
+    // Seven bits per byte, least significant first; the high bit marks a continuation.
+    while (value >= 0x80) {
+      m_bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    
+    m_bytes.push_back(static_cast<std::uint8_t>(value));
+  }
+  
+  bool Macro::readNumber(std::size_t& offset, std::uint32_t& value) const {
+    value = 0;
+    for (std::uint32_t shift = 0; shift < 32; shift += 7) {
+      if (offset >= m_bytes.size()) {
+        return false;
+      }
+      
+      std::uint8_t byte = m_bytes[offset++];
+      value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    
+    return false;
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "KeyEvent.hpp"
+#include "Optional.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quip {
+  // A recorded sequence of key events.
+  //
+  // Events are stored as a compact binary log: a short header followed by, for each event, the key
+  // and the length of its text as variable-length integers, a byte of modifier flags, and the text
+  // itself. The log can be saved and restored verbatim, which makes recorded macros usable as a
+  // deterministic input corpus as well.
+  struct Macro {
+    Macro();
+    
+    // Restore a macro from a log previously obtained from bytes(), if the log is well-formed.
+    static Optional<Macro> fromBytes(const std::vector<std::uint8_t>& bytes);
+    
+    bool isEmpty() const;
+    std::size_t count() const;
+    
+    const std::vector<std::uint8_t>& bytes() const;
+    
+    void append(const KeyEvent& event);
+    
+    // Read the event at the specified offset into the log, advancing the offset past it. Returns
+    // false when there are no more events. The event's text storage is reused, so replaying a macro
+    // by reading into a single event doesn't allocate once the longest text has been seen.
+    bool read(std::size_t& offset, KeyEvent& event) const;
+    
+  private:
+    std::vector<std::uint8_t> m_bytes;
+    std::size_t m_count;
+    
+    void appendNumber(std::uint32_t value);
+    bool readNumber(std::size_t& offset, std::uint32_t& value) const;
+  };
+}
@@ -2,45 +2,126 @@
 
 #include "KeySequence.hpp"
 
+#include <algorithm>
+#include <deque>
+
 namespace quip {
+  constexpr MapTrie::Node MapTrie::InvalidNode;
+  constexpr std::uint32_t MapTrie::NoHandler;
+  
   MapTrie::MapTrie()
-  : m_root(std::make_unique<MapTrieNode>()) {
+  : m_isCompiled(false) {
   }
   
   void MapTrie::insert(const KeySequence& sequence, MapHandler handler) {
-    const Key * key = sequence.begin();
-    const Key * end = sequence.end();
-    MapTrieNode * node = m_root.get();
-    
-    while(key != end) {
-      MapTrieNode * child = node->findChild(*key);
-      if (child == nullptr) {
-        // The remainder of the sequence has no structure in the trie, add it.
-        while(key != end) {
-          node = node->findOrAddChild(*key);
-          ++key;
-        }
-      } else {
-        node = child;
-        ++key;
-      }
+    std::vector<Key> keys(sequence.begin(), sequence.end());
+    std::map<std::vector<Key>, std::uint32_t>::iterator cursor = m_sequences.find(keys);
+    if (cursor != m_sequences.end()) {
+      m_handlers[cursor->second] = std::move(handler);
+    } else {
+      m_sequences.emplace(std::move(keys), static_cast<std::uint32_t>(m_handlers.size()));
+      m_handlers.emplace_back(std::move(handler));
     }
     
-    node->setHandler(handler);
+    m_isCompiled = false;
   }
   
-  const MapTrieNode * MapTrie::find(const KeySequence& sequence) const {
-    const Key * key = sequence.begin();
-    const Key * end = sequence.end();
-    MapTrieNode * node = m_root.get();
+  MapTrie::Node MapTrie::root() const {
+    // The root is always the first node, so there's no need to compile the trie to find it.
+    return 0;
+  }
+  
+  MapTrie::Node MapTrie::advance(Node node, Key key) const {
+    compileIfNeeded();
+    if (node >= m_nodes.size()) {
+      return InvalidNode;
+    }
     
-    while (key != end) {
-      node = node->findChild(*key++);
-      if (node == nullptr) {
-        break;
-      }
+    const NodeData& data = m_nodes[node];
+    std::vector<Edge>::const_iterator first = m_edges.begin() + data.firstEdge;
+    std::vector<Edge>::const_iterator last = first + data.edgeCount;
+    std::vector<Edge>::const_iterator edge = std::lower_bound(first, last, key, [](const Edge& edge, Key key) {
+      return edge.key < key;
+    });
+    
+    if (edge == last || edge->key != key) {
+      return InvalidNode;
+    }
+    
+    return edge->target;
+  }
+  
+  MapTrie::Node MapTrie::find(const KeySequence& sequence) const {
+    Node node = root();
+    for (const Key* key = sequence.begin(); key != sequence.end() && node != InvalidNode; ++key) {
+      node = advance(node, *key);
     }
     
     return node;
   }
+  
+  bool MapTrie::hasChildren(Node node) const {
+    compileIfNeeded();
+    return node < m_nodes.size() && m_nodes[node].edgeCount > 0;
+  }
+  
+  const MapHandler* MapTrie::handler(Node node) const {
+    compileIfNeeded();
+    if (node >= m_nodes.size() || m_nodes[node].handler == NoHandler) {
+      return nullptr;
+    }
+    
+    return &m_handlers[m_nodes[node].handler];
+  }
+  
+  void MapTrie::compileIfNeeded() const {
+    if (m_isCompiled) {
+      return;
+    }
+    
+    // Each pending node covers the range of sequences (in sorted order) that share the prefix the
+    // node represents. Nodes are laid out breadth-first, so every node's edges are contiguous.
+    struct Pending {
+      Node node;
+      std::map<std::vector<Key>, std::uint32_t>::const_iterator first;
+      std::map<std::vector<Key>, std::uint32_t>::const_iterator last;
+      std::size_t depth;
+    };
+    
+    m_nodes.clear();
+    m_edges.clear();
+    m_nodes.push_back(NodeData { 0, 0, NoHandler });
+    
+    std::deque<Pending> pending;
+    pending.push_back(Pending { 0, m_sequences.begin(), m_sequences.end(), 0 });
+    while (!pending.empty()) {
+      Pending current = pending.front();
+      pending.pop_front();
+      
+      // The sequence equal to the prefix itself, if any, sorts first.
+      std::map<std::vector<Key>, std::uint32_t>::const_iterator cursor = current.first;
+      if (cursor != current.last && cursor->first.size() == current.depth) {
+        m_nodes[current.node].handler = cursor->second;
+        ++cursor;
+      }
+      
+      m_nodes[current.node].firstEdge = static_cast<std::uint32_t>(m_edges.size());
+      while (cursor != current.last) {
+        Key key = cursor->first[current.depth];
+        std::map<std::vector<Key>, std::uint32_t>::const_iterator anchor = cursor;
+        while (cursor != current.last && cursor->first[current.depth] == key) {
+          ++cursor;
+        }
+        
+        Node child = static_cast<Node>(m_nodes.size());
+        m_nodes.push_back(NodeData { 0, 0, NoHandler });
+        m_edges.push_back(Edge { key, child });
+        pending.push_back(Pending { child, anchor, cursor, current.depth + 1 });
+      }
+      
+      m_nodes[current.node].edgeCount = static_cast<std::uint32_t>(m_edges.size()) - m_nodes[current.node].firstEdge;
+    }
+    
+    m_isCompiled = true;
+  }
 }
@@ -1,19 +1,73 @@
 #pragma once
 
-#include "MapTrieNode.hpp"
+#include "InplaceFunction.hpp"
+#include "Key.hpp"
+
+#include <cstdint>
+#include <map>
+#include <vector>
 
 namespace quip {
+  struct EditContext;
   struct KeySequence;
   
+  // A callback for handling mapped commands. The count is the number typed before the command, or
+  // one if no number was typed.
+  typedef InplaceFunction<void (EditContext &, std::uint32_t)> MapHandler;
+  
   // A trie (or prefix tree) used to associate key sequences with mapped commands.
+  //
+  // Mappings are compiled into a flat automaton the first time the trie is queried after a change.
+  // Nodes are identified by index and store their outgoing edges as a span of a single edge array,
+  // sorted by key, so advancing from one node to the next is a binary search over a few contiguous
+  // edges regardless of how many mappings are loaded. Callers can hold on to a node and advance it
+  // one key at a time; inserting a mapping invalidates any nodes obtained before the insertion.
   struct MapTrie {
+    typedef std::uint32_t Node;
+    
+    static constexpr Node InvalidNode = 0xffffffff;
+    
     MapTrie ();
     
     void insert (const KeySequence & sequence, MapHandler handler);
     
-    const MapTrieNode * find (const KeySequence & sequence) const;
+    // Get the node representing the empty sequence.
+    Node root () const;
+    
+    // Get the node reached by following the specified key from a node, or the invalid node if the
+    // node has no such edge.
+    Node advance (Node node, Key key) const;
+    
+    // Get the node representing the specified sequence, or the invalid node if no mapping begins
+    // with the sequence.
+    Node find (const KeySequence & sequence) const;
+    
+    bool hasChildren (Node node) const;
+    
+    // Get the handler mapped to the sequence represented by the node, if any.
+    const MapHandler * handler (Node node) const;
 
   private:
-    std::unique_ptr<MapTrieNode> m_root;
+    static constexpr std::uint32_t NoHandler = 0xffffffff;
+    
+    struct Edge {
+      Key key;
+      Node target;
+    };
+    
+    struct NodeData {
+      std::uint32_t firstEdge;
+      std::uint32_t edgeCount;
+      std::uint32_t handler;
+    };
+    
+    std::map<std::vector<Key>, std::uint32_t> m_sequences;
+    std::vector<MapHandler> m_handlers;
+    
+    mutable std::vector<NodeData> m_nodes;
+    mutable std::vector<Edge> m_edges;
+    mutable bool m_isCompiled;
+    
+    void compileIfNeeded () const;
   };
-}
\ No newline at end of file
+}
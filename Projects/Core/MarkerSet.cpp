@@ -0,0 +1,245 @@
+#include "MarkerSet.hpp"
+
+namespace quip {
+  MarkerSet::Transform::Transform()
+  : isAssignment(false)
+  , columnDelta(0)
+  , rowDelta(0) {
+  }
+
+  bool MarkerSet::Transform::isIdentity() const {
+    return !isAssignment && columnDelta == 0 && rowDelta == 0;
+  }
+
+  Location MarkerSet::Transform::apply(const Location& location) const {
+    if (isAssignment) {
+      return target;
+    }
+
+    return location.adjustBy(columnDelta, rowDelta);
+  }
+
+  MarkerSet::Transform MarkerSet::Transform::assignment(const Location& target) {
+    Transform result;
+    result.isAssignment = true;
+    result.target = target;
+    return result;
+  }
+
+  MarkerSet::Transform MarkerSet::Transform::translation(std::int64_t columnDelta, std::int64_t rowDelta) {
+    Transform result;
+    result.columnDelta = columnDelta;
+    result.rowDelta = rowDelta;
+    return result;
+  }
+
+  MarkerSet::Transform MarkerSet::Transform::compose(const Transform& outer, const Transform& inner) {
+    if (outer.isAssignment) {
+      return outer;
+    } else if (inner.isAssignment) {
+      return assignment(outer.apply(inner.target));
+    }
+
+    return translation(inner.columnDelta + outer.columnDelta, inner.rowDelta + outer.rowDelta);
+  }
+
+  MarkerSet::MarkerSet()
+  : m_root(Nil)
+  , m_count(0)
+  , m_seed(0x2545f4914f6cdd1dULL) {
+  }
+
+  std::size_t MarkerSet::count() const {
+    return m_count;
+  }
+
+  std::uint32_t MarkerSet::create(const Location& location) {
+    std::uint32_t node = 0;
+    if (m_free.empty()) {
+      node = static_cast<std::uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+    } else {
+      node = m_free.back();
+      m_free.pop_back();
+    }
+
+    Node& created = m_nodes[node];
+    created.location = location;
+    created.pending = Transform();
+    created.priority = nextPriority();
+    created.left = Nil;
+    created.right = Nil;
+    created.parent = Nil;
+    created.isLive = true;
+
+    // Markers at the same location may be ordered arbitrarily, so splitting before the location
+    // is sufficient.
+    std::uint32_t left = Nil;
+    std::uint32_t right = Nil;
+    split(m_root, location, left, right);
+    m_root = join(join(left, node), right);
+    m_nodes[m_root].parent = Nil;
+
+    ++m_count;
+    return node + 1;
+  }
+
+  void MarkerSet::remove(std::uint32_t marker) {
+    std::uint32_t node = marker - 1;
+    if (marker == 0 || node >= m_nodes.size() || !m_nodes[node].isLive) {
+      return;
+    }
+
+    // Push any pending transforms down along the path to the node so that its children are
+    // up to date before they're re-attached elsewhere.
+    std::vector<std::uint32_t> path;
+    for (std::uint32_t cursor = node; cursor != Nil; cursor = m_nodes[cursor].parent) {
+      path.push_back(cursor);
+    }
+
+    for (std::vector<std::uint32_t>::reverse_iterator cursor = path.rbegin(); cursor != path.rend(); ++cursor) {
+      pushDown(*cursor);
+    }
+
+    std::uint32_t parent = m_nodes[node].parent;
+    std::uint32_t replacement = join(m_nodes[node].left, m_nodes[node].right);
+    if (parent == Nil) {
+      m_root = replacement;
+      if (replacement != Nil) {
+        m_nodes[replacement].parent = Nil;
+      }
+    } else if (m_nodes[parent].left == node) {
+      setLeft(parent, replacement);
+    } else {
+      setRight(parent, replacement);
+    }
+
+    m_nodes[node].isLive = false;
+    m_free.push_back(node);
+    --m_count;
+  }
+
+  Location MarkerSet::location(std::uint32_t marker) const {
+    std::uint32_t node = marker - 1;
+    if (marker == 0 || node >= m_nodes.size() || !m_nodes[node].isLive) {
+      return Location::invalid();
+    }
+
+    // Transforms pending at an ancestor apply to everything below it. Ancestors nearer the node
+    // hold older transforms, so they are applied first.
+    Location result = m_nodes[node].location;
+    for (std::uint32_t cursor = m_nodes[node].parent; cursor != Nil; cursor = m_nodes[cursor].parent) {
+      result = m_nodes[cursor].pending.apply(result);
+    }
+
+    return result;
+  }
+
+  void MarkerSet::replace(const Location& start, const Location& oldEnd, const Location& newEnd) {
+    // Partition the markers into those before the edit, those within the replaced text, those
+    // following the edit on its last row, and those on subsequent rows.
+    std::uint32_t before = Nil;
+    std::uint32_t within = Nil;
+    std::uint32_t sameRow = Nil;
+    std::uint32_t laterRows = Nil;
+    std::uint32_t remainder = Nil;
+    split(m_root, start, before, remainder);
+    split(remainder, oldEnd, within, remainder);
+    split(remainder, Location(0, oldEnd.row() + 1), sameRow, laterRows);
+
+    std::int64_t rowDelta = static_cast<std::int64_t>(newEnd.row()) - static_cast<std::int64_t>(oldEnd.row());
+    std::int64_t columnDelta = static_cast<std::int64_t>(newEnd.column()) - static_cast<std::int64_t>(oldEnd.column());
+    applyTo(within, Transform::assignment(start));
+    applyTo(sameRow, Transform::translation(columnDelta, rowDelta));
+    applyTo(laterRows, Transform::translation(0, rowDelta));
+
+    m_root = join(join(before, within), join(sameRow, laterRows));
+    if (m_root != Nil) {
+      m_nodes[m_root].parent = Nil;
+    }
+  }
+
+  std::uint64_t MarkerSet::nextPriority() {
+    m_seed ^= m_seed >> 12;
+    m_seed ^= m_seed << 25;
+    m_seed ^= m_seed >> 27;
+    return m_seed * 0x2545f4914f6cdd1dULL;
+  }
+
+  void MarkerSet::applyTo(std::uint32_t node, const Transform& transform) {
+    if (node == Nil || transform.isIdentity()) {
+      return;
+    }
+
+    Node& target = m_nodes[node];
+    target.location = transform.apply(target.location);
+    target.pending = Transform::compose(transform, target.pending);
+  }
+
+  void MarkerSet::pushDown(std::uint32_t node) {
+    Node& target = m_nodes[node];
+    if (target.pending.isIdentity()) {
+      return;
+    }
+
+    applyTo(target.left, target.pending);
+    applyTo(target.right, target.pending);
+    target.pending = Transform();
+  }
+
+  void MarkerSet::setLeft(std::uint32_t node, std::uint32_t child) {
+    m_nodes[node].left = child;
+    if (child != Nil) {
+      m_nodes[child].parent = node;
+    }
+  }
+
+  void MarkerSet::setRight(std::uint32_t node, std::uint32_t child) {
+    m_nodes[node].right = child;
+    if (child != Nil) {
+      m_nodes[child].parent = node;
+    }
+  }
+
+  void MarkerSet::split(std::uint32_t node, const Location& key, std::uint32_t& left, std::uint32_t& right) {
+    // Split into the markers before the key and those at or after it.
+    if (node == Nil) {
+      left = Nil;
+      right = Nil;
+      return;
+    }
+
+    pushDown(node);
+    if (m_nodes[node].location < key) {
+      std::uint32_t lower = Nil;
+      split(m_nodes[node].right, key, lower, right);
+      setRight(node, lower);
+      left = node;
+    } else {
+      std::uint32_t upper = Nil;
+      split(m_nodes[node].left, key, left, upper);
+      setLeft(node, upper);
+      right = node;
+    }
+
+    m_nodes[node].parent = Nil;
+  }
+
+  std::uint32_t MarkerSet::join(std::uint32_t left, std::uint32_t right) {
+    if (left == Nil) {
+      return right;
+    } else if (right == Nil) {
+      return left;
+    }
+
+    if (m_nodes[left].priority > m_nodes[right].priority) {
+      pushDown(left);
+      setRight(left, join(m_nodes[left].right, right));
+      return left;
+    }
+
+    pushDown(right);
+    setLeft(right, join(left, m_nodes[right].left));
+    return right;
+  }
+}
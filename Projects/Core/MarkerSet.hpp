@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Location.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace quip {
+  // A collection of locations (markers) that are kept up to date as the text around them is
+  // edited.
+  //
+  // Markers are identified by tokens, which are unsigned 32-bit integers beginning at one (zero can
+  // be used to indicate an invalid or unassigned marker). A token is invalid once its marker has
+  // been removed, and may later be reused for a new marker.
+  //
+  // An edit replaces the text between a start location and an (exclusive) old end location with
+  // text ending at an (exclusive) new end location. Markers before the start are unaffected, markers
+  // within the replaced text collapse to the start, and markers after it move with the text that
+  // follows. A marker exactly at the start of an insertion stays after the inserted text.
+  //
+  // Markers are stored in a treap ordered by location. Edits never reorder markers, so an edit is
+  // applied by splitting the treap into the affected ranges and tagging each range with a pending
+  // translation (or assignment) that is only pushed down to individual markers when the treap is
+  // restructured. Each edit therefore takes logarithmic time regardless of how many markers move.
+  struct MarkerSet {
+    MarkerSet();
+
+    std::size_t count() const;
+
+    std::uint32_t create(const Location& location);
+    void remove(std::uint32_t marker);
+
+    Location location(std::uint32_t marker) const;
+
+    void replace(const Location& start, const Location& oldEnd, const Location& newEnd);
+
+  private:
+    static const std::uint32_t Nil = 0xFFFFFFFF;
+
+    struct Transform {
+      bool isAssignment;
+      Location target;
+      std::int64_t columnDelta;
+      std::int64_t rowDelta;
+
+      Transform();
+
+      bool isIdentity() const;
+      Location apply(const Location& location) const;
+
+      static Transform assignment(const Location& target);
+      static Transform translation(std::int64_t columnDelta, std::int64_t rowDelta);
+      static Transform compose(const Transform& outer, const Transform& inner);
+    };
+
+    struct Node {
+      Location location;
+      Transform pending;
+      std::uint64_t priority;
+      std::uint32_t left;
+      std::uint32_t right;
+      std::uint32_t parent;
+      bool isLive;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<std::uint32_t> m_free;
+    std::uint32_t m_root;
+    std::size_t m_count;
+    std::uint64_t m_seed;
+
+    std::uint64_t nextPriority();
+
+    void applyTo(std::uint32_t node, const Transform& transform);
+    void pushDown(std::uint32_t node);
+    void setLeft(std::uint32_t node, std::uint32_t child);
+    void setRight(std::uint32_t node, std::uint32_t child);
+
+    void split(std::uint32_t node, const Location& key, std::uint32_t& left, std::uint32_t& right);
+    std::uint32_t join(std::uint32_t left, std::uint32_t right);
+  };
+}
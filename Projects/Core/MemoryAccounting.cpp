@@ -0,0 +1,151 @@
+#include "MemoryAccounting.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+namespace quip {
+  namespace {
+    // Counters are constant-initialized, so allocations made during static initialization are
+    // counted safely.
+    std::atomic<std::uint64_t> gAllocations[MemoryCategoryCount];
+    std::atomic<std::uint64_t> gBytes[MemoryCategoryCount];
+
+    thread_local MemoryCategory t_category = MemoryCategory::Other;
+  }
+
+  const char* memoryCategoryName(MemoryCategory category) {
+    switch (category) {
+      case MemoryCategory::Other:
+        return "other";
+      case MemoryCategory::Document:
+        return "document";
+      case MemoryCategory::UndoHistory:
+        return "undo history";
+      case MemoryCategory::Selections:
+        return "selections";
+      case MemoryCategory::Overlays:
+        return "overlays";
+      case MemoryCategory::Scripting:
+        return "scripting";
+    }
+
+    return "unknown";
+  }
+
+  MemoryCategory MemoryAccounting::currentCategory() noexcept {
+    return t_category;
+  }
+
+  void MemoryAccounting::recordAllocation(std::size_t size) noexcept {
+    recordAllocation(t_category, size);
+  }
+
+  void MemoryAccounting::recordAllocation(MemoryCategory category, std::size_t size) noexcept {
+    std::size_t index = static_cast<std::size_t>(category);
+    gAllocations[index].fetch_add(1, std::memory_order_relaxed);
+    gBytes[index].fetch_add(size, std::memory_order_relaxed);
+  }
+
+  AllocationCounts MemoryAccounting::counts(MemoryCategory category) noexcept {
+    std::size_t index = static_cast<std::size_t>(category);
+    return AllocationCounts { gAllocations[index].load(std::memory_order_relaxed), gBytes[index].load(std::memory_order_relaxed) };
+  }
+
+  AllocationCounts MemoryAccounting::total() noexcept {
+    AllocationCounts result { 0, 0 };
+    for (std::size_t index = 0; index < MemoryCategoryCount; ++index) {
+      result.allocations += gAllocations[index].load(std::memory_order_relaxed);
+      result.bytes += gBytes[index].load(std::memory_order_relaxed);
+    }
+
+    return result;
+  }
+
+  MemoryScope::MemoryScope(MemoryCategory category) noexcept
+  : m_previous(t_category) {
+    t_category = category;
+  }
+
+  MemoryScope::~MemoryScope() {
+    t_category = m_previous;
+  }
+
+  AllocationCounter::AllocationCounter()
+  : m_isTotal(true)
+  , m_category(MemoryCategory::Other)
+  , m_start(current()) {
+  }
+
+  AllocationCounter::AllocationCounter(MemoryCategory category)
+  : m_isTotal(false)
+  , m_category(category)
+  , m_start(current()) {
+  }
+
+  std::uint64_t AllocationCounter::allocations() const {
+    return current().allocations - m_start.allocations;
+  }
+
+  std::uint64_t AllocationCounter::bytes() const {
+    return current().bytes - m_start.bytes;
+  }
+
+  void AllocationCounter::reset() {
+    m_start = current();
+  }
+
+  AllocationCounts AllocationCounter::current() const {
+    return m_isTotal ? MemoryAccounting::total() : MemoryAccounting::counts(m_category);
+  }
+
+  MemoryReport::MemoryReport() {
+    for (std::size_t index = 0; index < MemoryCategoryCount; ++index) {
+      m_entries[index] = Entry { 0, MemoryAccounting::counts(static_cast<MemoryCategory>(index)) };
+    }
+  }
+
+  MemoryReport::Entry& MemoryReport::operator[](MemoryCategory category) {
+    return m_entries[static_cast<std::size_t>(category)];
+  }
+
+  const MemoryReport::Entry& MemoryReport::operator[](MemoryCategory category) const {
+    return m_entries[static_cast<std::size_t>(category)];
+  }
+
+  std::uint64_t MemoryReport::liveBytes() const {
+    std::uint64_t result = 0;
+    for (const Entry& entry : m_entries) {
+      result += entry.liveBytes;
+    }
+
+    return result;
+  }
+
+  std::string MemoryReport::description() const {
+    std::string result;
+    char buffer[160];
+    for (std::size_t index = 0; index < MemoryCategoryCount; ++index) {
+      const Entry& entry = m_entries[index];
+      std::snprintf(buffer, sizeof(buffer), "%-14s %12llu bytes held %12llu allocations %14llu bytes allocated\n", memoryCategoryName(static_cast<MemoryCategory>(index)), static_cast<unsigned long long>(entry.liveBytes), static_cast<unsigned long long>(entry.allocated.allocations), static_cast<unsigned long long>(entry.allocated.bytes));
+      result += buffer;
+    }
+
+    return result;
+  }
+
+  std::size_t memoryUsage(const std::string& text) {
+    // Short strings are stored inside the string object itself.
+    const char* object = reinterpret_cast<const char*>(&text);
+    bool isInline = text.data() >= object && text.data() < object + sizeof(std::string);
+    return isInline ? 0 : text.capacity() + 1;
+  }
+
+  std::size_t memoryUsage(const std::vector<std::string>& text) {
+    std::size_t result = text.capacity() * sizeof(std::string);
+    for (const std::string& element : text) {
+      result += memoryUsage(element);
+    }
+
+    return result;
+  }
+}
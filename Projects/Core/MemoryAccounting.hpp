@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace quip {
+  // The subsystems that memory is accounted to.
+  enum class MemoryCategory : std::uint8_t {
+    Other,
+    Document,
+    UndoHistory,
+    Selections,
+    Overlays,
+    Scripting
+  };
+
+  constexpr std::size_t MemoryCategoryCount = 6;
+
+  const char* memoryCategoryName(MemoryCategory category);
+
+  // Counts of the allocations made (not the memory currently held) on behalf of a subsystem.
+  struct AllocationCounts {
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+  };
+
+  // Accounts allocations to the subsystem that made them.
+  //
+  // Code that allocates on behalf of a subsystem opens a memory scope for it; allocations made on
+  // the same thread while the scope is open (and no inner scope is) are counted against the
+  // subsystem. Global allocations are only counted in executables that opt in by linking the
+  // replacement allocation functions of the Quip.AllocationHooks library, which call
+  // recordAllocation. Script allocations are counted by the script host's allocator regardless.
+  struct MemoryAccounting {
+    static MemoryCategory currentCategory() noexcept;
+
+    static void recordAllocation(std::size_t size) noexcept;
+    static void recordAllocation(MemoryCategory category, std::size_t size) noexcept;
+
+    static AllocationCounts counts(MemoryCategory category) noexcept;
+    static AllocationCounts total() noexcept;
+  };
+
+  // Accounts the allocations made on the current thread to a subsystem until destroyed.
+  struct MemoryScope {
+    explicit MemoryScope(MemoryCategory category) noexcept;
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope& other) = delete;
+    MemoryScope& operator=(const MemoryScope& other) = delete;
+
+  private:
+    MemoryCategory m_previous;
+  };
+
+  // Counts the allocations made on every thread since construction (or the last reset), either in
+  // total or for a single subsystem.
+  struct AllocationCounter {
+    AllocationCounter();
+    explicit AllocationCounter(MemoryCategory category);
+
+    std::uint64_t allocations() const;
+    std::uint64_t bytes() const;
+
+    void reset();
+
+  private:
+    bool m_isTotal;
+    MemoryCategory m_category;
+    AllocationCounts m_start;
+
+    AllocationCounts current() const;
+  };
+
+  // The memory held by each subsystem of an edit context, along with the allocations made on behalf
+  // of each subsystem by every context.
+  struct MemoryReport {
+    struct Entry {
+      std::uint64_t liveBytes;
+      AllocationCounts allocated;
+    };
+
+    MemoryReport();
+
+    Entry& operator[](MemoryCategory category);
+    const Entry& operator[](MemoryCategory category) const;
+
+    std::uint64_t liveBytes() const;
+
+    std::string description() const;
+
+  private:
+    std::array<Entry, MemoryCategoryCount> m_entries;
+  };
+
+  // Estimate the heap memory held by common containers, including unused capacity.
+  std::size_t memoryUsage(const std::string& text);
+  std::size_t memoryUsage(const std::vector<std::string>& text);
+}
@@ -1,10 +1,15 @@
 #include "Mode.hpp"
 
 #include "EditContext.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
 
 namespace quip {
   Mode::Mode()
-  : m_count(0) {
+  : m_node(m_mappings.root())
+  , m_count(0)
+  , m_command(nullptr) {
   }
   
   Mode::~Mode() {
@@ -23,59 +28,53 @@ namespace quip {
   }
 
   bool Mode::processKeyEvent(Key key, Modifiers modifiers, EditContext& context) {
-    m_sequence.append(key);
+    TraceSpan span("Mode::processKeyEvent");
+    
+    m_command = nullptr;
+    m_node = m_mappings.advance(m_node, key);
     return true;
   }
   
   bool Mode::processKeyEvent(Key key, Modifiers modifiers, const std::string& text, EditContext& context) {
-    if (allowsCounts() && m_sequence.count() == 0 && keyIsNumber(key)) {
+    TraceSpan span("Mode::processKeyEvent");
+    
+    m_command = nullptr;
+    if (allowsCounts() && m_node == m_mappings.root() && keyIsNumber(key)) {
       m_count *= 10;
       m_count += numberFromKey(key);
     } else {
-      // If any modifiers are present for this keystroke that were not present in the prior keystroke,
-      // add them into the sequence.
-      if (modifiers.control && !m_modifiers.control) {
-        m_sequence.append(modifierDown(Key::ControlMask));
-      }
+      // Open any modifiers that are held for this keystroke but not open in the sequence, and close
+      // any that are open but no longer held.
+      m_node = advanceModifier(m_node, m_modifiers.control, modifiers.control, Key::ControlMask);
+      m_node = advanceModifier(m_node, m_modifiers.shift, modifiers.shift, Key::ShiftMask);
+      m_node = advanceModifier(m_node, m_modifiers.option, modifiers.option, Key::OptionMask);
+      m_modifiers = modifiers;
       
-      if (modifiers.shift && !m_modifiers.shift) {
-        m_sequence.append(modifierDown(Key::ShiftMask));
-      }
+      m_node = m_mappings.advance(m_node, key);
       
-      if (modifiers.option && !m_modifiers.option) {
-        m_sequence.append(modifierDown(Key::OptionMask));
-      }
-      
-      m_sequence.append(key);
-      
-      // Copy the sequence, closing any open modifiers. This allows the sequence to be looked up
-      // in the mapping trie.
-      KeySequence checked(m_sequence.withModifiersClosed());
-      const MapTrieNode* node = m_mappings.find(checked);
-      if (node == nullptr) {
-        m_sequence.clear();
-        m_count = 0;
-        return onUnmappedKey(key, text, context);
-      } else if (node->handler() != nullptr) {
-        m_previousSequence = checked;
-        m_sequence.clear();
-        
-        for (std::uint32_t index = 0; index < std::max(1U, m_count); ++index) {
-          node->handler()(context);
-        }
-        
-        m_count = 0;
+      // Look the sequence up as if the open modifiers were closed, so that a mapping such as <S-H>
+      // is found while shift is still held.
+      MapTrie::Node closed = closeModifiers(m_node);
+      const MapHandler* handler = m_mappings.handler(closed);
+      if (handler != nullptr) {
+        std::uint32_t count = std::max(1U, m_count);
+        resetSequence();
         
-        // Reset the modifier state as well; if the keys are still held, that will
-        // bubble through in the next actual keypress and the code at the top of
-        // this block will insert the appropriate opening sequences.
-        m_modifiers.clear();
+        (*handler)(context, count);
+      } else if (m_node == MapTrie::InvalidNode) {
+        m_command = "(unmapped)";
+        resetSequence();
+        return onUnmappedKey(key, text, context);
       }
     }
     
     return true;
   }
   
+  const char* Mode::command() const {
+    return m_command;
+  }
+  
   void Mode::enter(EditContext& context, std::uint64_t how) {
     onEnter(context, how);
   }
@@ -102,4 +101,30 @@ namespace quip {
     context.popupService().createPopupAtLocation(context.selections().primary().origin(), "No mapping.");
     return false;
   }
+  
+  MapTrie::Node Mode::advanceModifier(MapTrie::Node node, bool isOpen, bool isHeld, Key mask) const {
+    if (isHeld && !isOpen) {
+      return m_mappings.advance(node, modifierDown(mask));
+    } else if (isOpen && !isHeld) {
+      return m_mappings.advance(node, modifierUp(mask));
+    }
+    
+    return node;
+  }
+  
+  MapTrie::Node Mode::closeModifiers(MapTrie::Node node) const {
+    // Modifiers are closed in the same order as KeySequence::withModifiersClosed.
+    node = advanceModifier(node, m_modifiers.control, false, Key::ControlMask);
+    node = advanceModifier(node, m_modifiers.option, false, Key::OptionMask);
+    node = advanceModifier(node, m_modifiers.shift, false, Key::ShiftMask);
+    return node;
+  }
+  
+  void Mode::resetSequence() {
+    // Reset the modifier state as well; if the keys are still held, that will bubble through in the
+    // next actual keypress and open the appropriate modifiers again.
+    m_node = m_mappings.root();
+    m_modifiers.clear();
+    m_count = 0;
+  }
 }
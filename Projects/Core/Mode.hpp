@@ -2,17 +2,15 @@
 
 #include "CursorFlags.hpp"
 #include "CursorStyle.hpp"
+#include "EditContext.hpp"
 #include "Key.hpp"
 #include "KeySequence.hpp"
 #include "MapTrie.hpp"
 #include "Modifiers.hpp"
 
-#include <functional>
 #include <map>
 
 namespace quip {
-  struct EditContext;
-  
   // An operational state.
   struct Mode {
     Mode();
@@ -29,11 +27,51 @@ namespace quip {
     void enter(EditContext& context, std::uint64_t how);
     void exit(EditContext& context);
     
+    // Get the name of the command run by the last key event, "(unmapped)" if the key was not
+    // mapped, or null if the key only continued a sequence or count.
+    const char* command() const;
+    
   protected:
+    // Map a command that doesn't take a count; a count typed before the command repeats it. The
+    // command is named by the expression describing its key sequence.
+    template<typename ModeType>
+    void addMapping(const char* expression, void (ModeType::*callback)(EditContext&)) {
+      addMapping(KeySequence(expression), expression, callback);
+    }
+    
     template<typename ModeType>
-    void addMapping(KeySequence sequence, void (ModeType::*callback)(EditContext&)) {
-      MapHandler bound = std::bind(callback, static_cast<ModeType*>(this), std::placeholders::_1);
-      m_mappings.insert(sequence, bound);
+    void addMapping(KeySequence sequence, const char* name, void (ModeType::*callback)(EditContext&)) {
+      ModeType* mode = static_cast<ModeType*>(this);
+      m_mappings.insert(sequence, [mode, callback, name](EditContext& context, std::uint32_t count) {
+        mode->m_command = name;
+        if (count == 1) {
+          (mode->*callback)(context);
+          return;
+        }
+        
+        // Each repetition may scroll; only the last is visible, so transmit one scroll for all.
+        ScrollBatch batch(context);
+        for (std::uint32_t index = 0; index < count; ++index) {
+          (mode->*callback)(context);
+        }
+        
+        batch.finish();
+      });
+    }
+    
+    // Map a command that takes a count, which is called once with the count typed before it.
+    template<typename ModeType>
+    void addMapping(const char* expression, void (ModeType::*callback)(EditContext&, std::uint32_t)) {
+      addMapping(KeySequence(expression), expression, callback);
+    }
+    
+    template<typename ModeType>
+    void addMapping(KeySequence sequence, const char* name, void (ModeType::*callback)(EditContext&, std::uint32_t)) {
+      ModeType* mode = static_cast<ModeType*>(this);
+      m_mappings.insert(sequence, [mode, callback, name](EditContext& context, std::uint32_t count) {
+        mode->m_command = name;
+        (mode->*callback)(context, count);
+      });
     }
     
     virtual bool allowsRepeats() const;
@@ -45,12 +83,19 @@ namespace quip {
     virtual bool onUnmappedKey(Key key, const std::string& text, EditContext& context);
     
   private:
-    KeySequence m_sequence;
-    KeySequence m_previousSequence;
-    std::uint32_t m_count;
+    MapTrie m_mappings;
     
+    // The node of the mapping trie reached by the keys typed so far, and the modifiers that are
+    // open in that sequence. Each key event advances the node by one transition per modifier opened
+    // or closed and one for the key itself.
+    MapTrie::Node m_node;
     Modifiers m_modifiers;
     
-    MapTrie m_mappings;
+    std::uint32_t m_count;
+    const char* m_command;
+    
+    MapTrie::Node advanceModifier(MapTrie::Node node, bool isOpen, bool isHeld, Key mask) const;
+    MapTrie::Node closeModifiers(MapTrie::Node node) const;
+    void resetSequence();
   };
 }
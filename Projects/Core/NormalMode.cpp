@@ -6,11 +6,31 @@
 #include "EditMode.hpp"
 #include "EraseTransaction.hpp"
 #include "Location.hpp"
+#include "SearchMode.hpp"
 #include "Selection.hpp"
 #include "SelectionSet.hpp"
 #include "Selector.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 namespace quip {
+  namespace {
+    // Move a location up (for a negative number of rows) or down, keeping it within the document
+    // and its column within the target row.
+    Location shiftRows(const Document& document, const Location& location, std::int64_t rows) {
+      if (document.isEmpty()) {
+        return location;
+      }
+      
+      std::int64_t row = static_cast<std::int64_t>(location.row()) + rows;
+      row = std::max<std::int64_t>(0, std::min<std::int64_t>(row, document.rows() - 1));
+      
+      std::uint64_t column = std::min<std::uint64_t>(location.column(), document.row(row).size() - 1);
+      return Location(column, row);
+    }
+  }
+  
   NormalMode::NormalMode() {
     addMapping("H", &NormalMode::doSelectBeforePrimaryOrigin);
     addMapping("J", &NormalMode::doSelectBelowPrimaryExtent);
@@ -46,6 +66,7 @@ namespace quip {
     
     addMapping("F", &NormalMode::enterJumpMode);
     addMapping("/", &NormalMode::enterSearchMode);
+    addMapping("<S-/>", &NormalMode::enterSearchModeWithinSelections);
     addMapping("I", &NormalMode::enterEditModeByInserting);
     addMapping("<S-I>", &NormalMode::enterEditModeByInsertingAtStartOfLines);
     addMapping("A", &NormalMode::enterEditModeByAppending);
@@ -61,7 +82,7 @@ namespace quip {
     return "Normal";
   }
   
-  void NormalMode::doSelectBeforePrimaryOrigin(EditContext& context) {
+  void NormalMode::doSelectBeforePrimaryOrigin(EditContext& context, std::uint32_t count) {
     if (context.document().isEmpty()) {
       return;
     }
@@ -71,7 +92,7 @@ namespace quip {
       return;
     }
     
-    Location target(location.column() - 1, location.row());
+    Location target(location.column() - std::min<std::uint64_t>(count, location.column()), location.row());
     m_virtualColumn = target.column();
     
     Selection result(target, target);
@@ -79,7 +100,7 @@ namespace quip {
     context.controller().scrollLocationIntoView.transmit(context.selections().primary().origin());
   }
   
-  void NormalMode::doSelectBelowPrimaryExtent(EditContext& context) {
+  void NormalMode::doSelectBelowPrimaryExtent(EditContext& context, std::uint32_t count) {
     if (context.document().isEmpty()) {
       return;
     }
@@ -93,7 +114,7 @@ namespace quip {
     m_virtualColumn = std::max(column, m_virtualColumn);
     column = std::max(column, m_virtualColumn);
     
-    std::uint64_t row = location.row() + 1;
+    std::uint64_t row = std::min<std::uint64_t>(location.row() + count, context.document().rows() - 1);
     if (column >= context.document().row(row).length()) {
       column = context.document().row(row).length() - 1;
     }
@@ -105,17 +126,18 @@ namespace quip {
     context.controller().scrollLocationIntoView.transmit(context.selections().primary().origin());
   }
   
-  void NormalMode::doSelectAfterPrimaryExtent(EditContext& context) {
+  void NormalMode::doSelectAfterPrimaryExtent(EditContext& context, std::uint32_t count) {
     if (context.document().isEmpty()) {
       return;
     }
     
     Location location = context.selections().primary().extent();
-    if (location.column() + 1 == context.document().row(location.row()).size()) {
+    std::uint64_t size = context.document().row(location.row()).size();
+    if (location.column() + 1 == size) {
       return;
     }
     
-    Location target(location.column() + 1, location.row());
+    Location target(std::min<std::uint64_t>(location.column() + count, size - 1), location.row());
     m_virtualColumn = target.column();
     
     Selection result(target, target);
@@ -123,7 +145,7 @@ namespace quip {
     context.controller().scrollLocationIntoView.transmit(context.selections().primary().origin());
   }
   
-  void NormalMode::doSelectAbovePrimaryOrigin(EditContext& context) {
+  void NormalMode::doSelectAbovePrimaryOrigin(EditContext& context, std::uint32_t count) {
     if (context.document().isEmpty()) {
       return;
     }
@@ -137,7 +159,7 @@ namespace quip {
     m_virtualColumn = std::max(column, m_virtualColumn);
     column = std::max(column, m_virtualColumn);
     
-    std::uint64_t row = location.row() - 1;
+    std::uint64_t row = location.row() - std::min<std::uint64_t>(count, location.row());
     if (column >= context.document().row(row).length()) {
       column = context.document().row(row).length() - 1;
     }
@@ -149,7 +171,7 @@ namespace quip {
     context.controller().scrollLocationIntoView.transmit(context.selections().primary().origin());
   }
   
-  void NormalMode::doShiftSelectionExtentsLeft(EditContext& context) {
+  void NormalMode::doShiftSelectionExtentsLeft(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
@@ -157,56 +179,37 @@ namespace quip {
     
     for(const Selection& selection : selections) {
       DocumentIterator iterator = document.at(selection.extent());
-      --iterator;
-      
-      if (iterator.location() < selection.origin()) {
-        results.emplace_back(selection);
-      } else {
-        results.emplace_back(selection.origin(), iterator.location());
+      for (std::uint32_t index = 0; index < count && selection.origin() < iterator.location(); ++index) {
+        --iterator;
       }
+      
+      results.emplace_back(selection.origin(), iterator.location());
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionExtentsDown(EditContext& context) {
+  void NormalMode::doShiftSelectionExtentsDown(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     
     for(const Selection& selection : selections) {
-      if (selection.extent().row() == document.rows() - 1) {
-        results.emplace_back(selection);
-      }
-      
-      Location target = selection.extent().adjustBy(0, 1);
-      if (target.column() > document.row(target.row()).size()) {
-        target = Location(document.row(target.row()).size() - 1, target.row());
-      }
-
-      results.emplace_back(selection.origin(), target);
+      results.emplace_back(selection.origin(), shiftRows(document, selection.extent(), count));
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionExtentsUp(EditContext& context) {
+  void NormalMode::doShiftSelectionExtentsUp(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     
     for(const Selection& selection : selections) {
-      if (selection.extent().row() == 0) {
-        results.emplace_back(selection);
-      }
-      
-      Location target = selection.extent().adjustBy(0, -1);
-      if (target.column() > document.row(target.row()).size()) {
-        target = Location(document.row(target.row()).size() - 1, target.row());
-      }
-      
+      Location target = shiftRows(document, selection.extent(), -static_cast<std::int64_t>(count));
       if (target < selection.origin()) {
         results.emplace_back(selection);
       } else {
@@ -214,10 +217,10 @@ namespace quip {
       }
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionExtentsRight(EditContext& context) {
+  void NormalMode::doShiftSelectionExtentsRight(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
@@ -225,15 +228,17 @@ namespace quip {
     
     for(const Selection& selection : selections) {
       DocumentIterator iterator = document.at(selection.extent());
-      ++iterator;
+      for (std::uint32_t index = 0; index < count && std::next(iterator) != document.end(); ++index) {
+        ++iterator;
+      }
       
       results.emplace_back(selection.origin(), iterator.location());
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionOriginsLeft(EditContext& context) {
+  void NormalMode::doShiftSelectionOriginsLeft(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
@@ -241,66 +246,48 @@ namespace quip {
     
     for(const Selection& selection : selections) {
       DocumentIterator iterator = document.at(selection.origin());
-      if (iterator == document.begin()) {
-        results.emplace_back(selection);
-      } else {
+      for (std::uint32_t index = 0; index < count && iterator != document.begin(); ++index) {
         --iterator;
-        results.emplace_back(iterator.location(), selection.extent());
       }
+      
+      results.emplace_back(iterator.location(), selection.extent());
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionOriginsDown(EditContext& context) {
+  void NormalMode::doShiftSelectionOriginsDown(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     
     for(const Selection& selection : selections) {
-      if (selection.origin().row() == document.rows() - 1) {
-        results.emplace_back(selection);
-      } else {
-        Location target = selection.origin().adjustBy(0, 1);
-        if (target.column() > document.row(target.row()).size()) {
-          target = Location(document.row(target.row()).size() - 1, target.row());
-        }
-        
-        results.emplace_back(target, selection.extent());
-      }
+      results.emplace_back(shiftRows(document, selection.origin(), count), selection.extent());
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionOriginsUp(EditContext& context) {
+  void NormalMode::doShiftSelectionOriginsUp(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     
     for(const Selection& selection : selections) {
-      if (selection.origin().row() == 0) {
+      Location target = shiftRows(document, selection.origin(), -static_cast<std::int64_t>(count));
+      if (target > selection.extent()) {
         results.emplace_back(selection);
       } else {
-        Location target = selection.origin().adjustBy(0, -1);
-        if (target.column() > document.row(target.row()).size()) {
-          target = Location(document.row(target.row()).size() - 1, target.row());
-        }
-        
-        if (target > selection.extent()) {
-          results.emplace_back(selection);
-        } else {
-          results.emplace_back(target, selection.origin());
-        }
+        results.emplace_back(target, selection.extent());
       }
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
-  void NormalMode::doShiftSelectionOriginsRight(EditContext& context) {
+  void NormalMode::doShiftSelectionOriginsRight(EditContext& context, std::uint32_t count) {
     Document& document = context.document();
     SelectionSet& selections = context.selections();
     std::vector<Selection> results;
@@ -308,21 +295,19 @@ namespace quip {
     
     for(const Selection& selection : selections) {
       DocumentIterator iterator = document.at(selection.origin());
-      ++iterator;
-      
-      if (iterator.location() <= selection.extent()) {
-        results.emplace_back(iterator.location(), selection.extent());
-      } else {
-        results.emplace_back(selection);
+      for (std::uint32_t index = 0; index < count && iterator.location() < selection.extent(); ++index) {
+        ++iterator;
       }
+      
+      results.emplace_back(iterator.location(), selection.extent());
     }
     
-    selections.replace(SelectionSet(results));
+    selections.replace(SelectionSet(std::move(results)));
   }
   
   void NormalMode::doIncreaseSelectionIndentLevel(EditContext& context) {
     Document& document = context.document();
-    SelectionSet& selections = context.selections();
+    const SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     for (const Selection& selection : selections) {
@@ -332,12 +317,12 @@ namespace quip {
       results.emplace_back(selection.origin().adjustBy(2, 0), selection.extent().adjustBy(2, 0));
     }
     
-    selections.replace(SelectionSet(results));
+    context.selections().replace(SelectionSet(results));
   }
   
   void NormalMode::doDecreaseSelectionIndentLevel(EditContext& context) {
     Document& document = context.document();
-    SelectionSet& selections = context.selections();
+    const SelectionSet& selections = context.selections();
     std::vector<Selection> results;
     results.reserve(selections.count());
     for (const Selection& selection : selections) {
@@ -361,19 +346,19 @@ namespace quip {
       results.emplace_back(selection.origin().adjustBy(-size - 1, 0), selection.extent().adjustBy(-size - 1, 0));
     }
     
-    selections.replace(SelectionSet(results));
+    context.selections().replace(SelectionSet(results));
   }
   
-  void NormalMode::doSelectWord(EditContext& context) {
-    Optional<Selection> result = selectThisOrNextWord(context.document(), context.selections().primary());
+  void NormalMode::doSelectWord(EditContext& context, std::uint32_t count) {
+    Optional<Selection> result = selectThisOrNextWord(context.document(), context.selections().primary(), count);
     if (result.has_value()) {
       context.selections().replace(result.value());
       context.controller().scrollToLocation.transmit(context.selections().primary().extent());
     }
   }
   
-  void NormalMode::doSelectPriorWord(EditContext& context) {
-    Optional<Selection> result = selectPriorWord(context.document(), context.selections().primary());
+  void NormalMode::doSelectPriorWord(EditContext& context, std::uint32_t count) {
+    Optional<Selection> result = selectPriorWord(context.document(), context.selections().primary(), count);
     if (result.has_value()) {
       context.selections().replace(result.value());
       context.controller().scrollToLocation.transmit(context.selections().primary().extent());
@@ -420,13 +405,19 @@ namespace quip {
     }
   }
   
-  void NormalMode::rotateSelectionForward(EditContext& context) {
-    context.selections().rotateForward();
+  void NormalMode::rotateSelectionForward(EditContext& context, std::uint32_t count) {
+    for (std::size_t index = 0; index < count % context.selections().count(); ++index) {
+      context.selections().rotateForward();
+    }
+    
     context.controller().scrollToLocation.transmit(context.selections().primary().origin());
   }
   
-  void NormalMode::rotateSelectionBackward(EditContext& context) {
-    context.selections().rotateBackward();
+  void NormalMode::rotateSelectionBackward(EditContext& context, std::uint32_t count) {
+    for (std::size_t index = 0; index < count % context.selections().count(); ++index) {
+      context.selections().rotateBackward();
+    }
+    
     context.controller().scrollToLocation.transmit(context.selections().primary().origin());
   }
   
@@ -439,7 +430,11 @@ namespace quip {
   }
   
   void NormalMode::enterSearchMode(EditContext& context) {
-    context.enterMode("SearchMode");
+    context.enterMode("SearchMode", SearchMode::DocumentScope);
+  }
+  
+  void NormalMode::enterSearchModeWithinSelections(EditContext& context) {
+    context.enterMode("SearchMode", SearchMode::SelectionScope);
   }
   
   void NormalMode::enterEditModeByInserting(EditContext& context) {
@@ -447,9 +442,10 @@ namespace quip {
   }
   
   void NormalMode::enterEditModeByInsertingAtStartOfLines(EditContext& context) {
+    const SelectionSet& selections = context.selections();
     std::vector<Selection> adjusted;
-    adjusted.reserve(context.selections().count());
-    for (const Selection& selection : context.selections()) {
+    adjusted.reserve(selections.count());
+    for (const Selection& selection : selections) {
       Location location(0, selection.origin().row());
       adjusted.emplace_back(location);
     }
@@ -463,9 +459,10 @@ namespace quip {
   }
   
   void NormalMode::enterEditModeByAppendingAtEndOfLines(EditContext& context) {
+    const SelectionSet& selections = context.selections();
     std::vector<Selection> adjusted;
-    adjusted.reserve(context.selections().count());
-    for (const Selection& selection : context.selections()) {
+    adjusted.reserve(selections.count());
+    for (const Selection& selection : selections) {
       Location location(context.document().row(selection.extent().row()).size() - 2, selection.extent().row());
       adjusted.emplace_back(location);
     }
@@ -11,26 +11,26 @@ namespace quip {
     std::string status() const override;
 
   private:
-    void doSelectBeforePrimaryOrigin(EditContext& context);
-    void doSelectBelowPrimaryExtent(EditContext& context);
-    void doSelectAfterPrimaryExtent(EditContext& context);
-    void doSelectAbovePrimaryOrigin(EditContext& context);
+    void doSelectBeforePrimaryOrigin(EditContext& context, std::uint32_t count);
+    void doSelectBelowPrimaryExtent(EditContext& context, std::uint32_t count);
+    void doSelectAfterPrimaryExtent(EditContext& context, std::uint32_t count);
+    void doSelectAbovePrimaryOrigin(EditContext& context, std::uint32_t count);
 
-    void doShiftSelectionExtentsLeft(EditContext& context);
-    void doShiftSelectionExtentsDown(EditContext& context);
-    void doShiftSelectionExtentsUp(EditContext& context);
-    void doShiftSelectionExtentsRight(EditContext& context);
+    void doShiftSelectionExtentsLeft(EditContext& context, std::uint32_t count);
+    void doShiftSelectionExtentsDown(EditContext& context, std::uint32_t count);
+    void doShiftSelectionExtentsUp(EditContext& context, std::uint32_t count);
+    void doShiftSelectionExtentsRight(EditContext& context, std::uint32_t count);
 
-    void doShiftSelectionOriginsLeft(EditContext& context);
-    void doShiftSelectionOriginsDown(EditContext& context);
-    void doShiftSelectionOriginsUp(EditContext& context);
-    void doShiftSelectionOriginsRight(EditContext& context);
+    void doShiftSelectionOriginsLeft(EditContext& context, std::uint32_t count);
+    void doShiftSelectionOriginsDown(EditContext& context, std::uint32_t count);
+    void doShiftSelectionOriginsUp(EditContext& context, std::uint32_t count);
+    void doShiftSelectionOriginsRight(EditContext& context, std::uint32_t count);
 
     void doIncreaseSelectionIndentLevel(EditContext& context);
     void doDecreaseSelectionIndentLevel(EditContext& context);
     
-    void doSelectWord(EditContext& context);
-    void doSelectPriorWord(EditContext& context);
+    void doSelectWord(EditContext& context, std::uint32_t count);
+    void doSelectPriorWord(EditContext& context, std::uint32_t count);
     void doSelectRemainingWord(EditContext& context);
     
     void doSelectThisLine(EditContext& context);
@@ -42,13 +42,14 @@ namespace quip {
     
     void enterJumpMode(EditContext& context);
     void enterSearchMode(EditContext& context);
+    void enterSearchModeWithinSelections(EditContext& context);
     void enterEditModeByInserting(EditContext& context);
     void enterEditModeByInsertingAtStartOfLines(EditContext& context);
     void enterEditModeByAppending(EditContext& context);
     void enterEditModeByAppendingAtEndOfLines(EditContext& context);
     
-    void rotateSelectionForward(EditContext& context);
-    void rotateSelectionBackward(EditContext& context);
+    void rotateSelectionForward(EditContext& context, std::uint32_t count);
+    void rotateSelectionBackward(EditContext& context, std::uint32_t count);
     void collapseSelections(EditContext& context);
     
     void deleteSelections(EditContext& context);
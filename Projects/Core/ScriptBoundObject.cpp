@@ -2,84 +2,155 @@
 
 namespace quip {
   namespace {
-    int callMemberFunction(lua_State* state) {
-      ScriptBoundObject* object = reinterpret_cast<ScriptBoundObject*>(lua_touserdata(state, lua_upvalueindex(1)));
-      std::string member = lua_tostring(state, lua_upvalueindex(2));
-      object->callFunction(member, state);
+    ScriptBoundObject* boundObject(lua_State* state, int index) {
+      ScriptBoundObject* object = *reinterpret_cast<ScriptBoundObject**>(lua_touserdata(state, index));
+      if (object == nullptr) {
+        luaL_error(state, "object is no longer bound");
+      }
       
-      return 0;
+      return object;
+    }
+    
+    int callMemberFunction(lua_State* state) {
+      // Functions may be called with either method or field syntax; skip the object argument if
+      // it was passed.
+      int base = lua_rawequal(state, 1, lua_upvalueindex(1)) ? 2 : 1;
+      std::size_t slot = static_cast<std::size_t>(lua_tointeger(state, lua_upvalueindex(2)));
+      return boundObject(state, lua_upvalueindex(1))->callFunction(slot, state, base);
     }
     
     int getBoundObjectMember(lua_State* state) {
-      std::string member = lua_tostring(state, -1);
-      ScriptBoundObject** slot = reinterpret_cast<ScriptBoundObject**>(lua_touserdata(state, -2));
-      ScriptBoundObject* object = *slot;
-
-      if (object->binding().hasFunction(member)) {
-        // If the member is a function, push a closure allowing the eventual call of that function
-        // from Lua to refer back to this specific bound object.
-        lua_pushlightuserdata(state, object);
-        lua_pushstring(state, member.c_str());
-        lua_pushcclosure(state, callMemberFunction, 2);
-      } else {
-        // Otherwise, assume the member is a property getter and invoke that directly.
-        ScriptBoundObject** slot = reinterpret_cast<ScriptBoundObject**>(lua_touserdata(state, -2));
-        ScriptBoundObject* binding = *slot;
-        binding->getPropertyValue(member, state);
+      // The upvalues are the table of function closures and the table of property getter slots,
+      // both keyed by member name.
+      lua_pushvalue(state, 2);
+      if (lua_rawget(state, lua_upvalueindex(1)) != LUA_TNIL) {
+        return 1;
+      }
+      
+      lua_pushvalue(state, 2);
+      if (lua_rawget(state, lua_upvalueindex(2)) == LUA_TNUMBER) {
+        std::size_t slot = static_cast<std::size_t>(lua_tointeger(state, -1));
+        lua_pop(state, 1);
+        return boundObject(state, 1)->getPropertyValue(slot, state);
       }
       
-      return 1;
+      return luaL_error(state, "object has no member '%s'", lua_tostring(state, 2));
     }
     
     int setBoundObjectMember(lua_State* state) {
-      std::string member = lua_tostring(state, -2);
-      ScriptBoundObject** slot = reinterpret_cast<ScriptBoundObject**>(lua_touserdata(state, -3));
-      ScriptBoundObject* binding = *slot;
-      binding->setPropertyValue(member, state);
+      // The upvalue is the table of property setter slots, keyed by member name.
+      lua_pushvalue(state, 2);
+      if (lua_rawget(state, lua_upvalueindex(1)) == LUA_TNUMBER) {
+        std::size_t slot = static_cast<std::size_t>(lua_tointeger(state, -1));
+        lua_pop(state, 1);
+        return boundObject(state, 1)->setPropertyValue(slot, state, 3);
+      }
       
-      return 0;
+      return luaL_error(state, "object has no setter for '%s'", lua_tostring(state, 2));
     }
-    
-    luaL_Reg BoundObjectMetatable[] = {
-      { "__index", getBoundObjectMember },
-      { "__newindex", setBoundObjectMember },
-      { nullptr, nullptr }
-    };
   }
   
   ScriptBoundObject::ScriptBoundObject(void* object, const std::string& name, const LuaBinding& binding, lua_State* state)
   : m_object(object)
-  , m_binding(binding) {
+  , m_name(name)
+  , m_binding(binding)
+  , m_state(state) {
   
     // All bound objects are attached to the Quip global table.
     lua_getglobal(state, "quip");
     
     // The pointer to the object is stored in a heavy userdata (so that it can have a metatable).
-    ScriptBoundObject** slot = reinterpret_cast<ScriptBoundObject**>(lua_newuserdata(state, sizeof(ScriptBoundObject*)));
-    *slot = this;
-
+    // The registry holds a reference to the userdata so the slot stays valid for the lifetime of
+    // this object, even if scripts drop every reference to it.
+    m_slot = reinterpret_cast<ScriptBoundObject**>(lua_newuserdata(state, sizeof(ScriptBoundObject*)));
+    *m_slot = this;
+    int userdata = lua_gettop(state);
+    lua_pushvalue(state, userdata);
+    m_reference = luaL_ref(state, LUA_REGISTRYINDEX);
+    
+    // Build the member tables: function closures, getter slots and setter slots.
+    const std::vector<LuaBinding::Member>& members = m_binding.members();
+    lua_createtable(state, 0, static_cast<int>(members.size()));
+    lua_createtable(state, 0, static_cast<int>(members.size()));
+    lua_createtable(state, 0, static_cast<int>(members.size()));
+    int functions = userdata + 1;
+    int getters = userdata + 2;
+    int setters = userdata + 3;
+    
+    for (std::size_t index = 0; index < members.size(); ++index) {
+      const LuaBinding::Member& member = members[index];
+      if (member.function != nullptr) {
+        lua_pushvalue(state, userdata);
+        lua_pushinteger(state, static_cast<lua_Integer>(index));
+        lua_pushcclosure(state, callMemberFunction, 2);
+        lua_setfield(state, functions, member.name.c_str());
+      }
+      
+      if (member.getter != nullptr) {
+        lua_pushinteger(state, static_cast<lua_Integer>(index));
+        lua_setfield(state, getters, member.name.c_str());
+      }
+      
+      if (member.setter != nullptr) {
+        lua_pushinteger(state, static_cast<lua_Integer>(index));
+        lua_setfield(state, setters, member.name.c_str());
+      }
+    }
+    
     // Create the metatable to hook indexing into the bound object from Lua.
-    lua_newtable(state);
-    luaL_setfuncs(state, BoundObjectMetatable, 0);
-    lua_setmetatable(state, -2);
+    lua_createtable(state, 0, 2);
+    lua_pushvalue(state, functions);
+    lua_pushvalue(state, getters);
+    lua_pushcclosure(state, getBoundObjectMember, 2);
+    lua_setfield(state, -2, "__index");
+    lua_pushvalue(state, setters);
+    lua_pushcclosure(state, setBoundObjectMember, 1);
+    lua_setfield(state, -2, "__newindex");
+    lua_setmetatable(state, userdata);
+    lua_pop(state, 3);
     
     // Insert the bound object's userdata into the Quip global table with the specified name.
     lua_setfield(state, -2, name.c_str());
+    lua_pop(state, 1);
+  }
+  
+  ScriptBoundObject::~ScriptBoundObject() {
+    *m_slot = nullptr;
+    
+    // Only remove the entry from the Quip table if it hasn't since been replaced.
+    lua_getglobal(m_state, "quip");
+    lua_getfield(m_state, -1, m_name.c_str());
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_reference);
+    if (lua_rawequal(m_state, -1, -2)) {
+      lua_pushnil(m_state);
+      lua_setfield(m_state, -4, m_name.c_str());
+    }
+    
+    lua_pop(m_state, 3);
+    luaL_unref(m_state, LUA_REGISTRYINDEX, m_reference);
+  }
+  
+  void* ScriptBoundObject::object() const {
+    return m_object;
+  }
+  
+  const std::string& ScriptBoundObject::name() const {
+    return m_name;
   }
   
   const LuaBinding& ScriptBoundObject::binding() const {
     return m_binding;
   }
   
-  void ScriptBoundObject::callFunction(const std::string& name, lua_State* state) {
-    m_binding.invokeFunction(name, m_object, state);
+  int ScriptBoundObject::callFunction(std::size_t slot, lua_State* state, int base) {
+    return m_binding.members()[slot].function(m_object, state, base);
   }
   
-  void ScriptBoundObject::getPropertyValue(const std::string& key, lua_State* state) {
-    m_binding.invokePropertyGetter(key, m_object, state);
+  int ScriptBoundObject::getPropertyValue(std::size_t slot, lua_State* state) {
+    return m_binding.members()[slot].getter(m_object, state, 0);
   }
   
-  void ScriptBoundObject::setPropertyValue(const std::string& key, lua_State* state) {
-    m_binding.invokePropertySetter(key, m_object, state);
+  int ScriptBoundObject::setPropertyValue(std::size_t slot, lua_State* state, int index) {
+    return m_binding.members()[slot].setter(m_object, state, index);
   }
 }
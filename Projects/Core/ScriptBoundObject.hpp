@@ -3,25 +3,40 @@
 #include "Lua.hpp"
 #include "LuaBinding.hpp"
 
-#include <functional>
+#include <cstddef>
 #include <string>
-#include <experimental/tuple>
-#include <type_traits>
-#include <unordered_map>
-#include <vector>
 
 namespace quip {
+  // A native object exposed to Lua as a member of the global Quip table.
+  //
+  // The object's members are resolved when it is bound: each function gets a cached closure that
+  // refers to its binding slot, and each property name maps to its slot in the metatable, so
+  // accessing a member from Lua is a single table lookup on an interned string.
+  //
+  // Destroying a bound object removes it from the Quip table. Scripts that kept a reference to it
+  // (or to one of its functions) get an error rather than a dangling pointer.
   struct ScriptBoundObject {
     ScriptBoundObject(void* object, const std::string& name, const LuaBinding& type, lua_State* state);
+    ~ScriptBoundObject();
+    
+    ScriptBoundObject(const ScriptBoundObject& other) = delete;
+    ScriptBoundObject& operator=(const ScriptBoundObject& other) = delete;
 
+    void* object() const;
+    const std::string& name() const;
     const LuaBinding& binding() const;
     
-    void callFunction(const std::string& name, lua_State* state);
-    void getPropertyValue(const std::string& key, lua_State* state);
-    void setPropertyValue(const std::string& key, lua_State* state);
+    int callFunction(std::size_t slot, lua_State* state, int base);
+    int getPropertyValue(std::size_t slot, lua_State* state);
+    int setPropertyValue(std::size_t slot, lua_State* state, int index);
 
   private:
     void* m_object;
+    std::string m_name;
     LuaBinding m_binding;
+    
+    lua_State* m_state;
+    ScriptBoundObject** m_slot;
+    int m_reference;
   };
 }
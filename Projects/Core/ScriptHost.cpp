@@ -1,14 +1,26 @@
 #include "ScriptHost.hpp"
 
 #include "AttributeRange.hpp"
+#include "KeystrokeLatency.hpp"
+#include "MemoryAccounting.hpp"
 #include "Script.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
 namespace quip {
   ScriptHost::ScriptHost(const std::string& rootPath)
-  : m_lua(luaL_newstate())
-  , m_root(rootPath) {
+  : ScriptHost(rootPath, "") {
+  }
+  
+  ScriptHost::ScriptHost(const std::string& rootPath, const std::string& cachePath)
+  : m_memoryUsage(0)
+  , m_lua(lua_newstate(&ScriptHost::allocate, this))
+  , m_root(rootPath)
+  , m_bytecodeCache(cachePath) {
+    lua_atpanic(m_lua, &ScriptHost::panic);
     luaL_openlibs(m_lua);
     addScriptPackagePath(rootPath);
     
@@ -17,9 +29,16 @@ namespace quip {
     
     // Store the quip object globally.
     lua_setglobal(m_lua, "quip");
+    
+    // Scripts can capture traces of the instrumented hot paths.
+    bind(&Trace::shared(), "trace");
+    
+    // Scripts can query and dump the latency of key events.
+    bind(&KeystrokeLatency::shared(), "latency");
   }
   
   ScriptHost::~ScriptHost() {
+    m_objects.clear();
     lua_close(m_lua);
   }
   
@@ -27,48 +46,83 @@ namespace quip {
     return m_root;
   }
   
+  const BytecodeCache& ScriptHost::bytecodeCache() const {
+    return m_bytecodeCache;
+  }
+  
+  std::size_t ScriptHost::memoryUsage() const {
+    return m_memoryUsage;
+  }
+  
   Script ScriptHost::getScript(const std::string& path) {
-    lua_getglobal(m_lua, path.c_str());
-    if (lua_isnil(m_lua, -1)) {
+    Script result(path);
+    if (pushScript(result)) {
       lua_pop(m_lua, 1);
-      
-      int result = luaL_loadfile(m_lua, path.c_str());
-      if (result != 0) {
-        std::cerr << lua_tostring(m_lua, -1) << std::endl;
-      } else {
-        lua_setglobal(m_lua, path.c_str());
-      }
     }
     
-    return Script(path);
+    return result;
+  }
+  
+  bool ScriptHost::isLoaded(const Script& script) const {
+    bool result = lua_getglobal(m_lua, script.identifier().c_str()) == LUA_TFUNCTION;
+    lua_pop(m_lua, 1);
+    return result;
   }
   
   void ScriptHost::runScript(const Script& script) {
-    lua_getglobal(m_lua, script.identifier().c_str());
-    if (lua_isnil(m_lua, -1)) {
-      lua_pop(m_lua, 1);
-      std::cerr << "Script not found.\n";
-    }
-    else {
+    if (pushScript(script)) {
+      int top = lua_gettop(m_lua) - 1;
       int result = lua_pcall(m_lua, 0, LUA_MULTRET, 0);
       if (result != 0) {
         std::cerr << lua_tostring(m_lua, -1);
       }
+      
+      lua_settop(m_lua, top);
+    }
+  }
+  
+  void ScriptHost::unbind(const std::string& name) {
+    m_objects.erase(std::remove_if(m_objects.begin(), m_objects.end(), [&name](const std::unique_ptr<ScriptBoundObject>& bound) {
+      return bound->name() == name;
+    }), m_objects.end());
+  }
+  
+  bool ScriptHost::unbind(const std::string& name, const void* object) {
+    for (std::vector<std::unique_ptr<ScriptBoundObject>>::iterator cursor = m_objects.begin(); cursor != m_objects.end(); ++cursor) {
+      if ((*cursor)->name() == name && (*cursor)->object() == object) {
+        m_objects.erase(cursor);
+        return true;
+      }
+    }
+    
+    return false;
+  }
+  
+  bool ScriptHost::execute(const std::string& source) {
+    int top = lua_gettop(m_lua);
+    int result = luaL_loadbuffer(m_lua, source.data(), source.size(), "=execute");
+    if (result == 0) {
+      result = lua_pcall(m_lua, 0, 0, 0);
+    }
+    
+    if (result != 0) {
+      std::cerr << lua_tostring(m_lua, -1) << std::endl;
     }
+    
+    lua_settop(m_lua, top);
+    return result == 0;
   }
   
   std::vector<AttributeRange> ScriptHost::parseSyntax(const Script& script, const std::string& text) {
+    TraceSpan span("ScriptHost::parseSyntax");
+    
     std::vector<AttributeRange> results;
+    int top = lua_gettop(m_lua);
 
-    // Recover the function from the global table and push it into the stack.
-    lua_getglobal(m_lua, script.identifier().c_str());
-    if (lua_isnil(m_lua, -1)) {
-      lua_pop(m_lua, 1);
-      std::cerr << "Script not found.\n";
-    }
-    else {
+    // Recover the function from the global table (loading it if needed) and push it into the stack.
+    if (pushScript(script)) {
       // Push the function's arguments and call the function.
-      lua_pushstring(m_lua, text.c_str());
+      lua_pushlstring(m_lua, text.data(), text.size());
       int result = lua_pcall(m_lua, 1, LUA_MULTRET, 0);
       if (result != 0) {
         std::cerr << lua_tostring(m_lua, -1);
@@ -97,13 +151,11 @@ namespace quip {
             results.emplace_back(name, start, length);
           }
           
-          // Pop the table.
-          lua_pop(m_lua, 1);
         }
-        
       }
     }
     
+    lua_settop(m_lua, top);
     return results;
   }
   
@@ -115,6 +167,35 @@ namespace quip {
     addPackagePath("cpath", path + "/?.so");
   }
   
+  void* ScriptHost::allocate(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize) {
+    ScriptHost* host = static_cast<ScriptHost*>(userData);
+    
+    // When the pointer is null, the old size describes the kind of object being allocated rather
+    // than a size.
+    std::size_t previous = pointer != nullptr ? oldSize : 0;
+    if (newSize == 0) {
+      std::free(pointer);
+      host->m_memoryUsage -= previous;
+      return nullptr;
+    }
+    
+    void* result = std::realloc(pointer, newSize);
+    if (result != nullptr) {
+      host->m_memoryUsage += newSize - previous;
+      if (newSize > previous) {
+        MemoryAccounting::recordAllocation(MemoryCategory::Scripting, newSize);
+      }
+    }
+    
+    return result;
+  }
+  
+  int ScriptHost::panic(lua_State* state) {
+    // Lua aborts when the panic function returns.
+    std::cerr << "Unprotected error in Lua: " << lua_tostring(state, -1) << std::endl;
+    return 0;
+  }
+  
   void ScriptHost::addPackagePath(const std::string& variable, const std::string& path) {
     lua_getglobal(m_lua, "package");
     lua_getfield(m_lua, -1, variable.c_str());
@@ -128,4 +209,30 @@ namespace quip {
     lua_setfield(m_lua, -2, variable.c_str());
     lua_pop(m_lua, 1);
   }
+  
+  bool ScriptHost::pushScript(const Script& script) {
+    // Loaded scripts are stored as globals named for their path. Scripts that failed to load are
+    // stored as false, so the failure is only reported once.
+    int type = lua_getglobal(m_lua, script.identifier().c_str());
+    if (type == LUA_TFUNCTION) {
+      return true;
+    }
+    
+    lua_pop(m_lua, 1);
+    if (type != LUA_TNIL) {
+      return false;
+    }
+    
+    if (m_bytecodeCache.load(m_lua, script.identifier()) != LUA_OK) {
+      std::cerr << lua_tostring(m_lua, -1) << std::endl;
+      lua_pop(m_lua, 1);
+      lua_pushboolean(m_lua, false);
+      lua_setglobal(m_lua, script.identifier().c_str());
+      return false;
+    }
+    
+    lua_pushvalue(m_lua, -1);
+    lua_setglobal(m_lua, script.identifier().c_str());
+    return true;
+  }
 }
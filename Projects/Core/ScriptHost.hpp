@@ -1,6 +1,7 @@
 #pragma once
 
 #include "AttributeRange.hpp"
+#include "BytecodeCache.hpp"
 #include "Lua.hpp"
 #include "ScriptBoundObject.hpp"
 
@@ -14,35 +15,57 @@ namespace quip {
   
   struct ScriptHost {
     ScriptHost(const std::string& rootPath);
+    ScriptHost(const std::string& rootPath, const std::string& cachePath);
     ~ScriptHost();
     
     const std::string& scriptRootPath() const;
+    const BytecodeCache& bytecodeCache() const;
     
+    // Get the number of bytes currently allocated by the Lua heap.
+    std::size_t memoryUsage() const;
+    
+    // Get a script, loading it immediately. Scripts can also be constructed directly from their
+    // path, in which case they are loaded the first time they are run.
     Script getScript(const std::string& path);
+    bool isLoaded(const Script& script) const;
     void runScript(const Script& script);
+    bool execute(const std::string& source);
     
     std::vector<AttributeRange> parseSyntax(const Script& script, const std::string& text);
     
     void addScriptPackagePath(const std::string& path);
     void addNativePackagePath(const std::string& path);
     
+    // Expose an object to scripts as a member of the Quip table, replacing any object already
+    // bound with the same name. The object must be unbound before it is destroyed.
     template<typename ObjectType>
     void bind(ObjectType* object, const std::string& name) {
+      unbind(name);
       m_objects.emplace_back(std::make_unique<ScriptBoundObject>(object, name, ObjectType::binding(), m_lua));
     }
     
+    void unbind(const std::string& name);
+    bool unbind(const std::string& name, const void* object);
+    
     ScriptHost(const ScriptHost& other) = delete;
     ScriptHost(ScriptHost&& other) = delete;
     ScriptHost& operator=(const ScriptHost& other) = delete;
     ScriptHost& operator=(ScriptHost&& other) = delete;
     
   private:
+    // Declared before the Lua state, which allocates as soon as it is created.
+    std::size_t m_memoryUsage;
+    
     lua_State* m_lua;
     std::string m_root;
-    std::unordered_map<std::string, Script> m_cache;
+    BytecodeCache m_bytecodeCache;
     
     std::vector<std::unique_ptr<ScriptBoundObject>> m_objects;
     
+    static void* allocate(void* userData, void* pointer, std::size_t oldSize, std::size_t newSize);
+    static int panic(lua_State* state);
+    
     void addPackagePath(const std::string& variable, const std::string& path);
+    bool pushScript(const Script& script);
   };
 }
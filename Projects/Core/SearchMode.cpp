@@ -7,13 +7,22 @@
 #include "SelectionDrawInfo.hpp"
 
 namespace quip {
-  SearchMode::SearchMode() {
-    addMapping(Key::Escape, &SearchMode::abortSearch);
-    addMapping(Key::Return, &SearchMode::commitSearch);
+  SearchMode::SearchMode()
+  : m_isScoped(false) {
+    addMapping(Key::Escape, "<Esc>", &SearchMode::abortSearch);
+    addMapping(Key::Return, "<Return>", &SearchMode::commitSearch);
   }
   
   std::string SearchMode::status() const {
-    return "s/" + m_search;
+    return (m_isScoped ? "s[]/" : "s/") + m_search;
+  }
+  
+  void SearchMode::onEnter(EditContext& context, std::uint64_t how) {
+    // Copying the selections shares their storage, so entering the mode is cheap even when the
+    // scope is large.
+    m_isScoped = how == SelectionScope;
+    m_scope = m_isScoped ? context.selections() : SelectionSet();
+    m_incrementalSearch.clear();
   }
   
   bool SearchMode::onUnmappedKey(Key key, const std::string& text, EditContext& context) {
@@ -33,13 +42,15 @@ namespace quip {
       SearchExpression expression(m_search);
       if (expression.valid()) {
         SelectionDrawInfo overlay;
-        overlay.selections = context.document().matches(expression);
+        overlay.selections = matches(context, expression);
         overlay.flags = CursorFlags::None;
         overlay.style = CursorStyle::VerticalBlock;
         overlay.primaryColor = Color(1.0f, 1.0f, 0.2f);
         overlay.secondaryColor = Color(1.0f, 1.0f, 0.8f);
         context.setOverlay("Search", overlay);
       }
+    } else {
+      context.clearOverlay("Search");
     }
     
     return true;
@@ -47,16 +58,34 @@ namespace quip {
   
   void SearchMode::abortSearch(EditContext& context) {
     m_search = "";
+    m_scope = SelectionSet();
+    m_incrementalSearch.clear();
     
     context.clearOverlay("Search");
     context.leaveMode();
   }
   
   void SearchMode::commitSearch(EditContext& context) {
-    context.selections().replace(context.document().matches(SearchExpression(m_search)));
+    // Keep the current selections if nothing matched, since the context needs a primary selection.
+    SelectionSet results = matches(context, SearchExpression(m_search));
+    if (results.count() > 0) {
+      context.selections().replace(results);
+    }
+    
     m_search = "";
+    m_scope = SelectionSet();
+    m_incrementalSearch.clear();
 
     context.clearOverlay("Search");
     context.leaveMode();
   }
+  
+  SelectionSet SearchMode::matches(EditContext& context, const SearchExpression& expression) {
+    // Each key typed or deleted refines or restores the previous matches where possible.
+    if (m_isScoped) {
+      return m_incrementalSearch.matches(context.document(), expression, m_scope);
+    }
+    
+    return m_incrementalSearch.matches(context.document(), expression);
+  }
 }
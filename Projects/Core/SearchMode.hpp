@@ -1,22 +1,36 @@
 #pragma once
 
+#include "IncrementalSearch.hpp"
 #include "Mode.hpp"
+#include "SelectionSet.hpp"
 
 namespace quip {
   struct EditContext;
+  struct SearchExpression;
   
   struct SearchMode : Mode {
     SearchMode ();
     
     std::string status () const override;
     
+    // Search the whole document, or only the text selected when the mode is entered.
+    static constexpr std::uint64_t DocumentScope = 0;
+    static constexpr std::uint64_t SelectionScope = 1;
+    
   protected:
+    void onEnter (EditContext & context, std::uint64_t how) override;
+
     bool onUnmappedKey (Key key, const std::string & text, EditContext & context) override;
     
   private:
     void abortSearch (EditContext & context);
     void commitSearch (EditContext & context);
     
+    SelectionSet matches (EditContext & context, const SearchExpression & expression);
+    
     std::string m_search;
+    bool m_isScoped;
+    SelectionSet m_scope;
+    IncrementalSearch m_incrementalSearch;
   };
 }
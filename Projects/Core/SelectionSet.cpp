@@ -1,53 +1,109 @@
 #include "SelectionSet.hpp"
 
+#include "Document.hpp"
+#include "DocumentIterator.hpp"
+#include "MemoryAccounting.hpp"
+#include "SearchExpression.hpp"
 #include "Selection.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 namespace {
+  // Smaller sets are compared directly; the radix sort's fixed passes only pay off for larger ones.
+  static const std::size_t RadixSortThreshold = 256;
+  
+  struct PackedSelection {
+    std::uint64_t origin;
+    std::uint64_t extent;
+  };
+  
   static bool compareSelectionsByLowestLocation(const quip::Selection& left, const quip::Selection& right) {
     return left.origin() < right.origin();
   }
+  
+  // Sort selections by origin. Large sets are radix sorted on their packed origin keys, one byte
+  // per pass, skipping the bytes that every key shares (usually the high bytes of rows and
+  // columns).
+  static void sortSelectionsByOrigin(std::vector<quip::Selection>& selections) {
+    if (selections.size() < RadixSortThreshold) {
+      std::sort(selections.begin(), selections.end(), compareSelectionsByLowestLocation);
+      return;
+    }
+    
+    std::vector<PackedSelection> packed;
+    packed.reserve(selections.size());
+    
+    std::array<std::array<std::size_t, 256>, 8> histograms = {};
+    for (const quip::Selection& selection : selections) {
+      std::uint64_t origin = selection.origin().key();
+      packed.push_back(PackedSelection { origin, selection.extent().key() });
+      for (std::size_t byte = 0; byte < 8; ++byte) {
+        ++histograms[byte][(origin >> (byte * 8)) & 0xFF];
+      }
+    }
+    
+    std::vector<PackedSelection> buffer(packed.size());
+    for (std::size_t byte = 0; byte < 8; ++byte) {
+      std::array<std::size_t, 256>& histogram = histograms[byte];
+      std::size_t first = (packed[0].origin >> (byte * 8)) & 0xFF;
+      if (histogram[first] == packed.size()) {
+        continue;
+      }
+      
+      std::size_t offset = 0;
+      for (std::size_t& count : histogram) {
+        std::size_t bucket = count;
+        count = offset;
+        offset += bucket;
+      }
+      
+      for (const PackedSelection& selection : packed) {
+        buffer[histogram[(selection.origin >> (byte * 8)) & 0xFF]++] = selection;
+      }
+      
+      packed.swap(buffer);
+    }
+    
+    for (std::size_t index = 0; index < packed.size(); ++index) {
+      selections[index] = quip::Selection(quip::Location::fromKey(packed[index].origin), quip::Location::fromKey(packed[index].extent));
+    }
+  }
+  
+  // Empty sets share one storage, so creating them does not allocate.
+  static const std::shared_ptr<std::vector<quip::Selection>>& emptySelections() {
+    static const std::shared_ptr<std::vector<quip::Selection>> selections = std::make_shared<std::vector<quip::Selection>>();
+    return selections;
+  }
+  
+  static std::shared_ptr<std::vector<quip::Selection>> makeSelections(std::vector<quip::Selection>&& selections) {
+    quip::MemoryScope scope(quip::MemoryCategory::Selections);
+    return std::make_shared<std::vector<quip::Selection>>(std::move(selections));
+  }
 }
 
 namespace quip {
   SelectionSet::SelectionSet()
-  : m_primary(0) {
+  : m_selections(emptySelections())
+  , m_primary(0) {
   }
   
   SelectionSet::SelectionSet(const Selection& selection)
-  : m_selections({selection})
+  : m_selections(makeSelections({selection}))
   , m_primary(0) {
   }
   
   SelectionSet::SelectionSet(const std::vector<Selection>& selections)
-  : m_selections(selections)
+  : m_selections(makeSelections(std::vector<Selection>(selections)))
   , m_primary(0) {
-    std::sort(m_selections.begin(), m_selections.end(), compareSelectionsByLowestLocation);
-    
-    if (m_selections.size() >= 2) {
-      std::vector<Selection> collapsed;
-      collapsed.reserve(selections.size());
-      
-      std::size_t basis = 0;
-      std::size_t candidate = 1;
-      while (basis < m_selections.size() && candidate < m_selections.size()) {
-        if (m_selections[basis].extent() >= m_selections[candidate].origin()) {
-          // The two selections overlap and should be collapsed. Subsequent selections may also overlap the new combined
-          // selection, so only the candidate index is advanced.
-          m_selections[basis] = Selection(m_selections[basis].origin(), m_selections[candidate].extent());
-          ++candidate;
-        } else {
-          // The selections don't overlap, so finalize the first selection and move both indices along.
-          collapsed.emplace_back(m_selections[basis]);
-          basis = candidate++;
-        }
-        
-        if (candidate >= m_selections.size()) {
-          collapsed.emplace_back(m_selections[basis]);
-        }
-      }
-
-      m_selections = collapsed;
-    }
+    collapse();
+  }
+  
+  SelectionSet::SelectionSet(std::vector<Selection>&& selections)
+  : m_selections(makeSelections(std::move(selections)))
+  , m_primary(0) {
+    collapse();
   }
   
   SelectionSet::SelectionSet(const SelectionSet& other)
@@ -58,6 +114,7 @@ namespace quip {
   SelectionSet::SelectionSet(SelectionSet&& other)
   : m_selections(std::move(other.m_selections))
   , m_primary(other.m_primary) {
+    other.m_selections = emptySelections();
     other.m_primary = 0;
   }
   
@@ -68,26 +125,30 @@ namespace quip {
   }
   
   SelectionSet& SelectionSet::operator=(SelectionSet&& other) {
-    m_selections = std::move(other.m_selections);
-    m_primary = other.m_primary;
-    other.m_primary = 0;
+    if (this != &other) {
+      m_selections = std::move(other.m_selections);
+      m_primary = other.m_primary;
+      other.m_selections = emptySelections();
+      other.m_primary = 0;
+    }
+    
     return *this;
   }
   
   std::size_t SelectionSet::count() const {
-    return m_selections.size();
+    return m_selections->size();
   }
   
   const Selection& SelectionSet::primary() const {
-    return m_selections[m_primary];
+    return (*m_selections)[m_primary];
   }
   
   Selection& SelectionSet::operator[](std::size_t index) {
-    return m_selections[index];
+    return mutableSelections()[index];
   }
   
   const Selection& SelectionSet::operator[](std::size_t index) const {
-    return m_selections[index];
+    return (*m_selections)[index];
   }
   
   SelectionSetIterator SelectionSet::begin() {
@@ -99,36 +160,196 @@ namespace quip {
   }
   
   SelectionSetIterator SelectionSet::end() {
-    return SelectionSetIterator(*this, m_selections.size());
+    return SelectionSetIterator(*this, m_selections->size());
   }
   
   ConstSelectionSetIterator SelectionSet::end() const {
-    return ConstSelectionSetIterator(*this, m_selections.size());
+    return ConstSelectionSetIterator(*this, m_selections->size());
   }
 
   void SelectionSet::rotateForward() {
-    m_primary = (m_primary + 1) % m_selections.size();
+    m_primary = (m_primary + 1) % m_selections->size();
   }
   
   void SelectionSet::rotateBackward() {
     if (m_primary == 0) {
-      m_primary = m_selections.size() - 1;
+      m_primary = m_selections->size() - 1;
     } else {
       m_primary -= 1;
     }
   }
   
   void SelectionSet::replace(const Selection& primary) {
-    m_selections.clear();
-    m_selections.emplace_back(primary);
+    MemoryScope scope(MemoryCategory::Selections);
+    if (m_selections.use_count() == 1) {
+      m_selections->clear();
+      m_selections->emplace_back(primary);
+    } else {
+      m_selections = std::make_shared<std::vector<Selection>>(1, primary);
+    }
+    
     m_primary = 0;
   }
   
   void SelectionSet::replace(const SelectionSet& selections) {
-    m_selections.clear();
-    
-    // The source selection set will already be sorted and collapsed.
-    m_selections.insert(m_selections.begin(), selections.begin(), selections.end());
+    // The source selection set will already be sorted and collapsed, so its storage is shared.
+    m_selections = selections.m_selections;
     m_primary = selections.m_primary;
   }
-}
+  
+  SelectionSet SelectionSet::unionWith(const SelectionSet& other) const {
+    const std::vector<Selection>& left = *m_selections;
+    const std::vector<Selection>& right = *other.m_selections;
+    std::vector<Selection> results;
+    results.reserve(left.size() + right.size());
+    
+    // Take the selection with the lowest origin from either set, merging it into the last result
+    // if they overlap (as collapsing would).
+    std::size_t leftIndex = 0;
+    std::size_t rightIndex = 0;
+    while (leftIndex < left.size() || rightIndex < right.size()) {
+      bool takeLeft = rightIndex == right.size() || (leftIndex < left.size() && left[leftIndex].origin() <= right[rightIndex].origin());
+      const Selection& candidate = takeLeft ? left[leftIndex++] : right[rightIndex++];
+      if (!results.empty() && results.back().extent() >= candidate.origin()) {
+        if (candidate.extent() > results.back().extent()) {
+          results.back() = Selection(results.back().origin(), candidate.extent());
+        }
+      } else {
+        results.emplace_back(candidate);
+      }
+    }
+    
+    return fromCollapsed(std::move(results));
+  }
+  
+  SelectionSet SelectionSet::intersectionWith(const SelectionSet& other) const {
+    const std::vector<Selection>& left = *m_selections;
+    const std::vector<Selection>& right = *other.m_selections;
+    std::vector<Selection> results;
+    
+    // Neither set overlaps itself, so whichever of the current pair ends first cannot overlap
+    // anything after the other.
+    std::size_t leftIndex = 0;
+    std::size_t rightIndex = 0;
+    while (leftIndex < left.size() && rightIndex < right.size()) {
+      const Selection& a = left[leftIndex];
+      const Selection& b = right[rightIndex];
+      if (a.origin() <= b.extent() && b.origin() <= a.extent()) {
+        results.emplace_back(std::max(a.origin(), b.origin()), std::min(a.extent(), b.extent()));
+      }
+      
+      if (a.extent() < b.extent()) {
+        ++leftIndex;
+      } else {
+        ++rightIndex;
+      }
+    }
+    
+    return fromCollapsed(std::move(results));
+  }
+  
+  SelectionSet SelectionSet::difference(const SelectionSet& other, const Document& document) const {
+    const std::vector<Selection>& left = *m_selections;
+    const std::vector<Selection>& right = *other.m_selections;
+    std::vector<Selection> results;
+    
+    std::size_t rightIndex = 0;
+    for (const Selection& selection : left) {
+      while (rightIndex < right.size() && right[rightIndex].extent() < selection.origin()) {
+        ++rightIndex;
+      }
+      
+      // Cut each overlapping selection out of this one, keeping the pieces before each cut. The
+      // document determines the characters on either side of a cut.
+      Location origin = selection.origin();
+      bool isRemaining = true;
+      for (std::size_t index = rightIndex; index < right.size() && right[index].origin() <= selection.extent(); ++index) {
+        const Selection& cut = right[index];
+        if (cut.origin() > origin) {
+          results.emplace_back(origin, (--document.at(cut.origin())).location());
+        }
+        
+        if (cut.extent() >= selection.extent()) {
+          isRemaining = false;
+          break;
+        }
+        
+        origin = (++document.at(cut.extent())).location();
+      }
+      
+      if (isRemaining) {
+        results.emplace_back(origin, selection.extent());
+      }
+    }
+    
+    return fromCollapsed(std::move(results));
+  }
+  
+  SelectionSet SelectionSet::complement(const Document& document) const {
+    if (document.isEmpty()) {
+      return SelectionSet();
+    }
+    
+    SelectionSet everything(Selection(document.begin().location(), (--document.end()).location()));
+    return everything.difference(*this, document);
+  }
+  
+  SelectionSet SelectionSet::matching(const SearchExpression& expression, const Document& document) const {
+    std::vector<Selection> results;
+    if (!expression.valid()) {
+      return fromCollapsed(std::move(results));
+    }
+    
+    for (const Selection& selection : *m_selections) {
+      std::string text = document.contents(selection);
+      if (std::regex_search(text, expression.pattern())) {
+        results.emplace_back(selection);
+      }
+    }
+    
+    return fromCollapsed(std::move(results));
+  }
+  
+  std::size_t SelectionSet::memoryUsage() const {
+    return m_selections->capacity() * sizeof(Selection);
+  }
+  
+  SelectionSet SelectionSet::fromCollapsed(std::vector<Selection>&& selections) {
+    SelectionSet result;
+    if (!selections.empty()) {
+      result.m_selections = makeSelections(std::move(selections));
+    }
+    
+    return result;
+  }
+  
+  std::vector<Selection>& SelectionSet::mutableSelections() {
+    if (m_selections.use_count() > 1) {
+      MemoryScope scope(MemoryCategory::Selections);
+      m_selections = makeSelections(std::vector<Selection>(*m_selections));
+    }
+    
+    return *m_selections;
+  }
+  
+  void SelectionSet::collapse() {
+    std::vector<Selection>& selections = mutableSelections();
+    sortSelectionsByOrigin(selections);
+    if (selections.size() < 2) {
+      return;
+    }
+    
+    // Collapse in place: the basis is the last finalized selection, and each candidate is either
+    // merged into it (if they overlap) or becomes the next basis.
+    std::size_t basis = 0;
+    for (std::size_t candidate = 1; candidate < selections.size(); ++candidate) {
+      if (selections[basis].extent() >= selections[candidate].origin()) {
+        selections[basis] = Selection(selections[basis].origin(), std::max(selections[basis].extent(), selections[candidate].extent()));
+      } else if (++basis != candidate) {
+        selections[basis] = selections[candidate];
+      }
+    }
+    
+    selections.erase(selections.begin() + basis + 1, selections.end());
+  }
+}
\ No newline at end of file
@@ -3,13 +3,25 @@
 #include "Selection.hpp"
 #include "SelectionSetIterator.hpp"
 
+#include <memory>
 #include <vector>
 
 namespace quip {
+  struct Document;
+  struct SearchExpression;
+  
+  // A sorted, collapsed set of selections with a primary selection.
+  //
+  // Selection sets are copied freely (into transactions, overlays and draw info), so copies share
+  // their storage, which is only cloned when a set that shares it is mutated. Indexing or iterating
+  // a mutable set counts as mutating it, so code that only reads should go through a const
+  // reference. A reference to a selection obtained from a mutable set is invalidated by copying the
+  // set.
   struct SelectionSet {
     SelectionSet ();
     explicit SelectionSet (const Selection & selection);
     explicit SelectionSet (const std::vector<Selection> & selections);
+    explicit SelectionSet (std::vector<Selection> && selections);
     SelectionSet (const SelectionSet & other);
     SelectionSet (SelectionSet && other);
     
@@ -34,8 +46,30 @@ namespace quip {
     void replace (const Selection & primary);
     void replace (const SelectionSet & selections);
     
+    // Combine the characters selected by two sets. Both sets are sorted and collapsed, so each
+    // operation is a single merge pass over them. The resulting set may be empty, and its primary
+    // selection is its first.
+    SelectionSet unionWith (const SelectionSet & other) const;
+    SelectionSet intersectionWith (const SelectionSet & other) const;
+    SelectionSet difference (const SelectionSet & other, const Document & document) const;
+    
+    // Get the characters of the document that are not selected.
+    SelectionSet complement (const Document & document) const;
+    
+    // Get the selections whose text contains a match for the expression.
+    SelectionSet matching (const SearchExpression & expression, const Document & document) const;
+    
+    // Estimate the heap memory held by the selections. Storage shared with other sets is counted in
+    // full.
+    std::size_t memoryUsage () const;
+    
   private:
-    std::vector<Selection> m_selections;
+    std::shared_ptr<std::vector<Selection>> m_selections;
     std::size_t m_primary;
+    
+    static SelectionSet fromCollapsed (std::vector<Selection> && selections);
+    
+    std::vector<Selection> & mutableSelections ();
+    void collapse ();
   };
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "SelectionTree.hpp"
+
+#include "SelectionSet.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace quip {
+  struct SelectionTreeNode {
+    Selection selection;
+    std::uint64_t priority;
+    std::size_t count;
+    std::shared_ptr<const SelectionTreeNode> left;
+    std::shared_ptr<const SelectionTreeNode> right;
+
+    SelectionTreeNode(const Selection& selection, std::uint64_t priority, std::shared_ptr<const SelectionTreeNode> left, std::shared_ptr<const SelectionTreeNode> right)
+    : selection(selection)
+    , priority(priority)
+    , count(1 + (left ? left->count : 0) + (right ? right->count : 0))
+    , left(std::move(left))
+    , right(std::move(right)) {
+    }
+  };
+
+  namespace {
+    typedef std::shared_ptr<const SelectionTreeNode> NodePointer;
+
+    std::uint64_t priorityOf(const Location& location) {
+      // Selections in a tree never share an origin, so a hash of the origin is a suitable
+      // priority, and keeps the shape of the tree independent of the order of operations.
+      std::uint64_t value = (location.row() << 32) ^ location.column();
+      value += 0x9e3779b97f4a7c15ULL;
+      value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+      return value ^ (value >> 31);
+    }
+
+    NodePointer makeNode(const Selection& selection, NodePointer left, NodePointer right) {
+      return std::make_shared<const SelectionTreeNode>(selection, priorityOf(selection.origin()), std::move(left), std::move(right));
+    }
+
+    NodePointer withChildren(const NodePointer& node, NodePointer left, NodePointer right) {
+      return std::make_shared<const SelectionTreeNode>(node->selection, node->priority, std::move(left), std::move(right));
+    }
+
+    // Split a tree into the selections whose origins are before the key (or at or before it, if
+    // inclusive) and the remainder.
+    std::pair<NodePointer, NodePointer> split(const NodePointer& node, const Location& key, bool inclusive) {
+      if (!node) {
+        return std::make_pair(NodePointer(), NodePointer());
+      }
+
+      bool goesLeft = inclusive ? node->selection.origin() <= key : node->selection.origin() < key;
+      if (goesLeft) {
+        std::pair<NodePointer, NodePointer> parts = split(node->right, key, inclusive);
+        return std::make_pair(withChildren(node, node->left, std::move(parts.first)), std::move(parts.second));
+      }
+
+      std::pair<NodePointer, NodePointer> parts = split(node->left, key, inclusive);
+      return std::make_pair(std::move(parts.first), withChildren(node, std::move(parts.second), node->right));
+    }
+
+    // Join two trees, where every selection in the left tree precedes every selection in the
+    // right tree.
+    NodePointer join(const NodePointer& left, const NodePointer& right) {
+      if (!left) {
+        return right;
+      } else if (!right) {
+        return left;
+      }
+
+      if (left->priority > right->priority) {
+        return withChildren(left, left->left, join(left->right, right));
+      }
+
+      return withChildren(right, join(left, right->left), right->right);
+    }
+
+    const Selection& firstOf(const NodePointer& node) {
+      const SelectionTreeNode* cursor = node.get();
+      while (cursor->left) {
+        cursor = cursor->left.get();
+      }
+
+      return cursor->selection;
+    }
+
+    const Selection& lastOf(const NodePointer& node) {
+      const SelectionTreeNode* cursor = node.get();
+      while (cursor->right) {
+        cursor = cursor->right.get();
+      }
+
+      return cursor->selection;
+    }
+
+    NodePointer withoutFirst(const NodePointer& node) {
+      if (!node->left) {
+        return node->right;
+      }
+
+      return withChildren(node, withoutFirst(node->left), node->right);
+    }
+
+    NodePointer withoutLast(const NodePointer& node) {
+      if (!node->right) {
+        return node->left;
+      }
+
+      return withChildren(node, node->left, withoutLast(node->right));
+    }
+
+    // Make the node at the specified index of a sorted selection set, and its subtrees, given the
+    // indices of each node's children (where an index past the end means no child).
+    NodePointer buildNode(std::size_t index, const SelectionSet& selections, const std::vector<std::uint64_t>& priorities, const std::vector<std::size_t>& lefts, const std::vector<std::size_t>& rights) {
+      if (index == selections.count()) {
+        return NodePointer();
+      }
+
+      NodePointer left = buildNode(lefts[index], selections, priorities, lefts, rights);
+      NodePointer right = buildNode(rights[index], selections, priorities, lefts, rights);
+      return std::make_shared<const SelectionTreeNode>(selections[index], priorities[index], std::move(left), std::move(right));
+    }
+
+    void collect(const NodePointer& node, std::vector<Selection>& results) {
+      if (!node) {
+        return;
+      }
+
+      collect(node->left, results);
+      results.emplace_back(node->selection);
+      collect(node->right, results);
+    }
+
+    void collectRows(const NodePointer& node, std::uint64_t firstRow, std::uint64_t lastRow, std::vector<Selection>& results) {
+      if (!node) {
+        return;
+      }
+
+      // Selections don't overlap, so both origins and extents increase from left to right. If this
+      // selection ends before the range, so does everything to its left; if it starts after the
+      // range, so does everything to its right.
+      const Selection& selection = node->selection;
+      bool endsBefore = selection.extent().row() < firstRow;
+      bool startsAfter = selection.origin().row() > lastRow;
+      if (!endsBefore) {
+        collectRows(node->left, firstRow, lastRow, results);
+      }
+
+      if (!endsBefore && !startsAfter) {
+        results.emplace_back(selection);
+      }
+
+      if (!startsAfter) {
+        collectRows(node->right, firstRow, lastRow, results);
+      }
+    }
+  }
+
+  SelectionTree::SelectionTree() {
+  }
+
+  SelectionTree::SelectionTree(const Selection& selection)
+  : m_root(makeNode(selection, NodePointer(), NodePointer())) {
+  }
+
+  SelectionTree::SelectionTree(const SelectionSet& selections) {
+    // Selection sets are already sorted and collapsed, so the tree can be built in linear time
+    // rather than by joining each selection in turn. The spine holds the right edge of the tree
+    // built so far; each selection adopts the spine nodes of lower priority as its left subtree.
+    // Nodes are immutable, so the shape is found first and the nodes made afterwards.
+    std::size_t count = selections.count();
+    if (count == 0) {
+      return;
+    }
+
+    const std::size_t none = count;
+    std::vector<std::uint64_t> priorities(count);
+    std::vector<std::size_t> lefts(count, none);
+    std::vector<std::size_t> rights(count, none);
+    std::vector<std::size_t> spine;
+    for (std::size_t index = 0; index < count; ++index) {
+      priorities[index] = priorityOf(selections[index].origin());
+
+      std::size_t child = none;
+      while (!spine.empty() && priorities[spine.back()] <= priorities[index]) {
+        child = spine.back();
+        spine.pop_back();
+      }
+
+      lefts[index] = child;
+      if (!spine.empty()) {
+        rights[spine.back()] = index;
+      }
+
+      spine.push_back(index);
+    }
+
+    m_root = buildNode(spine.front(), selections, priorities, lefts, rights);
+  }
+
+  bool SelectionTree::isEmpty() const {
+    return !m_root;
+  }
+
+  std::size_t SelectionTree::count() const {
+    return m_root ? m_root->count : 0;
+  }
+
+  const Selection& SelectionTree::operator[](std::size_t index) const {
+    const SelectionTreeNode* cursor = m_root.get();
+    for (;;) {
+      std::size_t leftCount = cursor->left ? cursor->left->count : 0;
+      if (index < leftCount) {
+        cursor = cursor->left.get();
+      } else if (index == leftCount) {
+        return cursor->selection;
+      } else {
+        index -= leftCount + 1;
+        cursor = cursor->right.get();
+      }
+    }
+  }
+
+  void SelectionTree::add(const Selection& selection) {
+    Location origin = selection.origin();
+    Location extent = selection.extent();
+
+    // At most one selection starting before the new one can overlap it, since existing selections
+    // don't overlap each other.
+    std::pair<NodePointer, NodePointer> outer = split(m_root, origin, false);
+    if (outer.first) {
+      const Selection& prior = lastOf(outer.first);
+      if (prior.extent() >= origin) {
+        origin = prior.origin();
+        extent = std::max(extent, prior.extent());
+        outer.first = withoutLast(outer.first);
+      }
+    }
+
+    // Every selection starting within the new one is absorbed into it.
+    std::pair<NodePointer, NodePointer> inner = split(outer.second, extent, true);
+    if (inner.first) {
+      extent = std::max(extent, lastOf(inner.first).extent());
+    }
+
+    NodePointer node = makeNode(Selection(origin, extent), NodePointer(), NodePointer());
+    m_root = join(join(outer.first, node), inner.second);
+  }
+
+  bool SelectionTree::remove(const Selection& selection) {
+    std::pair<NodePointer, NodePointer> parts = split(m_root, selection.origin(), false);
+    if (!parts.second || firstOf(parts.second) != selection) {
+      return false;
+    }
+
+    m_root = join(parts.first, withoutFirst(parts.second));
+    return true;
+  }
+
+  Optional<Selection> SelectionTree::containing(const Location& location) const {
+    // Find the last selection starting at or before the location.
+    const SelectionTreeNode* candidate = nullptr;
+    const SelectionTreeNode* cursor = m_root.get();
+    while (cursor != nullptr) {
+      if (cursor->selection.origin() <= location) {
+        candidate = cursor;
+        cursor = cursor->right.get();
+      } else {
+        cursor = cursor->left.get();
+      }
+    }
+
+    if (candidate == nullptr || candidate->selection.extent() < location) {
+      return Optional<Selection>();
+    }
+
+    return candidate->selection;
+  }
+
+  std::vector<Selection> SelectionTree::intersectingRows(std::uint64_t firstRow, std::uint64_t lastRow) const {
+    std::vector<Selection> results;
+    collectRows(m_root, firstRow, lastRow, results);
+    return results;
+  }
+
+  std::vector<Selection> SelectionTree::selections() const {
+    std::vector<Selection> results;
+    results.reserve(count());
+    collect(m_root, results);
+    return results;
+  }
+
+  SelectionSet SelectionTree::toSelectionSet() const {
+    return SelectionSet(selections());
+  }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Optional.hpp"
+#include "Selection.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace quip {
+  struct SelectionSet;
+  struct SelectionTreeNode;
+
+  // A sorted collection of non-overlapping selections, intended for very large numbers of
+  // selections.
+  //
+  // Unlike a selection set, which re-sorts and re-collapses its entire contents whenever it is
+  // built, the tree adds, removes and merges individual selections in logarithmic time. Adding a
+  // selection that overlaps existing selections merges them, just as constructing a selection set
+  // does.
+  //
+  // The tree is a treap of immutable nodes. Modifying a tree copies only the nodes along the
+  // modified paths, and copying a tree copies only its root, so snapshots (for example, one per
+  // undo state) share almost all of their structure.
+  //
+  // Edit contexts still keep their selections in selection sets; the tree is not yet used by the
+  // draw path or by undo snapshots.
+  struct SelectionTree {
+    SelectionTree();
+    explicit SelectionTree(const Selection& selection);
+    explicit SelectionTree(const SelectionSet& selections);
+
+    bool isEmpty() const;
+    std::size_t count() const;
+
+    const Selection& operator[](std::size_t index) const;
+
+    // Add a selection, merging it with any selections it overlaps.
+    void add(const Selection& selection);
+
+    // Remove a selection. Returns true if the selection was present.
+    bool remove(const Selection& selection);
+
+    // Get the selection containing the specified location, if any.
+    Optional<Selection> containing(const Location& location) const;
+
+    // Get the selections that cover any part of the specified (inclusive) range of rows.
+    std::vector<Selection> intersectingRows(std::uint64_t firstRow, std::uint64_t lastRow) const;
+
+    std::vector<Selection> selections() const;
+    SelectionSet toSelectionSet() const;
+
+  private:
+    std::shared_ptr<const SelectionTreeNode> m_root;
+  };
+}
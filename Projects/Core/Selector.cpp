@@ -24,22 +24,6 @@ namespace quip {
       return !isEndItemCharacter(character);
     }
     
-    bool isOpenBlockCharacter(char character) {
-      return character == '{' || character == '[' || character == '<';
-    }
-    
-    bool isNotOpenBlockCharacter(char character) {
-      return !isOpenBlockCharacter(character);
-    }
-    
-    bool isCloseBlockCharacter(char character) {
-      return character == '}' || character == ']' || character == '>';
-    }
-    
-    bool isNotCloseBlockCharacter(char character) {
-      return !isCloseBlockCharacter(character);
-    }
-    
     bool isWordCharacter(char character) {
       return std::isalnum(character);
     }
@@ -54,7 +38,7 @@ namespace quip {
       if (!result.isEnd()) {
         // Try to select any (appropriate) trailing whitespace as well.
         result = std::next(result);
-        if (isWhitespaceExceptNewline(*result)) {
+        if (!result.isEnd() && isWhitespaceExceptNewline(*result)) {
           result = Traversal::advanceWhile(result, isWhitespaceExceptNewline);
         } else {
           result = std::prev(result);
@@ -109,6 +93,42 @@ namespace quip {
     return selectWord(basis, head, tail);
   }
 
+  Optional<Selection> selectThisOrNextWord(const Document& document, const Selection& basis, std::size_t count) {
+    Optional<Selection> result = selectThisOrNextWord(document, basis);
+    if (!result.has_value() || count <= 1) {
+      return result;
+    }
+    
+    // After the first step the result is always a full word selection, so each subsequent step
+    // selects the following word. That word runs up to the start of the word after it.
+    const WordIndex& words = document.words();
+    Optional<Location> origin = words.nextWordStart(result->extent(), count - 1);
+    if (!origin.has_value()) {
+      return result;
+    }
+    
+    Optional<Location> next = words.nextWordStart(*origin, 1);
+    DocumentIterator extent = next.has_value() ? std::prev(document.at(*next)) : std::prev(document.end());
+    return Optional<Selection>(Selection(*origin, extent.location()));
+  }
+  
+  Optional<Selection> selectPriorWord(const Document& document, const Selection& basis, std::size_t count) {
+    Optional<Selection> result = selectPriorWord(document, basis);
+    if (!result.has_value() || count <= 1) {
+      return result;
+    }
+    
+    const WordIndex& words = document.words();
+    Optional<Location> extent = words.priorWordEnd(result->origin(), count - 1);
+    if (!extent.has_value()) {
+      return result;
+    }
+    
+    Optional<Location> prior = words.priorWordEnd(*extent, 1);
+    DocumentIterator origin = prior.has_value() ? std::next(document.at(*prior)) : document.begin();
+    return Optional<Selection>(Selection(origin.location(), *extent));
+  }
+
   Optional<Selection> selectRemainingWord(const Document& document, const Selection& basis) {
     if (document.isEmpty()) {
       return Optional<Selection>();
@@ -154,19 +174,14 @@ namespace quip {
       return Optional<Selection>();
     }
     
-    DocumentIterator origin = document.at(basis.origin());
-    origin = Traversal::retreatWhile(origin, isNotOpenBlockCharacter);
-    
-    DocumentIterator extent = document.at(basis.extent());
-    extent = Traversal::advanceWhile(extent, isNotCloseBlockCharacter);
-    
-    if(basis.origin() == origin.location() && basis.extent() == extent.location() && origin != document.begin() && extent != document.end()) {
-      --origin;
-      ++extent;
-      return selectBlocks(document, Selection(origin.location(), extent.location()));
+    // If the basis is already a full block selection, the enclosing block is selected instead. When
+    // there is no enclosing block, the entire document is.
+    Optional<Selection> pair = document.brackets().enclosingPair(basis);
+    if (pair.has_value()) {
+      return pair;
     }
     
-    return Optional<Selection>(Selection(origin.location(), extent.location()));
+    return Optional<Selection>(Selection(document.begin(), std::prev(document.end())));
   }
   
   Optional<Selection> selectItem(const Document& document, const Selection& basis) {
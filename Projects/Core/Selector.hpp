@@ -2,6 +2,8 @@
 
 #include "Optional.hpp"
 
+#include <cstddef>
+
 namespace quip {
   struct Document;
   struct Location;
@@ -10,6 +12,11 @@ namespace quip {
   Optional<Selection> selectThisOrNextWord(const Document& document, const Selection& basis);
   Optional<Selection> selectPriorWord(const Document& document, const Selection& basis);
   
+  // Select the Nth word after (or before) the basis, as if by repeating the single-word selectors
+  // the specified number of times.
+  Optional<Selection> selectThisOrNextWord(const Document& document, const Selection& basis, std::size_t count);
+  Optional<Selection> selectPriorWord(const Document& document, const Selection& basis, std::size_t count);
+  
   Optional<Selection> selectRemainingWord(const Document& document, const Selection& basis);
   
   Optional<Selection> selectThisOrNextLine(const Document& document, const Selection& basis);
@@ -1,6 +1,14 @@
 #pragma once
 
-#include <functional>
+#include "InplaceFunction.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace quip {
   template<typename> struct Signal;
@@ -10,92 +18,187 @@ namespace quip {
   // order. Connected listeners are assigned a token when connected which can be used to
   // disconnect the listener at a later date. Tokens are unsigned 32-bit integers beginning
   // at one (zero can be used to indicate an invalid or unassigned token).
+  //
+  // Listeners are stored contiguously in an immutable table. Transmitting takes a snapshot of the
+  // current table and dispatches from it without allocating, so listeners may connect or disconnect
+  // (from within a transmission, or from another thread) without disturbing it. Taking the snapshot
+  // is not lock-free: the standard libraries implement the atomic shared_ptr operations with a
+  // short internal lock, which is held only while the reference count is taken. A new
+  // table is published whenever a listener connects. Disconnecting only marks the listener's slot
+  // as disconnected, which transmissions in progress also observe; the table is compacted once
+  // most of its slots are disconnected.
+  //
+  // A signal can be blocked, during which transmitting it calls no listeners. Blocks nest, and the
+  // number of transmissions suppressed is reported when the outermost block ends, so that callers
+  // can coalesce them into a single transmission.
   template<typename ReturnType, typename... ArgumentTypes>
   struct Signal<ReturnType (ArgumentTypes...)> {
-    typedef std::function<ReturnType (ArgumentTypes...)> HandlerType;
+    typedef InplaceFunction<ReturnType (ArgumentTypes...)> HandlerType;
     
     Signal() noexcept
-    : m_head(nullptr)
-    , m_tail(nullptr)
-    , m_nextToken(1) {
+    : m_disconnectedCount(0)
+    , m_nextToken(1)
+    , m_blockDepth(0)
+    , m_suppressedCount(0) {
     }
     
-    ~Signal() {
-      HandlerNode* cursor = m_head;
-      while(cursor != nullptr) {
-        HandlerNode* previous = cursor;
-        cursor = cursor->next;
-        
-        delete previous;
-      }
+    std::uint32_t connect(const HandlerType& handler) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::shared_ptr<Table> table = compact(1);
+      table->slots.emplace_back(handler, m_nextToken);
+      m_indices[m_nextToken] = table->slots.size() - 1;
+      std::atomic_store(&m_table, std::shared_ptr<const Table>(std::move(table)));
+      
+      return m_nextToken++;
     }
     
-    std::uint32_t connect(const HandlerType& handler) {
-      if(m_head == nullptr) {
-        m_head = new HandlerNode(handler, m_nextToken);
-        m_tail = m_head;
-      } else {
-        m_tail->next = new HandlerNode(handler, m_nextToken);
-        m_tail = m_tail->next;
+    void disconnect(std::uint32_t token) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      typename std::unordered_map<std::uint32_t, std::size_t>::iterator index = m_indices.find(token);
+      if (index == m_indices.end()) {
+        return;
       }
       
-      ++m_nextToken;
-      return m_tail->token;
+      m_table->slots[index->second].isConnected.store(false);
+      m_indices.erase(index);
+      
+      ++m_disconnectedCount;
+      if (m_disconnectedCount > m_indices.size()) {
+        std::atomic_store(&m_table, std::shared_ptr<const Table>(compact(0)));
+      }
     }
     
-    void disconnect(std::uint32_t token) {
-      HandlerNode* prior = nullptr;
-      HandlerNode* cursor = m_head;
-      while(cursor != nullptr) {
-        if(cursor->token == token) {
-          if(prior != nullptr) {
-            prior->next = cursor->next;
-          } else {
-            m_head = cursor->next;
-          }
-          
-          if(cursor == m_tail) {
-            m_tail = prior;
-          }
-          
-          delete cursor;
-          return;
-        } else {
-          prior = cursor;
-          cursor = cursor->next;
-        }
+    void block() {
+      ++m_blockDepth;
+    }
+    
+    // End a block, returning the number of transmissions suppressed while the signal was blocked if
+    // this was the outermost block, and zero otherwise.
+    std::size_t unblock() {
+      if (m_blockDepth.fetch_sub(1) > 1) {
+        return 0;
       }
+      
+      return m_suppressedCount.exchange(0);
     }
     
     ReturnType transmit(ArgumentTypes... arguments) {
-      HandlerNode* cursor = m_head;
-      while(cursor != nullptr) {
-        if(cursor == m_tail) {
-          return cursor->handler(std::forward<ArgumentTypes>(arguments)...);
+      if (m_blockDepth.load() > 0) {
+        ++m_suppressedCount;
+        return ReturnType();
+      }
+      
+      std::shared_ptr<const Table> table = std::atomic_load(&m_table);
+      if (!table) {
+        return ReturnType();
+      }
+      
+      // The result of the transmission is that of the last connected listener, so find it first.
+      std::size_t count = table->slots.size();
+      while (count > 0 && !table->slots[count - 1].isConnected.load()) {
+        --count;
+      }
+      
+      if (count == 0) {
+        return ReturnType();
+      }
+      
+      for (std::size_t index = 0; index < count - 1; ++index) {
+        const Slot& slot = table->slots[index];
+        if (slot.isConnected.load()) {
+          slot.handler(arguments...);
         }
-        
-        cursor->handler(std::forward<ArgumentTypes>(arguments)...);
-        cursor = cursor->next;
       }
       
-      return ReturnType();
+      const Slot& last = table->slots[count - 1];
+      if (!last.isConnected.load()) {
+        return ReturnType();
+      }
+      
+      return last.handler(arguments...);
     }
     
   private:
-    struct HandlerNode {
-      HandlerNode(const HandlerType& handler, std::uint32_t token) noexcept
+    struct Slot {
+      Slot(const HandlerType& handler, std::uint32_t token)
       : handler(handler)
       , token(token)
-      , next(nullptr) {
+      , isConnected(true) {
+      }
+      
+      Slot(const Slot& other)
+      : handler(other.handler)
+      , token(other.token)
+      , isConnected(other.isConnected.load()) {
       }
       
       HandlerType handler;
       std::uint32_t token;
-      HandlerNode* next;
+      
+      // The only part of a published table that changes.
+      mutable std::atomic<bool> isConnected;
     };
     
-    HandlerNode* m_head;
-    HandlerNode* m_tail;
+    struct Table {
+      std::vector<Slot> slots;
+    };
+    
+    std::shared_ptr<const Table> m_table;
+    std::unordered_map<std::uint32_t, std::size_t> m_indices;
+    std::size_t m_disconnectedCount;
     std::uint32_t m_nextToken;
+    std::mutex m_mutex;
+    
+    std::atomic<std::size_t> m_blockDepth;
+    std::atomic<std::size_t> m_suppressedCount;
+    
+    // Copy the connected slots of the current table into a new (unpublished) table, leaving room
+    // for the specified number of additional slots. Must be called with the mutex held.
+    std::shared_ptr<Table> compact(std::size_t reserve) {
+      std::shared_ptr<Table> result = std::make_shared<Table>();
+      result->slots.reserve(m_indices.size() + reserve);
+      m_indices.clear();
+      if (m_table) {
+        for (const Slot& slot : m_table->slots) {
+          if (slot.isConnected.load()) {
+            m_indices[slot.token] = result->slots.size();
+            result->slots.push_back(slot);
+          }
+        }
+      }
+      
+      m_disconnectedCount = 0;
+      return result;
+    }
+  };
+  
+  // Block a signal for the lifetime of the guard. Releasing the guard ends the block early and
+  // returns the number of transmissions it suppressed (see Signal::unblock).
+  template<typename SignalType>
+  struct SignalBlock {
+    explicit SignalBlock(SignalType& signal)
+    : m_signal(&signal) {
+      m_signal->block();
+    }
+    
+    SignalBlock(const SignalBlock&) = delete;
+    SignalBlock& operator=(const SignalBlock&) = delete;
+    
+    ~SignalBlock() {
+      release();
+    }
+    
+    std::size_t release() {
+      if (m_signal == nullptr) {
+        return 0;
+      }
+      
+      std::size_t suppressed = m_signal->unblock();
+      m_signal = nullptr;
+      return suppressed;
+    }
+    
+  private:
+    SignalType* m_signal;
   };
 }
@@ -0,0 +1,68 @@
+#include "TextView.hpp"
+
+#include "Document.hpp"
+
+#include <algorithm>
+
+namespace quip {
+  TextView::TextView()
+  : m_document(nullptr)
+  , m_revision(0)
+  , m_row(0)
+  , m_column(0)
+  , m_length(0) {
+  }
+  
+  TextView::TextView(const Document& document, std::size_t row)
+  : TextView(document, row, 0, std::string::npos) {
+  }
+  
+  TextView::TextView(const Document& document, std::size_t row, std::size_t column, std::size_t length)
+  : m_document(&document)
+  , m_lifetime(document.lifetime())
+  , m_revision(document.revision())
+  , m_row(row)
+  , m_column(0)
+  , m_length(0) {
+    if (row < document.rows()) {
+      std::size_t size = document.row(row).size();
+      m_column = std::min(column, size);
+      m_length = std::min(length, size - m_column);
+    }
+  }
+  
+  bool TextView::isAlive() const noexcept {
+    return m_document != nullptr && !m_lifetime.expired();
+  }
+  
+  bool TextView::isValid() const noexcept {
+    return isAlive() && m_document->revision() == m_revision;
+  }
+  
+  std::size_t TextView::row() const noexcept {
+    return m_row;
+  }
+  
+  std::size_t TextView::column() const noexcept {
+    return m_column;
+  }
+  
+  std::size_t TextView::size() const noexcept {
+    return m_length;
+  }
+  
+  const char* TextView::data() const noexcept {
+    if (m_length == 0) {
+      return "";
+    }
+    
+    return m_document->row(m_row).data() + m_column;
+  }
+  
+  TextView TextView::subview(std::size_t offset, std::size_t length) const {
+    TextView result(*this);
+    result.m_column = m_column + std::min(offset, m_length);
+    result.m_length = std::min(length, m_length - (result.m_column - m_column));
+    return result;
+  }
+}
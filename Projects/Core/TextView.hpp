@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace quip {
+  struct Document;
+  
+  // A view of a span of text within a single row of a document, which refers to the document's
+  // storage rather than copying it.
+  //
+  // A view records the document revision it was created at and is only valid until the document
+  // is next modified or destroyed; the data of a stale view must not be read. A view may outlive
+  // its document (scripts can hold views indefinitely), and tracks whether it still exists.
+  struct TextView {
+    TextView();
+    explicit TextView(const Document& document, std::size_t row);
+    explicit TextView(const Document& document, std::size_t row, std::size_t column, std::size_t length);
+    
+    // Determine whether the document still exists, and whether it is also unmodified.
+    bool isAlive() const noexcept;
+    bool isValid() const noexcept;
+    
+    std::size_t row() const noexcept;
+    std::size_t column() const noexcept;
+    std::size_t size() const noexcept;
+    const char* data() const noexcept;
+    
+    // Get a view of part of this view, clamped to its bounds.
+    TextView subview(std::size_t offset, std::size_t length) const;
+    
+  private:
+    const Document* m_document;
+    std::weak_ptr<const void> m_lifetime;
+    std::uint64_t m_revision;
+    std::size_t m_row;
+    std::size_t m_column;
+    std::size_t m_length;
+  };
+}
@@ -0,0 +1,187 @@
+#include "Trace.hpp"
+
+#include "LuaBinding.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace quip {
+  struct TraceBuffer {
+    std::vector<TraceEvent> events;
+
+    // The number of spans ever recorded into the buffer. Only the owning thread writes spans, and it
+    // publishes each one by incrementing the count.
+    std::atomic<std::uint64_t> written;
+    std::uint32_t thread;
+  };
+
+  // Holds a thread's buffer, returning it to the trace when the thread exits.
+  struct TraceBufferLease {
+    std::shared_ptr<TraceBuffer> buffer;
+
+    ~TraceBufferLease() {
+      if (buffer) {
+        Trace::shared().retire(buffer);
+      }
+    }
+  };
+
+  namespace {
+    thread_local TraceBufferLease t_lease;
+
+    std::uint64_t nanoseconds(Trace::Clock::time_point time) {
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    bool capturing(const Trace& trace) {
+      return Trace::isCapturing();
+    }
+  }
+
+  constexpr std::size_t Trace::BufferCapacity;
+  constexpr std::size_t Trace::RetainedBufferCount;
+  std::atomic<bool> Trace::s_isCapturing(false);
+
+  Trace::Trace()
+  : m_threadCount(0)
+  , m_origin(Clock::now()) {
+  }
+
+  Trace& Trace::shared() {
+    // Never destroyed, so that spans ending during static destruction don't record into a
+    // destroyed trace.
+    static Trace* trace = new Trace();
+    return *trace;
+  }
+
+  void Trace::start() {
+    // Buffers belong to their threads, so they aren't cleared; spans recorded before the new origin
+    // are skipped when exporting instead.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_origin = Clock::now();
+    s_isCapturing.store(true, std::memory_order_relaxed);
+  }
+
+  void Trace::stop() {
+    s_isCapturing.store(false, std::memory_order_relaxed);
+  }
+
+  std::vector<TraceEvent> Trace::events() const {
+    std::vector<TraceEvent> results;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::uint64_t origin = nanoseconds(m_origin);
+    for (const std::shared_ptr<TraceBuffer>& buffer : m_buffers) {
+      // Snapshot the published spans. The owning thread may keep recording while they are copied,
+      // so any that could have been overwritten in the meantime are dropped afterwards.
+      std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+      std::uint64_t first = written > BufferCapacity ? written - BufferCapacity : 0;
+      std::vector<TraceEvent> snapshot;
+      snapshot.reserve(written - first);
+      for (std::uint64_t index = first; index < written; ++index) {
+        snapshot.push_back(buffer->events[index % BufferCapacity]);
+      }
+
+      std::uint64_t rewritten = buffer->written.load(std::memory_order_acquire);
+      std::uint64_t valid = rewritten > BufferCapacity ? rewritten - BufferCapacity : 0;
+      for (std::uint64_t index = std::max(first, valid); index < written; ++index) {
+        TraceEvent event = snapshot[index - first];
+
+        // Spans that began before the capture started were in progress when it was restarted, or
+        // belong to an earlier capture.
+        if (event.start >= origin) {
+          event.start -= origin;
+          results.push_back(event);
+        }
+      }
+    }
+
+    std::stable_sort(results.begin(), results.end(), [](const TraceEvent& left, const TraceEvent& right) {
+      return left.start < right.start;
+    });
+
+    return results;
+  }
+
+  std::string Trace::chromeTrace() const {
+    std::string result = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    // Timestamps and durations are in microseconds.
+    char buffer[256];
+    std::vector<TraceEvent> spans = events();
+    for (std::size_t index = 0; index < spans.size(); ++index) {
+      const TraceEvent& span = spans[index];
+      std::snprintf(buffer, sizeof(buffer), "%s\n{\"name\":\"%s\",\"cat\":\"quip\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}", index > 0 ? "," : "", span.name, span.start / 1000.0, span.duration / 1000.0, static_cast<unsigned>(span.thread));
+      result += buffer;
+    }
+
+    result += "\n]}\n";
+    return result;
+  }
+
+  bool Trace::write(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+      return false;
+    }
+
+    std::string text = chromeTrace();
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && written;
+  }
+
+  std::size_t Trace::bufferCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers.size();
+  }
+
+  void Trace::record(const char* name, Clock::time_point start, Clock::time_point end) {
+    TraceBuffer& buffer = threadBuffer();
+    std::uint64_t written = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[written % BufferCapacity] = TraceEvent { name, nanoseconds(start), nanoseconds(end) - nanoseconds(start), buffer.thread };
+    buffer.written.store(written + 1, std::memory_order_release);
+  }
+
+  LuaBinding Trace::binding() {
+    LuaBinding result;
+    result.addFunction("start", &Trace::start);
+    result.addFunction("stop", &Trace::stop);
+    result.addFunction("write", &Trace::write);
+    result.addProperty("capturing", &capturing);
+
+    return result;
+  }
+
+  TraceBuffer& Trace::threadBuffer() {
+    if (!t_lease.buffer) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      // Reuse the buffer of a thread that has exited, keeping its spans until they are overwritten.
+      std::shared_ptr<TraceBuffer> buffer;
+      if (!m_retired.empty()) {
+        buffer = m_retired.back();
+        m_retired.pop_back();
+      } else {
+        buffer = std::make_shared<TraceBuffer>();
+        buffer->events.resize(BufferCapacity);
+        buffer->written.store(0, std::memory_order_relaxed);
+        m_buffers.push_back(buffer);
+      }
+
+      buffer->thread = ++m_threadCount;
+      t_lease.buffer = buffer;
+    }
+
+    return *t_lease.buffer;
+  }
+
+  void Trace::retire(const std::shared_ptr<TraceBuffer>& buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_retired.size() < RetainedBufferCount) {
+      m_retired.push_back(buffer);
+      return;
+    }
+
+    m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), buffer), m_buffers.end());
+  }
+}
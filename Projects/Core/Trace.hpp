@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace quip {
+  struct LuaBinding;
+  struct TraceBuffer;
+
+  // A span of time spent in an instrumented function, relative to the start of the capture.
+  struct TraceEvent {
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::uint32_t thread;
+  };
+
+  // Records spans of time spent in instrumented functions, for export in Chrome's trace event
+  // format (which chrome://tracing and Perfetto can display).
+  //
+  // Each thread records into its own fixed-size ring buffer, so recording never contends with other
+  // threads and never allocates after a thread's first span; when a buffer is full, the oldest spans
+  // are overwritten. A buffer publishes its spans with an atomic counter, so recording takes no
+  // locks. When a thread exits, its buffer (and the spans in it) is kept for the next thread to
+  // reuse, up to RetainedBufferCount buffers; beyond that, buffers are released. When no capture is
+  // running, a span costs one relaxed atomic load.
+  struct Trace {
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr std::size_t BufferCapacity = 1 << 16;
+    static constexpr std::size_t RetainedBufferCount = 4;
+
+    static Trace& shared();
+
+    static bool isCapturing() noexcept {
+      return s_isCapturing.load(std::memory_order_relaxed);
+    }
+
+    // Start a capture, discarding any spans recorded by the previous one.
+    void start();
+    void stop();
+
+    // Get the recorded spans, ordered by start time.
+    std::vector<TraceEvent> events() const;
+
+    std::string chromeTrace() const;
+    bool write(const std::string& path) const;
+
+    // Get the number of buffers held, both by running threads and for reuse.
+    std::size_t bufferCount() const;
+
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    static LuaBinding binding();
+
+    Trace(const Trace& other) = delete;
+    Trace& operator=(const Trace& other) = delete;
+
+  private:
+    friend struct TraceBufferLease;
+
+    static std::atomic<bool> s_isCapturing;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> m_buffers;
+    std::vector<std::shared_ptr<TraceBuffer>> m_retired;
+    std::uint32_t m_threadCount;
+    Clock::time_point m_origin;
+
+    Trace();
+
+    TraceBuffer& threadBuffer();
+    void retire(const std::shared_ptr<TraceBuffer>& buffer);
+  };
+
+  // Records the time between its construction and destruction as a span with the specified name,
+  // which must be a string literal (only the pointer is stored).
+  struct TraceSpan {
+    explicit TraceSpan(const char* name)
+    : m_name(Trace::isCapturing() ? name : nullptr) {
+      if (m_name != nullptr) {
+        m_start = Trace::Clock::now();
+      }
+    }
+
+    ~TraceSpan() {
+      if (m_name != nullptr) {
+        Trace::shared().record(m_name, m_start, Trace::Clock::now());
+      }
+    }
+
+    TraceSpan(const TraceSpan& other) = delete;
+    TraceSpan& operator=(const TraceSpan& other) = delete;
+
+  private:
+    const char* m_name;
+    Trace::Clock::time_point m_start;
+  };
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace quip {
   struct EditContext;
   
@@ -8,5 +10,8 @@ namespace quip {
     
     virtual void perform (EditContext & context) = 0;
     virtual void rollback (EditContext & context) = 0;
+    
+    // Estimate the heap memory held by the transaction, including the transaction itself.
+    virtual std::size_t memoryUsage () const = 0;
   };
 }
\ No newline at end of file
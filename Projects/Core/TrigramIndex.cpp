@@ -0,0 +1,329 @@
+#include "TrigramIndex.hpp"
+
+#include "MemoryAccounting.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace quip {
+  namespace {
+    // Chunks of about a thousand rows keep the bit sets small relative to the text they cover (8KB
+    // for what is usually tens of kilobytes of text) while still letting selective searches skip
+    // most of a large document.
+    const std::size_t ChunkRows = 1024;
+    const std::size_t ChunkBits = 1 << 16;
+    const std::size_t ChunkWords = ChunkBits / 64;
+
+    std::uint32_t trigramAt(const std::string& text, std::size_t index) {
+      return (static_cast<std::uint32_t>(static_cast<unsigned char>(text[index])) << 16) | (static_cast<std::uint32_t>(static_cast<unsigned char>(text[index + 1])) << 8) | static_cast<unsigned char>(text[index + 2]);
+    }
+
+    std::size_t bitOfTrigram(std::uint32_t trigram) {
+      return static_cast<std::uint32_t>(trigram * 2654435761u) >> 16;
+    }
+
+    void appendTrigrams(const std::string& literal, std::vector<std::uint32_t>& trigrams) {
+      for (std::size_t index = 0; index + 3 <= literal.size(); ++index) {
+        trigrams.emplace_back(trigramAt(literal, index));
+      }
+    }
+
+    // Determine whether every match of an expression lies within a single row. Alternation is
+    // also rejected, since its branches don't share required text.
+    bool matchesWithinRows(const std::string& expression) {
+      for (std::size_t index = 0; index < expression.size(); ++index) {
+        char character = expression[index];
+        if (character == '|' || character == '\n' || character == '\r') {
+          return false;
+        }
+
+        if (character == '[' && index + 1 < expression.size() && expression[index + 1] == '^') {
+          return false;
+        }
+
+        if (character == '\\') {
+          if (++index == expression.size()) {
+            return false;
+          }
+
+          // Of the escapes that aren't punctuation, only these can't match a line terminator.
+          char escaped = expression[index];
+          bool isSafe = escaped == 'd' || escaped == 'w' || escaped == 'b' || escaped == 'B' || (escaped >= '1' && escaped <= '9');
+          if (std::isalnum(static_cast<unsigned char>(escaped)) && !isSafe) {
+            return false;
+          }
+        }
+      }
+
+      return true;
+    }
+
+    // Skip a bracketed class or group starting at the specified index, returning the index after
+    // it (or the end of the expression).
+    std::size_t skipClass(const std::string& expression, std::size_t index) {
+      // A closing bracket first in the class is literal.
+      ++index;
+      if (index < expression.size() && expression[index] == ']') {
+        ++index;
+      }
+
+      while (index < expression.size() && expression[index] != ']') {
+        index += expression[index] == '\\' ? 2 : 1;
+      }
+
+      return std::min(index + 1, expression.size());
+    }
+
+    std::size_t skipGroup(const std::string& expression, std::size_t index) {
+      std::size_t depth = 0;
+      while (index < expression.size()) {
+        char character = expression[index];
+        if (character == '\\') {
+          index += 2;
+          continue;
+        }
+
+        if (character == '[') {
+          index = skipClass(expression, index);
+          continue;
+        }
+
+        ++index;
+        if (character == '(') {
+          ++depth;
+        } else if (character == ')' && --depth == 0) {
+          break;
+        }
+      }
+
+      return std::min(index, expression.size());
+    }
+  }
+
+  TrigramIndex::Chunk::Chunk(std::size_t rows)
+  : rows(rows)
+  , isValid(false) {
+  }
+
+  TrigramIndex::TrigramIndex(const std::vector<std::string>& rows)
+  : m_rows(rows)
+  , m_isEnabled(false) {
+  }
+
+  bool TrigramIndex::isEnabled() const {
+    return m_isEnabled;
+  }
+
+  void TrigramIndex::setEnabled(bool isEnabled) {
+    m_isEnabled = isEnabled;
+    reset();
+  }
+
+  void TrigramIndex::reset() {
+    m_chunks.clear();
+    if (!m_isEnabled) {
+      return;
+    }
+
+    for (std::size_t row = 0; row < m_rows.size(); row += ChunkRows) {
+      m_chunks.emplace_back(std::min(ChunkRows, m_rows.size() - row));
+    }
+  }
+
+  void TrigramIndex::replaceRows(std::size_t row, std::size_t removed, std::size_t inserted) {
+    if (!m_isEnabled) {
+      return;
+    }
+
+    if (m_chunks.empty()) {
+      m_chunks.emplace_back(0);
+    }
+
+    // Find the chunk containing the row (or the last chunk, if rows are being appended).
+    std::size_t chunk = 0;
+    std::size_t firstRow = 0;
+    while (chunk + 1 < m_chunks.size() && row >= firstRow + m_chunks[chunk].rows) {
+      firstRow += m_chunks[chunk].rows;
+      ++chunk;
+    }
+
+    // Remove rows from the chunk and any that follow it, then insert them into the chunk.
+    std::size_t remaining = removed;
+    std::size_t offset = row - firstRow;
+    for (std::size_t index = chunk; index < m_chunks.size(); ++index) {
+      Chunk& current = m_chunks[index];
+      std::size_t taken = std::min(remaining, current.rows - std::min(offset, current.rows));
+      current.rows -= taken;
+      current.isValid = false;
+      remaining -= taken;
+      offset = 0;
+      if (remaining == 0) {
+        break;
+      }
+    }
+
+    m_chunks[chunk].rows += inserted;
+
+    // Split a chunk that has grown too large, and drop any that are now empty.
+    if (m_chunks[chunk].rows > 2 * ChunkRows) {
+      std::size_t rows = m_chunks[chunk].rows;
+      m_chunks[chunk] = Chunk(ChunkRows);
+      std::vector<Chunk> pieces;
+      for (std::size_t piece = ChunkRows; piece < rows; piece += ChunkRows) {
+        pieces.emplace_back(std::min(ChunkRows, rows - piece));
+      }
+
+      m_chunks.insert(m_chunks.begin() + chunk + 1, pieces.begin(), pieces.end());
+    }
+
+    m_chunks.erase(std::remove_if(m_chunks.begin(), m_chunks.end(), [](const Chunk& candidate) {
+      return candidate.rows == 0;
+    }), m_chunks.end());
+  }
+
+  bool TrigramIndex::build(std::size_t chunks) {
+    std::size_t firstRow = 0;
+    for (std::size_t chunk = 0; chunk < m_chunks.size() && chunks > 0; ++chunk) {
+      if (!m_chunks[chunk].isValid) {
+        buildChunk(chunk, firstRow);
+        --chunks;
+      }
+
+      firstRow += m_chunks[chunk].rows;
+    }
+
+    return isBuilt();
+  }
+
+  bool TrigramIndex::isBuilt() const {
+    return std::all_of(m_chunks.begin(), m_chunks.end(), [](const Chunk& chunk) {
+      return chunk.isValid;
+    });
+  }
+
+  std::vector<TrigramIndex::RowRange> TrigramIndex::candidateRows(const std::vector<std::uint32_t>& trigrams) const {
+    std::vector<std::size_t> bits;
+    bits.reserve(trigrams.size());
+    for (std::uint32_t trigram : trigrams) {
+      bits.emplace_back(bitOfTrigram(trigram));
+    }
+
+    std::vector<RowRange> results;
+    std::size_t firstRow = 0;
+    for (std::size_t chunk = 0; chunk < m_chunks.size(); ++chunk) {
+      if (!m_chunks[chunk].isValid) {
+        buildChunk(chunk, firstRow);
+      }
+
+      const std::vector<std::uint64_t>& words = m_chunks[chunk].bits;
+      bool isCandidate = std::all_of(bits.begin(), bits.end(), [&](std::size_t bit) {
+        return (words[bit / 64] >> (bit % 64)) & 1;
+      });
+
+      std::size_t endRow = firstRow + m_chunks[chunk].rows;
+      if (isCandidate) {
+        if (!results.empty() && results.back().second == firstRow) {
+          results.back().second = endRow;
+        } else {
+          results.emplace_back(firstRow, endRow);
+        }
+      }
+
+      firstRow = endRow;
+    }
+
+    return results;
+  }
+
+  std::vector<std::uint32_t> TrigramIndex::requiredTrigrams(const std::string& expression) {
+    std::vector<std::uint32_t> trigrams;
+    if (!matchesWithinRows(expression)) {
+      return trigrams;
+    }
+
+    // Collect runs of literal characters that every match must contain in sequence. Anything that
+    // isn't a literal character (or that is optional or repeated) ends the current run.
+    std::string run;
+    std::size_t index = 0;
+    while (index < expression.size()) {
+      char character = expression[index];
+      bool isLiteral = false;
+      if (character == '\\') {
+        char escaped = index + 1 < expression.size() ? expression[index + 1] : '\\';
+        isLiteral = !std::isalnum(static_cast<unsigned char>(escaped));
+        character = escaped;
+        index += 2;
+      } else if (character == '[') {
+        index = skipClass(expression, index);
+      } else if (character == '(') {
+        index = skipGroup(expression, index);
+      } else {
+        isLiteral = std::string(".^$*+?{}").find(character) == std::string::npos;
+        ++index;
+      }
+
+      bool isOptional = false;
+      bool isRepeated = false;
+      if (index < expression.size()) {
+        char quantifier = expression[index];
+        if (quantifier == '*' || quantifier == '?') {
+          isOptional = true;
+          ++index;
+        } else if (quantifier == '+') {
+          isRepeated = true;
+          ++index;
+        } else if (quantifier == '{') {
+          isOptional = true;
+          std::size_t end = expression.find('}', index);
+          index = end == std::string::npos ? expression.size() : end + 1;
+        }
+
+        // Lazy quantifiers match the same text.
+        if ((isOptional || isRepeated) && index < expression.size() && expression[index] == '?') {
+          ++index;
+        }
+      }
+
+      if (isLiteral && !isOptional) {
+        run += character;
+      }
+
+      if (!isLiteral || isOptional || isRepeated) {
+        appendTrigrams(run, trigrams);
+        run.clear();
+      }
+    }
+
+    appendTrigrams(run, trigrams);
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+  }
+
+  std::size_t TrigramIndex::memoryUsage() const {
+    std::size_t result = m_chunks.capacity() * sizeof(Chunk);
+    for (const Chunk& chunk : m_chunks) {
+      result += chunk.bits.capacity() * sizeof(std::uint64_t);
+    }
+
+    return result;
+  }
+
+  void TrigramIndex::buildChunk(std::size_t chunk, std::size_t firstRow) const {
+    TraceSpan span("TrigramIndex::buildChunk");
+    MemoryScope scope(MemoryCategory::Document);
+
+    std::vector<std::uint64_t>& words = m_chunks[chunk].bits;
+    words.assign(ChunkWords, 0);
+    for (std::size_t row = firstRow; row < firstRow + m_chunks[chunk].rows; ++row) {
+      const std::string& text = m_rows[row];
+      for (std::size_t index = 0; index + 3 <= text.size(); ++index) {
+        std::size_t bit = bitOfTrigram(trigramAt(text, index));
+        words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+      }
+    }
+
+    m_chunks[chunk].isValid = true;
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace quip {
+  // An optional index of the trigrams (three character sequences) in each chunk of a document's
+  // rows, used to skip the chunks that can't contain a match for a search expression.
+  //
+  // Each chunk records its trigrams in a fixed-size bit set, so lookups may report a chunk that
+  // doesn't contain a trigram but never miss one that does. Expressions are only narrowed by the
+  // index when every match must lie within a single row and contain certain literal text; the
+  // trigrams of that text are then required of every chunk containing a match.
+  //
+  // The index is disabled until enabled. Chunks are built in bounded steps by build (which the
+  // host calls when idle), or on demand when a search needs them, and are discarded when the
+  // owning document replaces any of their rows.
+  struct TrigramIndex {
+    // A range of rows to search, from the first row up to but excluding the second.
+    typedef std::pair<std::size_t, std::size_t> RowRange;
+
+    explicit TrigramIndex(const std::vector<std::string>& rows);
+
+    bool isEnabled() const;
+    void setEnabled(bool isEnabled);
+
+    void reset();
+    void replaceRows(std::size_t row, std::size_t removed, std::size_t inserted);
+
+    // Build up to the specified number of chunks, returning true if every chunk is built.
+    bool build(std::size_t chunks);
+    bool isBuilt() const;
+
+    // Get the ranges of rows that may contain every one of the trigrams. Adjacent ranges are
+    // merged.
+    std::vector<RowRange> candidateRows(const std::vector<std::uint32_t>& trigrams) const;
+
+    // Get the trigrams that every match of the expression must contain, or nothing if the index
+    // can't narrow a search for the expression.
+    static std::vector<std::uint32_t> requiredTrigrams(const std::string& expression);
+
+    // Estimate the heap memory held by the index.
+    std::size_t memoryUsage() const;
+
+  private:
+    struct Chunk {
+      std::size_t rows;
+      bool isValid;
+      std::vector<std::uint64_t> bits;
+
+      explicit Chunk(std::size_t rows);
+    };
+
+    const std::vector<std::string>& m_rows;
+    bool m_isEnabled;
+    mutable std::vector<Chunk> m_chunks;
+
+    void buildChunk(std::size_t chunk, std::size_t firstRow) const;
+  };
+}
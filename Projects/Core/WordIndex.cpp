@@ -0,0 +1,126 @@
+#include "WordIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace quip {
+  namespace {
+    bool isWordCharacter(char character) {
+      return std::isalnum(character);
+    }
+
+    bool isWhitespaceExceptNewline(char character) {
+      return std::isspace(character) && character != '\n';
+    }
+  }
+
+  WordIndex::Boundaries::Boundaries()
+  : isValid(false) {
+  }
+
+  WordIndex::WordIndex(const std::vector<std::string>& rows)
+  : m_rows(rows) {
+  }
+
+  void WordIndex::reset() {
+    m_boundaries.clear();
+    m_boundaries.resize(m_rows.size());
+  }
+
+  void WordIndex::replaceRows(std::size_t row, std::size_t removed, std::size_t inserted) {
+    std::size_t replaced = std::min(removed, inserted);
+    for (std::size_t index = row; index < row + replaced; ++index) {
+      m_boundaries[index].isValid = false;
+    }
+
+    std::vector<Boundaries>::iterator first = m_boundaries.begin() + row + replaced;
+    if (removed > inserted) {
+      m_boundaries.erase(first, first + (removed - inserted));
+    } else if (inserted > removed) {
+      m_boundaries.insert(first, inserted - removed, Boundaries());
+    }
+  }
+
+  Optional<Location> WordIndex::nextWordStart(const Location& location, std::size_t count) const {
+    Optional<Location> result;
+    std::uint64_t column = location.column();
+    for (std::size_t row = location.row(); row < m_rows.size(); ++row) {
+      const std::vector<std::uint64_t>& starts = boundariesOfRow(row).starts;
+      std::vector<std::uint64_t>::const_iterator cursor = starts.begin();
+      if (row == location.row()) {
+        cursor = std::upper_bound(starts.begin(), starts.end(), column);
+      }
+
+      std::size_t available = static_cast<std::size_t>(starts.end() - cursor);
+      if (count <= available) {
+        return Location(*(cursor + count - 1), row);
+      }
+
+      if (available > 0) {
+        result = Location(starts.back(), row);
+        count -= available;
+      }
+    }
+
+    return result;
+  }
+
+  Optional<Location> WordIndex::priorWordEnd(const Location& location, std::size_t count) const {
+    Optional<Location> result;
+    if (m_rows.empty()) {
+      return result;
+    }
+
+    std::uint64_t column = location.column();
+    for (std::size_t row = std::min(location.row(), m_rows.size() - 1) + 1; row > 0; --row) {
+      const std::vector<std::uint64_t>& ends = boundariesOfRow(row - 1).ends;
+      std::vector<std::uint64_t>::const_iterator cursor = ends.end();
+      if (row - 1 == location.row()) {
+        cursor = std::lower_bound(ends.begin(), ends.end(), column);
+      }
+
+      std::size_t available = static_cast<std::size_t>(cursor - ends.begin());
+      if (count <= available) {
+        return Location(*(cursor - count), row - 1);
+      }
+
+      if (available > 0) {
+        result = Location(ends.front(), row - 1);
+        count -= available;
+      }
+    }
+
+    return result;
+  }
+
+  const WordIndex::Boundaries& WordIndex::boundariesOfRow(std::size_t row) const {
+    Boundaries& boundaries = m_boundaries[row];
+    if (boundaries.isValid) {
+      return boundaries;
+    }
+
+    // Rows end with a newline (which is not a word character) or the end of the document, so
+    // the boundaries of a row never depend on the contents of its neighbors.
+    const std::string& text = m_rows[row];
+    boundaries.starts.clear();
+    boundaries.ends.clear();
+    for (std::size_t column = 0; column < text.size(); ++column) {
+      char character = text[column];
+      if (isWhitespaceExceptNewline(character)) {
+        continue;
+      }
+
+      bool isWord = isWordCharacter(character);
+      if (!isWord || column == 0 || !isWordCharacter(text[column - 1])) {
+        boundaries.starts.push_back(column);
+      }
+
+      if (!isWord || column + 1 == text.size() || !isWordCharacter(text[column + 1])) {
+        boundaries.ends.push_back(column);
+      }
+    }
+
+    boundaries.isValid = true;
+    return boundaries;
+  }
+}
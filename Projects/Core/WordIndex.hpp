@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Location.hpp"
+#include "Optional.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace quip {
+  // An index of the word boundaries in a document, used to answer word motion queries without
+  // walking the document text one character at a time.
+  //
+  // A word starts at any character that isn't horizontal whitespace and that is either not a word
+  // character or follows one that isn't. Words end symmetrically. Under these rules the words are
+  // exactly the units visited by the word selectors, so the Nth word from a location can be found
+  // by counting boundaries rather than re-selecting each intervening word.
+  //
+  // Boundaries are computed for a row the first time the row is queried, and discarded when the
+  // owning document replaces the row.
+  struct WordIndex {
+    explicit WordIndex(const std::vector<std::string>& rows);
+
+    void reset();
+    void replaceRows(std::size_t row, std::size_t removed, std::size_t inserted);
+
+    // Get the location of the Nth word start after the specified location. If there are fewer
+    // than N word starts after the location, the last one is returned.
+    Optional<Location> nextWordStart(const Location& location, std::size_t count) const;
+
+    // Get the location of the Nth word end before the specified location. If there are fewer than
+    // N word ends before the location, the first one is returned.
+    Optional<Location> priorWordEnd(const Location& location, std::size_t count) const;
+
+  private:
+    struct Boundaries {
+      bool isValid;
+      std::vector<std::uint64_t> starts;
+      std::vector<std::uint64_t> ends;
+
+      Boundaries();
+    };
+
+    const std::vector<std::string>& m_rows;
+    mutable std::vector<Boundaries> m_boundaries;
+
+    const Boundaries& boundariesOfRow(std::size_t row) const;
+  };
+}
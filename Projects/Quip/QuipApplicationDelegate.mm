@@ -20,7 +20,15 @@
 
     NSBundle* mainBundle = [NSBundle mainBundle];
     NSString* scriptRootPath = [[mainBundle resourcePath] stringByAppendingPathComponent:@"Runtime"];
-    m_scriptHost = std::make_unique<quip::ScriptHost>([scriptRootPath cStringUsingEncoding:NSUTF8StringEncoding]);
+    
+    // Compiled runtime scripts are cached between launches.
+    NSString* cachesPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    NSString* bytecodePath = [[cachesPath stringByAppendingPathComponent:[mainBundle bundleIdentifier]] stringByAppendingPathComponent:@"Bytecode"];
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:bytecodePath withIntermediateDirectories:YES attributes:nil error:nil]) {
+      bytecodePath = @"";
+    }
+    
+    m_scriptHost = std::make_unique<quip::ScriptHost>([scriptRootPath cStringUsingEncoding:NSUTF8StringEncoding], [bytecodePath cStringUsingEncoding:NSUTF8StringEncoding]);
     m_scriptHost->bind(m_settings.get(), "settings");
     m_scriptHost->addNativePackagePath([[mainBundle resourcePath] cStringUsingEncoding:NSUTF8StringEncoding]);
     
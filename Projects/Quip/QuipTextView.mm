@@ -36,6 +36,7 @@ static CGFloat gMargin = 1.0f;
 
 static CGFloat gTickInterval = 1.0 / 30.0;
 static CGFloat gCursorBlinkInterval = 0.57;
+static std::size_t gTrigramChunksPerTick = 4;
 
 @implementation QuipTextView
 
@@ -102,6 +103,11 @@ static CGFloat gCursorBlinkInterval = 0.57;
 - (void)tick:(NSTimer*)timer {
   m_popupServiceProvider->tick(gTickInterval);
   
+  // Build the document's trigram index, if enabled, a few chunks at a time.
+  if (m_context != nullptr) {
+    m_context->document().trigrams().build(gTrigramChunksPerTick);
+  }
+  
   m_cursorTimer -= gTickInterval;
   if (m_cursorTimer <= 0.0) {
     m_cursorTimer = gCursorBlinkInterval;
@@ -178,8 +184,9 @@ static CGFloat gCursorBlinkInterval = 0.57;
   NSPasteboard * pasteboard = [NSPasteboard generalPasteboard];
   [pasteboard clearContents];
   
-  NSMutableArray* items = [[NSMutableArray alloc] initWithCapacity:m_context->selections().count()];
-  for (const quip::Selection& selection : m_context->selections()) {
+  const quip::SelectionSet& selections = m_context->selections();
+  NSMutableArray* items = [[NSMutableArray alloc] initWithCapacity:selections.count()];
+  for (const quip::Selection& selection : selections) {
     std::string text = m_context->document().contents(selection);
     [items addObject:[NSString stringWithUTF8String:text.c_str()]];
   }
@@ -192,8 +199,9 @@ static CGFloat gCursorBlinkInterval = 0.57;
   NSPasteboard* pasteboard = [NSPasteboard generalPasteboard];
   [pasteboard clearContents];
   
-  NSMutableArray* items = [[NSMutableArray alloc] initWithCapacity:m_context->selections().count()];
-  for (const quip::Selection& selection : m_context->selections()) {
+  const quip::SelectionSet& selections = m_context->selections();
+  NSMutableArray* items = [[NSMutableArray alloc] initWithCapacity:selections.count()];
+  for (const quip::Selection& selection : selections) {
     std::string text = m_context->document().contents(selection);
     [items addObject:[NSString stringWithUTF8String:text.c_str()]];
   }
@@ -268,8 +276,7 @@ static CGFloat gCursorBlinkInterval = 0.57;
   });
   
   m_documentModifiedToken = m_context->document().onDocumentModified().connect([=] () {
-    CGFloat height = MAX(parent.size.height, cellSize.height() * (document->rows() + 1));
-    [self setFrameSize:NSMakeSize(frame.size.width, height)];
+    [self resizeToFitDocument];
   });
   
   m_transactionAppliedToken = m_context->onTransactionApplied().connect([=] (quip::ChangeType type) {
@@ -290,6 +297,14 @@ static CGFloat gCursorBlinkInterval = 0.57;
   [self setNeedsDisplay:YES];
 }
 
+- (void)resizeToFitDocument {
+  quip::Extent cellSize = m_drawingService->cellSize();
+  CGRect frame = [self frame];
+  CGRect parent = [[self superview] frame];
+  CGFloat height = MAX(parent.size.height, cellSize.height() * (m_context->document().rows() + 1));
+  [self setFrameSize:NSMakeSize(frame.size.width, height)];
+}
+
 - (void)setStatus:(QuipStatusView*)status {
   m_statusView = status;
   m_statusServiceProvider = std::make_unique<quip::StatusServiceProvider>(status);
@@ -403,16 +418,8 @@ static CGFloat gCursorBlinkInterval = 0.57;
   if (m_context != nullptr) {
     quip::Document& document = m_context->document();
 
-    // Find the document's extension.
-    std::size_t index = m_context->document().path().find_last_of('.');
-    std::string extension = "";
-    const quip::FileType* fileType = nullptr;
-    if (index != std::string::npos) {
-      extension = m_context->document().path().substr(index + 1);
-    }
-
-    // Find the document's type.
-    fileType = m_context->fileTypeDatabase().lookupByExtension(extension);
+    // Find the document's type from its extension.
+    const quip::FileType* fileType = m_context->fileTypeDatabase().lookupByPath(m_context->document().path());
     
     // Draw selections and overlays first (text is drawn over them).
     if (m_shouldDrawSelections) {